@@ -6,10 +6,11 @@ import 'package:zenoh/zenoh.dart';
 
 const defaultPriority = 5; // Z_PRIORITY_DATA
 
-void main(List<String> arguments) {
+Future<void> main(List<String> arguments) async {
   final parser = ArgParser()
     ..addOption('priority', abbr: 'p', defaultsTo: '$defaultPriority')
     ..addFlag('express', defaultsTo: false)
+    ..addFlag('native', defaultsTo: false)
     ..addMultiOption('connect', abbr: 'e')
     ..addMultiOption('listen', abbr: 'l');
 
@@ -23,6 +24,7 @@ void main(List<String> arguments) {
   final payloadSize = int.parse(results.rest[0]);
   final priorityValue = int.parse(results.option('priority')!);
   final express = results.flag('express');
+  final native = results.flag('native');
   final connectEndpoints = results.multiOption('connect');
   final listenEndpoints = results.multiOption('listen');
 
@@ -48,6 +50,23 @@ void main(List<String> arguments) {
     isExpress: express,
   );
 
+  print('Press CTRL-C to quit...');
+
+  // The publish loop runs natively, without per-message FFI calls; the
+  // local rate is printed once per second.
+  if (native) {
+    while (true) {
+      final result = await publisher.benchmark(
+        payloadSize,
+        duration: const Duration(seconds: 1),
+      );
+      print(
+        '${result.messagesPerSecond.toStringAsFixed(3)} msg/s '
+        '(${result.bytesPerSecond.toStringAsFixed(0)} bytes/s)',
+      );
+    }
+  }
+
   // Build payload
   final data = Uint8List(payloadSize);
   for (var i = 0; i < payloadSize; i++) {
@@ -55,7 +74,6 @@ void main(List<String> arguments) {
   }
   final zbytes = ZBytes.fromUint8List(data);
 
-  print('Press CTRL-C to quit...');
   while (true) {
     publisher.putBytes(zbytes.clone());
   }
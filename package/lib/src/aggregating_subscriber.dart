@@ -0,0 +1,215 @@
+import 'dart:async';
+import 'dart:ffi';
+import 'dart:isolate';
+
+import 'package:ffi/ffi.dart';
+
+import 'bindings.dart';
+import 'exceptions.dart';
+import 'native_lib.dart';
+
+/// The numeric type carried by every payload of an aggregating subscriber.
+enum AggregateValueType {
+  /// An IEEE 754 double.
+  float64,
+
+  /// A signed 64-bit integer.
+  int64,
+}
+
+/// Options for [Session.declareAggregatingSubscriber].
+class AggregationOptions {
+  /// The type of every payload.
+  final AggregateValueType valueType;
+
+  /// Whether payloads are in the `ZSerializer` format rather than 8 raw
+  /// little-endian bytes.
+  final bool serialized;
+
+  /// The length of each window.
+  final Duration window;
+
+  /// The interval between window closes, or null for tumbling windows
+  /// (one close per [window]). A shorter slide gives sliding windows; it
+  /// must divide [window] evenly.
+  final Duration? slide;
+
+  /// Creates aggregation options.
+  const AggregationOptions({
+    this.valueType = AggregateValueType.float64,
+    this.serialized = false,
+    this.window = const Duration(seconds: 1),
+    this.slide,
+  });
+}
+
+/// Aggregates of the samples received on one key expression during one
+/// window.
+class WindowAggregate {
+  /// The key expression the samples were published on.
+  final String keyExpr;
+
+  /// The time the window closed.
+  final DateTime windowEnd;
+
+  /// The number of samples in the window.
+  final int count;
+
+  /// The smallest value: a [double] or an [int] per
+  /// [AggregationOptions.valueType].
+  final num min;
+
+  /// The largest value: a [double] or an [int] per
+  /// [AggregationOptions.valueType].
+  final num max;
+
+  /// The arithmetic mean of the values.
+  final double mean;
+
+  /// Creates a WindowAggregate.
+  const WindowAggregate({
+    required this.keyExpr,
+    required this.windowEnd,
+    required this.count,
+    required this.min,
+    required this.max,
+    required this.mean,
+  });
+}
+
+/// A zenoh subscriber that turns numeric samples into per-key window
+/// aggregates natively.
+///
+/// Payloads are decoded in the zenoh callback and folded into count, min,
+/// max and mean accumulators; only the aggregates cross into Dart, as one
+/// port message per window close for all active keys. Windows are measured
+/// on arrival time.
+///
+/// Samples that are not a single value of the configured type are skipped
+/// and counted in [undecodableCount]. Call [close] when done to undeclare
+/// the subscriber and release native resources.
+class AggregatingSubscriber {
+  final Pointer<Void> _ptr;
+  final Pointer<zd_subscriber_stats_t> _stats;
+  final ReceivePort _receivePort;
+  final StreamController<WindowAggregate> _controller;
+  bool _closed = false;
+
+  AggregatingSubscriber._(
+    this._ptr,
+    this._stats,
+    this._receivePort,
+    this._controller,
+  ) {
+    _receivePort.listen(_onWindow);
+  }
+
+  /// Creates an aggregating subscriber on the given session and key
+  /// expression.
+  ///
+  /// This is called internally by [Session.declareAggregatingSubscriber].
+  ///
+  /// Throws [ArgumentError] if the window or slide is not positive.
+  static AggregatingSubscriber declare(
+    Pointer<Void> loanedSession,
+    Pointer<Void> loanedKe, {
+    AggregationOptions options = const AggregationOptions(),
+  }) {
+    final slide = options.slide ?? options.window;
+    if (options.window <= Duration.zero) {
+      throw ArgumentError.value(options.window, 'window', 'must be positive');
+    }
+    if (slide <= Duration.zero) {
+      throw ArgumentError.value(options.slide, 'slide', 'must be positive');
+    }
+    final size = bindings.zd_subscriber_sizeof();
+    final Pointer<Void> ptr = calloc.allocate(size);
+    final stats = bindings.zd_subscriber_stats_new();
+    if (stats == nullptr) {
+      calloc.free(ptr);
+      throw ZenohException('Failed to allocate subscriber stats', -1);
+    }
+    final nativeOptions = calloc<zd_aggregator_options_t>();
+    final receivePort = ReceivePort();
+
+    try {
+      bindings.zd_aggregator_options_default(nativeOptions);
+      // AggregateValueType indices mirror the ZD_AGGREGATE_* values.
+      nativeOptions.ref.value_type = options.valueType.index;
+      nativeOptions.ref.serialized = options.serialized;
+      nativeOptions.ref.window_us = options.window.inMicroseconds;
+      nativeOptions.ref.step_us = slide.inMicroseconds;
+      nativeOptions.ref.stats = stats;
+
+      final rc = bindings.zd_declare_aggregating_subscriber(
+        loanedSession.cast(),
+        ptr.cast(),
+        loanedKe.cast(),
+        receivePort.sendPort.nativePort,
+        nativeOptions,
+      );
+
+      if (rc != 0) {
+        receivePort.close();
+        bindings.zd_subscriber_stats_free(stats);
+        calloc.free(ptr);
+        throw ZenohException('Failed to declare aggregating subscriber', rc);
+      }
+
+      return AggregatingSubscriber._(
+        ptr,
+        stats,
+        receivePort,
+        StreamController<WindowAggregate>(),
+      );
+    } finally {
+      calloc.free(nativeOptions);
+    }
+  }
+
+  /// A stream of [WindowAggregate]s, one per active key and window.
+  Stream<WindowAggregate> get stream => _controller.stream;
+
+  /// The number of samples whose payload could not be decoded.
+  ///
+  /// Throws [StateError] if the subscriber has been closed.
+  int get undecodableCount {
+    if (_closed) throw StateError('AggregatingSubscriber is closed');
+    return _stats.ref.undecodable;
+  }
+
+  /// Handles a [window_end_us, records] message.
+  void _onWindow(dynamic message) {
+    final list = message as List;
+    final windowEnd = DateTime.fromMicrosecondsSinceEpoch(list[0] as int);
+    for (final record in list[1] as List) {
+      final fields = record as List;
+      _controller.add(
+        WindowAggregate(
+          keyExpr: fields[0] as String,
+          windowEnd: windowEnd,
+          count: fields[1] as int,
+          min: fields[2] as num,
+          max: fields[3] as num,
+          mean: fields[4] as double,
+        ),
+      );
+    }
+  }
+
+  /// Undeclares the subscriber and releases native resources.
+  ///
+  /// Aggregates of the window still open are discarded. Safe to call
+  /// multiple times -- subsequent calls are no-ops.
+  void close() {
+    if (_closed) return;
+    _closed = true;
+    bindings.zd_subscriber_drop(_ptr.cast());
+    _receivePort.close();
+    _controller.close();
+    calloc.free(_ptr);
+    // A callback still running keeps the counters alive through the
+    // aggregator until its drop has run.
+    bindings.zd_subscriber_stats_free(_stats);
+  }
+}
@@ -432,6 +432,38 @@ class ZenohDartBindings {
         int Function(ffi.Pointer<ffi.Opaque>, ffi.Pointer<ffi.Uint8>, int)
       >();
 
+  /// Wraps a malloc()-allocated buffer in owned bytes without copying.
+  ///
+  /// Ownership of `data` passes to the bytes: it is released with free()
+  /// once zenoh no longer references it, or right away if this call fails.
+  ///
+  /// @param bytes  Pointer to an uninitialized z_owned_bytes_t.
+  /// @param data   Buffer allocated with malloc(), or NULL when `len` is 0.
+  /// @param len    Length of the buffer in bytes.
+  /// @return 0 on success, negative on failure.
+  int zd_bytes_from_malloc(
+    ffi.Pointer<ffi.Opaque> bytes,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+  ) {
+    return _zd_bytes_from_malloc(bytes, data, len);
+  }
+
+  late final _zd_bytes_from_mallocPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Size,
+          )
+        >
+      >('zd_bytes_from_malloc');
+  late final _zd_bytes_from_malloc = _zd_bytes_from_mallocPtr
+      .asFunction<
+        int Function(ffi.Pointer<ffi.Opaque>, ffi.Pointer<ffi.Uint8>, int)
+      >();
+
   /// Converts loaned bytes to an owned string.
   ///
   /// @param bytes  Const pointer to a loaned bytes reference.
@@ -558,6 +590,146 @@ class ZenohDartBindings {
         int Function(ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint8>)
       >();
 
+  /// Creates a buffer pool.
+  ///
+  /// @param buffer_size  Size of each buffer in bytes (> 0).
+  /// @param count        Number of buffers (> 0).
+  /// @return The pool, or NULL on invalid arguments or allocation failure.
+  ffi.Pointer<zd_buffer_pool_t> zd_buffer_pool_new(int buffer_size, int count) {
+    return _zd_buffer_pool_new(buffer_size, count);
+  }
+
+  late final _zd_buffer_pool_newPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<zd_buffer_pool_t> Function(ffi.Size, ffi.Int32)
+        >
+      >('zd_buffer_pool_new');
+  late final _zd_buffer_pool_new = _zd_buffer_pool_newPtr
+      .asFunction<ffi.Pointer<zd_buffer_pool_t> Function(int, int)>();
+
+  /// Takes a free buffer from the pool.
+  ///
+  /// @param pool  The buffer pool.
+  /// @return A buffer of the pool's buffer size, or NULL if none is free or
+  /// the pool has been freed.
+  ffi.Pointer<ffi.Uint8> zd_buffer_pool_acquire(
+    ffi.Pointer<zd_buffer_pool_t> pool,
+  ) {
+    return _zd_buffer_pool_acquire(pool);
+  }
+
+  late final _zd_buffer_pool_acquirePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<zd_buffer_pool_t>)
+        >
+      >('zd_buffer_pool_acquire');
+  late final _zd_buffer_pool_acquire = _zd_buffer_pool_acquirePtr
+      .asFunction<
+        ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<zd_buffer_pool_t>)
+      >();
+
+  /// Returns a buffer taken with zd_buffer_pool_acquire() that was not
+  /// wrapped in bytes.
+  ///
+  /// @param pool  The buffer pool.
+  /// @param data  The buffer.
+  void zd_buffer_pool_release(
+    ffi.Pointer<zd_buffer_pool_t> pool,
+    ffi.Pointer<ffi.Uint8> data,
+  ) {
+    return _zd_buffer_pool_release(pool, data);
+  }
+
+  late final _zd_buffer_pool_releasePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Void Function(
+            ffi.Pointer<zd_buffer_pool_t>,
+            ffi.Pointer<ffi.Uint8>,
+          )
+        >
+      >('zd_buffer_pool_release');
+  late final _zd_buffer_pool_release = _zd_buffer_pool_releasePtr
+      .asFunction<
+        void Function(ffi.Pointer<zd_buffer_pool_t>, ffi.Pointer<ffi.Uint8>)
+      >();
+
+  /// Returns the number of free buffers in the pool.
+  ///
+  /// @param pool  The buffer pool.
+  /// @return Number of buffers zd_buffer_pool_acquire() can take right now.
+  int zd_buffer_pool_available(ffi.Pointer<zd_buffer_pool_t> pool) {
+    return _zd_buffer_pool_available(pool);
+  }
+
+  late final _zd_buffer_pool_availablePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<zd_buffer_pool_t>)>
+      >('zd_buffer_pool_available');
+  late final _zd_buffer_pool_available = _zd_buffer_pool_availablePtr
+      .asFunction<int Function(ffi.Pointer<zd_buffer_pool_t>)>();
+
+  /// Wraps the first `len` bytes of a pool buffer in owned bytes without
+  /// copying.
+  ///
+  /// Ownership of `data` passes to the bytes: the buffer returns to the pool
+  /// when the bytes and every clone of them are dropped, or right away if this
+  /// call fails. The caller must not write to it afterwards.
+  ///
+  /// @param bytes  Pointer to an uninitialized z_owned_bytes_t.
+  /// @param pool   The buffer pool `data` was acquired from.
+  /// @param data   A buffer taken with zd_buffer_pool_acquire().
+  /// @param len    Number of bytes to wrap (<= the pool's buffer size).
+  /// @return 0 on success, negative on failure.
+  int zd_bytes_from_pool_buffer(
+    ffi.Pointer<ffi.Opaque> bytes,
+    ffi.Pointer<zd_buffer_pool_t> pool,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+  ) {
+    return _zd_bytes_from_pool_buffer(bytes, pool, data, len);
+  }
+
+  late final _zd_bytes_from_pool_bufferPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<zd_buffer_pool_t>,
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Size,
+          )
+        >
+      >('zd_bytes_from_pool_buffer');
+  late final _zd_bytes_from_pool_buffer = _zd_bytes_from_pool_bufferPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<zd_buffer_pool_t>,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+        )
+      >();
+
+  /// Frees the pool.
+  ///
+  /// Buffers still referenced by bytes keep the pool's memory alive until
+  /// zenoh drops them; after this call zd_buffer_pool_acquire() returns NULL.
+  ///
+  /// @param pool  The buffer pool.
+  void zd_buffer_pool_free(ffi.Pointer<zd_buffer_pool_t> pool) {
+    return _zd_buffer_pool_free(pool);
+  }
+
+  late final _zd_buffer_pool_freePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<zd_buffer_pool_t>)>
+      >('zd_buffer_pool_free');
+  late final _zd_buffer_pool_free = _zd_buffer_pool_freePtr
+      .asFunction<void Function(ffi.Pointer<zd_buffer_pool_t>)>();
+
   /// Returns the size of z_owned_string_t in bytes.
   ///
   /// Used by Dart to allocate the correct amount of native memory
@@ -689,6 +861,57 @@ class ZenohDartBindings {
   late final _zd_view_string_len = _zd_view_string_lenPtr
       .asFunction<int Function(ffi.Pointer<ffi.Opaque>)>();
 
+  /// Returns the size of z_owned_encoding_t in bytes.
+  ///
+  /// Used by Dart to allocate the correct amount of native memory
+  /// for opaque zenoh types.
+  int zd_encoding_sizeof() {
+    return _zd_encoding_sizeof();
+  }
+
+  late final _zd_encoding_sizeofPtr =
+      _lookup<ffi.NativeFunction<ffi.Size Function()>>('zd_encoding_sizeof');
+  late final _zd_encoding_sizeof = _zd_encoding_sizeofPtr
+      .asFunction<int Function()>();
+
+  /// Parses a MIME type string into an owned encoding.
+  ///
+  /// A parsed encoding passed to the put and reply functions is cloned,
+  /// which is cheaper than parsing the string again on every call.
+  ///
+  /// @param encoding   Pointer to an uninitialized z_owned_encoding_t.
+  /// @param mime_type  Null-terminated MIME type string.
+  /// @return 0 on success, negative on failure.
+  int zd_encoding_from_str(
+    ffi.Pointer<ffi.Opaque> encoding,
+    ffi.Pointer<ffi.Char> mime_type,
+  ) {
+    return _zd_encoding_from_str(encoding, mime_type);
+  }
+
+  late final _zd_encoding_from_strPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Opaque>, ffi.Pointer<ffi.Char>)
+        >
+      >('zd_encoding_from_str');
+  late final _zd_encoding_from_str = _zd_encoding_from_strPtr
+      .asFunction<
+        int Function(ffi.Pointer<ffi.Opaque>, ffi.Pointer<ffi.Char>)
+      >();
+
+  /// Drops (frees) an owned encoding.
+  void zd_encoding_drop(ffi.Pointer<ffi.Opaque> encoding) {
+    return _zd_encoding_drop(encoding);
+  }
+
+  late final _zd_encoding_dropPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Opaque>)>>(
+        'zd_encoding_drop',
+      );
+  late final _zd_encoding_drop = _zd_encoding_dropPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Opaque>)>();
+
   /// Publishes data on the given key expression.
   ///
   /// The payload is consumed (moved) by this call -- the caller must not
@@ -761,25 +984,175 @@ class ZenohDartBindings {
   late final _zd_subscriber_sizeof = _zd_subscriber_sizeofPtr
       .asFunction<int Function()>();
 
+  /// Initializes subscriber options to their defaults (copying delivery,
+  /// all fields, no filters, no rate limit with state for up to 4096 keys,
+  /// no batching, 1 ms batch deadline, no encoding cache).
+  ///
+  /// @param options  Pointer to the options struct to initialize.
+  void zd_subscriber_options_default(
+    ffi.Pointer<zd_subscriber_options_t> options,
+  ) {
+    return _zd_subscriber_options_default(options);
+  }
+
+  late final _zd_subscriber_options_defaultPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<zd_subscriber_options_t>)
+        >
+      >('zd_subscriber_options_default');
+  late final _zd_subscriber_options_default = _zd_subscriber_options_defaultPtr
+      .asFunction<void Function(ffi.Pointer<zd_subscriber_options_t>)>();
+
+  /// Creates zeroed subscriber counters.
+  ///
+  /// @return The counters, or NULL on allocation failure. Release them with
+  /// zd_subscriber_stats_free().
+  ffi.Pointer<zd_subscriber_stats_t> zd_subscriber_stats_new() {
+    return _zd_subscriber_stats_new();
+  }
+
+  late final _zd_subscriber_stats_newPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Pointer<zd_subscriber_stats_t> Function()>
+      >('zd_subscriber_stats_new');
+  late final _zd_subscriber_stats_new = _zd_subscriber_stats_newPtr
+      .asFunction<ffi.Pointer<zd_subscriber_stats_t> Function()>();
+
+  /// Releases the caller's reference to subscriber counters. Subscribers
+  /// still counting into them keep them alive until they are dropped.
+  ///
+  /// @param stats  Counters from zd_subscriber_stats_new().
+  void zd_subscriber_stats_free(ffi.Pointer<zd_subscriber_stats_t> stats) {
+    return _zd_subscriber_stats_free(stats);
+  }
+
+  late final _zd_subscriber_stats_freePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<zd_subscriber_stats_t>)
+        >
+      >('zd_subscriber_stats_free');
+  late final _zd_subscriber_stats_free = _zd_subscriber_stats_freePtr
+      .asFunction<void Function(ffi.Pointer<zd_subscriber_stats_t>)>();
+
+  /// Creates a flow control for a subscriber.
+  ///
+  /// @param max_in_flight  Maximum unacknowledged samples (at least 1).
+  /// @param policy         A ZD_OVERFLOW_* policy.
+  /// @return The flow control, or NULL on allocation failure. Release it with
+  ///         zd_flow_control_free().
+  ffi.Pointer<zd_flow_control_t> zd_flow_control_new(
+    int max_in_flight,
+    int policy,
+  ) {
+    return _zd_flow_control_new(max_in_flight, policy);
+  }
+
+  late final _zd_flow_control_newPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<zd_flow_control_t> Function(ffi.Uint32, ffi.Uint8)
+        >
+      >('zd_flow_control_new');
+  late final _zd_flow_control_new = _zd_flow_control_newPtr
+      .asFunction<ffi.Pointer<zd_flow_control_t> Function(int, int)>();
+
+  /// Acknowledges samples Dart has consumed, posting queued samples and
+  /// waking blocked callbacks as room becomes available.
+  ///
+  /// @param flow   The flow control passed to the subscriber.
+  /// @param count  Number of samples consumed since the last acknowledgement.
+  void zd_flow_control_ack(ffi.Pointer<zd_flow_control_t> flow, int count) {
+    return _zd_flow_control_ack(flow, count);
+  }
+
+  late final _zd_flow_control_ackPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<zd_flow_control_t>, ffi.Uint32)
+        >
+      >('zd_flow_control_ack');
+  late final _zd_flow_control_ack = _zd_flow_control_ackPtr
+      .asFunction<void Function(ffi.Pointer<zd_flow_control_t>, int)>();
+
+  /// Returns the number of samples dropped by the overflow policy.
+  ///
+  /// @param flow  The flow control passed to the subscriber.
+  /// @return The dropped sample count.
+  int zd_flow_control_dropped(ffi.Pointer<zd_flow_control_t> flow) {
+    return _zd_flow_control_dropped(flow);
+  }
+
+  late final _zd_flow_control_droppedPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Uint64 Function(ffi.Pointer<zd_flow_control_t>)>
+      >('zd_flow_control_dropped');
+  late final _zd_flow_control_dropped = _zd_flow_control_droppedPtr
+      .asFunction<int Function(ffi.Pointer<zd_flow_control_t>)>();
+
+  /// Stops delivery: releases queued samples, wakes blocked callbacks and
+  /// drops every later sample. Call before dropping the subscriber so a
+  /// blocked callback cannot stall the undeclaration.
+  ///
+  /// @param flow  The flow control passed to the subscriber.
+  void zd_flow_control_close(ffi.Pointer<zd_flow_control_t> flow) {
+    return _zd_flow_control_close(flow);
+  }
+
+  late final _zd_flow_control_closePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<zd_flow_control_t>)>
+      >('zd_flow_control_close');
+  late final _zd_flow_control_close = _zd_flow_control_closePtr
+      .asFunction<void Function(ffi.Pointer<zd_flow_control_t>)>();
+
+  /// Closes a flow control and releases the caller's reference. A subscriber
+  /// still using it keeps it alive until the subscriber is dropped.
+  ///
+  /// @param flow  The flow control to release.
+  void zd_flow_control_free(ffi.Pointer<zd_flow_control_t> flow) {
+    return _zd_flow_control_free(flow);
+  }
+
+  late final _zd_flow_control_freePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<zd_flow_control_t>)>
+      >('zd_flow_control_free');
+  late final _zd_flow_control_free = _zd_flow_control_freePtr
+      .asFunction<void Function(ffi.Pointer<zd_flow_control_t>)>();
+
   /// Declares a subscriber on the given key expression.
   ///
   /// Samples are posted to the Dart isolate via `Dart_PostCObject_DL` on
   /// the given native port. Each sample is sent as a `Dart_CObject` array
-  /// of 4 elements: [keyexpr(string), payload(Uint8List), kind(int64),
-  /// attachment(null or Uint8List)].
+  /// of 5 elements: [keyexpr(string), payload(Uint8List), kind(int64),
+  /// attachment(null or Uint8List), encoding(string)], or as one flat
+  /// Uint8List when `options->flat` is set. Batching subscribers post an
+  /// array of such messages instead. Once the subscriber is dropped and its
+  /// last callback has returned, a null sentinel is posted as the final
+  /// message.
   ///
   /// @param session     Const pointer to a loaned session.
   /// @param subscriber  Pointer to an uninitialized z_owned_subscriber_t.
   /// @param keyexpr     Const pointer to a loaned key expression.
   /// @param dart_port   The Dart native port to post samples to.
+  /// @param options     Delivery options (NULL = defaults).
   /// @return 0 on success, negative on failure.
   int zd_declare_subscriber(
     ffi.Pointer<ffi.Opaque> session,
     ffi.Pointer<ffi.Opaque> subscriber,
     ffi.Pointer<ffi.Opaque> keyexpr,
     int dart_port,
+    ffi.Pointer<zd_subscriber_options_t> options,
   ) {
-    return _zd_declare_subscriber(session, subscriber, keyexpr, dart_port);
+    return _zd_declare_subscriber(
+      session,
+      subscriber,
+      keyexpr,
+      dart_port,
+      options,
+    );
   }
 
   late final _zd_declare_subscriberPtr =
@@ -790,6 +1163,7 @@ class ZenohDartBindings {
             ffi.Pointer<ffi.Opaque>,
             ffi.Pointer<ffi.Opaque>,
             ffi.Int64,
+            ffi.Pointer<zd_subscriber_options_t>,
           )
         >
       >('zd_declare_subscriber');
@@ -800,6 +1174,7 @@ class ZenohDartBindings {
           ffi.Pointer<ffi.Opaque>,
           ffi.Pointer<ffi.Opaque>,
           int,
+          ffi.Pointer<zd_subscriber_options_t>,
         )
       >();
 
@@ -831,13 +1206,20 @@ class ZenohDartBindings {
   /// @param session   Const pointer to a loaned session.
   /// @param key_expr  The key expression string.
   /// @param dart_port The Dart native port to post samples to.
+  /// @param options   Delivery options (NULL = defaults).
   /// @return 0 on success, negative on failure.
   int zd_declare_background_subscriber(
     ffi.Pointer<ffi.Opaque> session,
     ffi.Pointer<ffi.Char> key_expr,
     int dart_port,
+    ffi.Pointer<zd_subscriber_options_t> options,
   ) {
-    return _zd_declare_background_subscriber(session, key_expr, dart_port);
+    return _zd_declare_background_subscriber(
+      session,
+      key_expr,
+      dart_port,
+      options,
+    );
   }
 
   late final _zd_declare_background_subscriberPtr =
@@ -847,93 +1229,311 @@ class ZenohDartBindings {
             ffi.Pointer<ffi.Opaque>,
             ffi.Pointer<ffi.Char>,
             ffi.Int64,
+            ffi.Pointer<zd_subscriber_options_t>,
           )
         >
       >('zd_declare_background_subscriber');
   late final _zd_declare_background_subscriber =
       _zd_declare_background_subscriberPtr
           .asFunction<
-            int Function(ffi.Pointer<ffi.Opaque>, ffi.Pointer<ffi.Char>, int)
+            int Function(
+              ffi.Pointer<ffi.Opaque>,
+              ffi.Pointer<ffi.Char>,
+              int,
+              ffi.Pointer<zd_subscriber_options_t>,
+            )
           >();
 
-  /// Returns the size of z_owned_publisher_t in bytes.
-  int zd_publisher_sizeof() {
-    return _zd_publisher_sizeof();
-  }
-
-  late final _zd_publisher_sizeofPtr =
-      _lookup<ffi.NativeFunction<ffi.Size Function()>>('zd_publisher_sizeof');
-  late final _zd_publisher_sizeof = _zd_publisher_sizeofPtr
-      .asFunction<int Function()>();
-
-  /// Declares a publisher on the given key expression.
+  /// Declares a subscriber that spreads samples across several Dart ports,
+  /// typically one per worker isolate.
   ///
-  /// @param session             Const pointer to a loaned session.
-  /// @param publisher           Pointer to an uninitialized z_owned_publisher_t.
-  /// @param keyexpr             Const pointer to a loaned key expression.
-  /// @param encoding            MIME type string for default encoding (NULL = default).
-  /// @param congestion_control  Congestion control strategy (-1 = default/block).
-  /// @param priority            Message priority (-1 = default/data=5).
-  /// @param is_express          Express mode (-1 = default, 0 = false, 1 = true).
+  /// Each port gets its own delivery state built from `options` (interned
+  /// keys, encoding cache, batching, rate limits), so every port receives
+  /// messages exactly as from zd_declare_subscriber(), including the
+  /// definitions for the ids it sees. When the subscriber is dropped a null
+  /// sentinel is posted to every port.
+  ///
+  /// @param session      Const pointer to a loaned session.
+  /// @param subscriber   Pointer to an uninitialized z_owned_subscriber_t.
+  /// @param keyexpr      Const pointer to a loaned key expression.
+  /// @param dart_ports   Array of `shard_count` Dart native ports.
+  /// @param shard_count  Number of ports (at least 1).
+  /// @param mode         A ZD_SHARD_* mode.
+  /// @param options      Delivery options for every shard (NULL = defaults).
+  /// `flow_control` must be NULL; `stats` is shared.
+  /// A rate limit requires ZD_SHARD_BY_KEY.
   /// @return 0 on success, negative on failure.
-  int zd_declare_publisher(
+  int zd_declare_sharded_subscriber(
     ffi.Pointer<ffi.Opaque> session,
-    ffi.Pointer<ffi.Opaque> publisher,
+    ffi.Pointer<ffi.Opaque> subscriber,
     ffi.Pointer<ffi.Opaque> keyexpr,
-    ffi.Pointer<ffi.Char> encoding,
-    int congestion_control,
-    int priority,
-    int is_express,
+    ffi.Pointer<ffi.Int64> dart_ports,
+    int shard_count,
+    int mode,
+    ffi.Pointer<zd_subscriber_options_t> options,
   ) {
-    return _zd_declare_publisher(
+    return _zd_declare_sharded_subscriber(
       session,
-      publisher,
+      subscriber,
       keyexpr,
-      encoding,
-      congestion_control,
-      priority,
-      is_express,
+      dart_ports,
+      shard_count,
+      mode,
+      options,
     );
   }
 
-  late final _zd_declare_publisherPtr =
+  late final _zd_declare_sharded_subscriberPtr =
       _lookup<
         ffi.NativeFunction<
           ffi.Int Function(
             ffi.Pointer<ffi.Opaque>,
             ffi.Pointer<ffi.Opaque>,
             ffi.Pointer<ffi.Opaque>,
-            ffi.Pointer<ffi.Char>,
-            ffi.Int,
-            ffi.Int,
-            ffi.Int8,
+            ffi.Pointer<ffi.Int64>,
+            ffi.Size,
+            ffi.Uint8,
+            ffi.Pointer<zd_subscriber_options_t>,
           )
         >
-      >('zd_declare_publisher');
-  late final _zd_declare_publisher = _zd_declare_publisherPtr
-      .asFunction<
-        int Function(
-          ffi.Pointer<ffi.Opaque>,
-          ffi.Pointer<ffi.Opaque>,
-          ffi.Pointer<ffi.Opaque>,
-          ffi.Pointer<ffi.Char>,
-          int,
-          int,
-          int,
-        )
-      >();
+      >('zd_declare_sharded_subscriber');
+  late final _zd_declare_sharded_subscriber =
+      _zd_declare_sharded_subscriberPtr
+          .asFunction<
+            int Function(
+              ffi.Pointer<ffi.Opaque>,
+              ffi.Pointer<ffi.Opaque>,
+              ffi.Pointer<ffi.Opaque>,
+              ffi.Pointer<ffi.Int64>,
+              int,
+              int,
+              ffi.Pointer<zd_subscriber_options_t>,
+            )
+          >();
 
-  /// Obtains a const loaned reference to the publisher.
-  ffi.Pointer<ffi.Opaque> zd_publisher_loan(ffi.Pointer<ffi.Opaque> publisher) {
-    return _zd_publisher_loan(publisher);
+  /// Copies the payload of a lazily delivered sample into a caller buffer.
+  ///
+  /// Pass a NULL `payload_out` to query the length only.
+  ///
+  /// @param sample       Pointer to a heap-allocated z_owned_sample_t posted
+  /// by a lazy subscriber (as uint8_t*).
+  /// @param payload_out  Buffer to receive the payload, or NULL.
+  /// @param max_len      Maximum number of bytes to copy.
+  /// @return The full payload length in bytes.
+  int zd_sample_payload(
+    ffi.Pointer<ffi.Uint8> sample,
+    ffi.Pointer<ffi.Uint8> payload_out,
+    int max_len,
+  ) {
+    return _zd_sample_payload(sample, payload_out, max_len);
   }
 
-  late final _zd_publisher_loanPtr =
+  late final _zd_sample_payloadPtr =
       _lookup<
         ffi.NativeFunction<
-          ffi.Pointer<ffi.Opaque> Function(ffi.Pointer<ffi.Opaque>)
-        >
-      >('zd_publisher_loan');
+          ffi.Int64 Function(
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Size,
+          )
+        >
+      >('zd_sample_payload');
+  late final _zd_sample_payload = _zd_sample_payloadPtr
+      .asFunction<
+        int Function(ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint8>, int)
+      >();
+
+  /// Copies the attachment of a lazily delivered sample into a caller buffer.
+  ///
+  /// Pass a NULL `attachment_out` to query the length only.
+  ///
+  /// @param sample          Pointer to a lazily delivered sample (as uint8_t*).
+  /// @param attachment_out  Buffer to receive the attachment, or NULL.
+  /// @param max_len         Maximum number of bytes to copy.
+  /// @return The full attachment length in bytes, or -1 if there is none.
+  int zd_sample_attachment(
+    ffi.Pointer<ffi.Uint8> sample,
+    ffi.Pointer<ffi.Uint8> attachment_out,
+    int max_len,
+  ) {
+    return _zd_sample_attachment(sample, attachment_out, max_len);
+  }
+
+  late final _zd_sample_attachmentPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int64 Function(
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Size,
+          )
+        >
+      >('zd_sample_attachment');
+  late final _zd_sample_attachment = _zd_sample_attachmentPtr
+      .asFunction<
+        int Function(ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint8>, int)
+      >();
+
+  /// Returns the encoding of a lazily delivered sample as a string.
+  ///
+  /// @param sample  Pointer to a lazily delivered sample (as uint8_t*).
+  /// @return Malloc'd null-terminated string the caller must free, or NULL
+  /// on allocation failure.
+  ffi.Pointer<ffi.Char> zd_sample_encoding(ffi.Pointer<ffi.Uint8> sample) {
+    return _zd_sample_encoding(sample);
+  }
+
+  late final _zd_sample_encodingPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Uint8>)
+        >
+      >('zd_sample_encoding');
+  late final _zd_sample_encoding = _zd_sample_encodingPtr
+      .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Uint8>)>();
+
+  /// Reads the timestamp of a lazily delivered sample.
+  ///
+  /// @param sample     Pointer to a lazily delivered sample (as uint8_t*).
+  /// @param ntp64_out  Receives the NTP64 time when the sample has one.
+  /// @return true if the sample carries a timestamp.
+  bool zd_sample_timestamp(
+    ffi.Pointer<ffi.Uint8> sample,
+    ffi.Pointer<ffi.Uint64> ntp64_out,
+  ) {
+    return _zd_sample_timestamp(sample, ntp64_out);
+  }
+
+  late final _zd_sample_timestampPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint64>)
+        >
+      >('zd_sample_timestamp');
+  late final _zd_sample_timestamp = _zd_sample_timestampPtr
+      .asFunction<
+        bool Function(ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint64>)
+      >();
+
+  /// Reads the timestamp, source and QoS of a lazily delivered sample.
+  ///
+  /// @param sample        Pointer to a lazily delivered sample (as uint8_t*).
+  /// @param metadata_out  Receives the metadata.
+  void zd_sample_metadata(
+    ffi.Pointer<ffi.Uint8> sample,
+    ffi.Pointer<zd_sample_metadata_t> metadata_out,
+  ) {
+    return _zd_sample_metadata(sample, metadata_out);
+  }
+
+  late final _zd_sample_metadataPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Void Function(
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Pointer<zd_sample_metadata_t>,
+          )
+        >
+      >('zd_sample_metadata');
+  late final _zd_sample_metadata = _zd_sample_metadataPtr
+      .asFunction<
+        void Function(ffi.Pointer<ffi.Uint8>, ffi.Pointer<zd_sample_metadata_t>)
+      >();
+
+  /// Drops a lazily delivered sample and frees its heap allocation.
+  ///
+  /// Matches the NativeFinalizer signature so Dart can attach it directly.
+  ///
+  /// @param sample  Pointer to a lazily delivered sample (as uint8_t*).
+  void zd_sample_drop(ffi.Pointer<ffi.Uint8> sample) {
+    return _zd_sample_drop(sample);
+  }
+
+  late final _zd_sample_dropPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Uint8>)>>(
+        'zd_sample_drop',
+      );
+  late final _zd_sample_drop = _zd_sample_dropPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Uint8>)>();
+
+  /// Returns the size of z_owned_publisher_t in bytes.
+  int zd_publisher_sizeof() {
+    return _zd_publisher_sizeof();
+  }
+
+  late final _zd_publisher_sizeofPtr =
+      _lookup<ffi.NativeFunction<ffi.Size Function()>>('zd_publisher_sizeof');
+  late final _zd_publisher_sizeof = _zd_publisher_sizeofPtr
+      .asFunction<int Function()>();
+
+  /// Declares a publisher on the given key expression.
+  ///
+  /// @param session             Const pointer to a loaned session.
+  /// @param publisher           Pointer to an uninitialized z_owned_publisher_t.
+  /// @param keyexpr             Const pointer to a loaned key expression.
+  /// @param encoding            MIME type string for default encoding (NULL = default).
+  /// @param congestion_control  Congestion control strategy (-1 = default/block).
+  /// @param priority            Message priority (-1 = default/data=5).
+  /// @param is_express          Express mode (-1 = default, 0 = false, 1 = true).
+  /// @return 0 on success, negative on failure.
+  int zd_declare_publisher(
+    ffi.Pointer<ffi.Opaque> session,
+    ffi.Pointer<ffi.Opaque> publisher,
+    ffi.Pointer<ffi.Opaque> keyexpr,
+    ffi.Pointer<ffi.Char> encoding,
+    int congestion_control,
+    int priority,
+    int is_express,
+  ) {
+    return _zd_declare_publisher(
+      session,
+      publisher,
+      keyexpr,
+      encoding,
+      congestion_control,
+      priority,
+      is_express,
+    );
+  }
+
+  late final _zd_declare_publisherPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Int,
+            ffi.Int,
+            ffi.Int8,
+          )
+        >
+      >('zd_declare_publisher');
+  late final _zd_declare_publisher = _zd_declare_publisherPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<ffi.Char>,
+          int,
+          int,
+          int,
+        )
+      >();
+
+  /// Obtains a const loaned reference to the publisher.
+  ffi.Pointer<ffi.Opaque> zd_publisher_loan(ffi.Pointer<ffi.Opaque> publisher) {
+    return _zd_publisher_loan(publisher);
+  }
+
+  late final _zd_publisher_loanPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<ffi.Opaque> Function(ffi.Pointer<ffi.Opaque>)
+        >
+      >('zd_publisher_loan');
   late final _zd_publisher_loan = _zd_publisher_loanPtr
       .asFunction<ffi.Pointer<ffi.Opaque> Function(ffi.Pointer<ffi.Opaque>)>();
 
@@ -954,15 +1554,23 @@ class ZenohDartBindings {
   /// @param publisher   Const pointer to a loaned publisher.
   /// @param payload     Pointer to owned bytes (consumed via z_bytes_move).
   /// @param encoding    MIME type string for per-put encoding override (NULL = publisher default).
+  /// @param compiled_encoding  Parsed encoding override, cloned (NULL = use `encoding`).
   /// @param attachment  Pointer to owned bytes for attachment (consumed if non-NULL, NULL = no attachment).
   /// @return 0 on success, negative on failure.
   int zd_publisher_put(
     ffi.Pointer<ffi.Opaque> publisher,
     ffi.Pointer<ffi.Opaque> payload,
     ffi.Pointer<ffi.Char> encoding,
+    ffi.Pointer<ffi.Opaque> compiled_encoding,
     ffi.Pointer<ffi.Opaque> attachment,
   ) {
-    return _zd_publisher_put(publisher, payload, encoding, attachment);
+    return _zd_publisher_put(
+      publisher,
+      payload,
+      encoding,
+      compiled_encoding,
+      attachment,
+    );
   }
 
   late final _zd_publisher_putPtr =
@@ -973,6 +1581,7 @@ class ZenohDartBindings {
             ffi.Pointer<ffi.Opaque>,
             ffi.Pointer<ffi.Char>,
             ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
           )
         >
       >('zd_publisher_put');
@@ -983,9 +1592,132 @@ class ZenohDartBindings {
           ffi.Pointer<ffi.Opaque>,
           ffi.Pointer<ffi.Char>,
           ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<ffi.Opaque>,
+        )
+      >();
+
+  /// Publishes `count` payloads through the publisher in one call.
+  ///
+  /// Each payload (and attachment, if any) is copied into fresh zenoh bytes
+  /// and published in order with z_publisher_put. The encoding override is
+  /// parsed once for the whole batch. Publishing stops at the first failure.
+  ///
+  /// @param publisher        Const pointer to a loaned publisher.
+  /// @param payloads         Array of `count` payload pointers.
+  /// @param payload_lens     Array of `count` payload lengths.
+  /// @param attachments      Array of `count` attachment pointers, NULL
+  /// entries for no attachment (NULL = none at all).
+  /// @param attachment_lens  Array of `count` attachment lengths (ignored when
+  /// `attachments` is NULL).
+  /// @param count            Number of messages.
+  /// @param encoding         MIME type string for a per-batch encoding override (NULL = publisher default).
+  /// @param compiled_encoding  Parsed encoding override (NULL = use `encoding`).
+  /// @param published_out    Out: number of messages published.
+  /// @return 0 on success, negative on failure (of message `*published_out`).
+  int zd_publisher_put_batch(
+    ffi.Pointer<ffi.Opaque> publisher,
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> payloads,
+    ffi.Pointer<ffi.Size> payload_lens,
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> attachments,
+    ffi.Pointer<ffi.Size> attachment_lens,
+    int count,
+    ffi.Pointer<ffi.Char> encoding,
+    ffi.Pointer<ffi.Opaque> compiled_encoding,
+    ffi.Pointer<ffi.Int32> published_out,
+  ) {
+    return _zd_publisher_put_batch(
+      publisher,
+      payloads,
+      payload_lens,
+      attachments,
+      attachment_lens,
+      count,
+      encoding,
+      compiled_encoding,
+      published_out,
+    );
+  }
+
+  late final _zd_publisher_put_batchPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+            ffi.Pointer<ffi.Size>,
+            ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+            ffi.Pointer<ffi.Size>,
+            ffi.Int32,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Int32>,
+          )
+        >
+      >('zd_publisher_put_batch');
+  late final _zd_publisher_put_batch = _zd_publisher_put_batchPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+          ffi.Pointer<ffi.Size>,
+          ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+          ffi.Pointer<ffi.Size>,
+          int,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<ffi.Int32>,
         )
       >();
 
+  /// Runs a publish loop on a native thread to measure throughput without
+  /// Dart or FFI overhead.
+  ///
+  /// A payload of `payload_size` bytes is built once; each iteration
+  /// publishes a shallow clone of it with z_publisher_put, as z_pub_thr
+  /// does. The loop stops after `count` messages or `duration_us`
+  /// microseconds, whichever comes first, or at the first failed put. It
+  /// then posts [messages, bytes, elapsed_ns, rc] (all Int64) to `dart_port`.
+  ///
+  /// The publisher must stay declared until the result is posted.
+  ///
+  /// @param publisher     Const pointer to a loaned publisher.
+  /// @param payload_size  Size of each payload in bytes.
+  /// @param count         Number of messages to publish (0 = no limit).
+  /// @param duration_us   Time limit in microseconds (0 = no limit).
+  /// @param dart_port     The Dart native port to post the result to.
+  /// @return 0 if the loop was started, negative on invalid arguments
+  /// (no limit at all) or if the thread could not be created.
+  int zd_publisher_benchmark(
+    ffi.Pointer<ffi.Opaque> publisher,
+    int payload_size,
+    int count,
+    int duration_us,
+    int dart_port,
+  ) {
+    return _zd_publisher_benchmark(
+      publisher,
+      payload_size,
+      count,
+      duration_us,
+      dart_port,
+    );
+  }
+
+  late final _zd_publisher_benchmarkPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Size,
+            ffi.Uint64,
+            ffi.Uint64,
+            ffi.Int64,
+          )
+        >
+      >('zd_publisher_benchmark');
+  late final _zd_publisher_benchmark = _zd_publisher_benchmarkPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Opaque>, int, int, int, int)>();
+
   /// Sends a DELETE through the publisher.
   int zd_publisher_delete(ffi.Pointer<ffi.Opaque> publisher) {
     return _zd_publisher_delete(publisher);
@@ -1380,14 +2112,23 @@ class ZenohDartBindings {
   /// @param key_expr     Null-terminated key expression string.
   /// @param payload      Pointer to z_owned_bytes_t (consumed via z_bytes_move).
   /// @param encoding     MIME type string (NULL = default).
+  /// @param compiled_encoding  Parsed z_owned_encoding_t, cloned (as uint8_t*;
+  /// NULL = use `encoding`).
   /// @return 0 on success, negative on failure.
   int zd_query_reply(
     ffi.Pointer<ffi.Uint8> query,
     ffi.Pointer<ffi.Char> key_expr,
     ffi.Pointer<ffi.Uint8> payload,
     ffi.Pointer<ffi.Char> encoding,
+    ffi.Pointer<ffi.Uint8> compiled_encoding,
   ) {
-    return _zd_query_reply(query, key_expr, payload, encoding);
+    return _zd_query_reply(
+      query,
+      key_expr,
+      payload,
+      encoding,
+      compiled_encoding,
+    );
   }
 
   late final _zd_query_replyPtr =
@@ -1398,6 +2139,7 @@ class ZenohDartBindings {
             ffi.Pointer<ffi.Char>,
             ffi.Pointer<ffi.Uint8>,
             ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Uint8>,
           )
         >
       >('zd_query_reply');
@@ -1408,6 +2150,7 @@ class ZenohDartBindings {
           ffi.Pointer<ffi.Char>,
           ffi.Pointer<ffi.Uint8>,
           ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Uint8>,
         )
       >();
 
@@ -1730,131 +2473,724 @@ class ZenohDartBindings {
   late final _zd_ring_handler_sample_sizeof = _zd_ring_handler_sample_sizeofPtr
       .asFunction<int Function()>();
 
-  /// Declares a pull subscriber using a ring channel buffer.
+  /// Returns the size of z_owned_fifo_handler_sample_t in bytes.
+  int zd_fifo_handler_sample_sizeof() {
+    return _zd_fifo_handler_sample_sizeof();
+  }
+
+  late final _zd_fifo_handler_sample_sizeofPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
+        'zd_fifo_handler_sample_sizeof',
+      );
+  late final _zd_fifo_handler_sample_sizeof = _zd_fifo_handler_sample_sizeofPtr
+      .asFunction<int Function()>();
+
+  /// Declares a pull subscriber using a ring or FIFO channel buffer.
+  ///
+  /// @param subscriber_out  Pointer to an uninitialized z_owned_subscriber_t (as uint8_t*).
+  /// @param handler_out     Pointer to an uninitialized z_owned_ring_handler_sample_t
+  /// or z_owned_fifo_handler_sample_t, per `channel` (as uint8_t*).
+  /// @param session         Const pointer to a loaned session (as uint8_t*).
+  /// @param key_expr        Null-terminated key expression string.
+  /// @param capacity        Channel buffer capacity.
+  /// @param channel         A ZD_PULL_CHANNEL_* kind.
+  /// @param waiter_out      Out: arrival waiter for the channel, set on success.
+  /// @return 0 on success, negative on failure.
+  int zd_declare_pull_subscriber(
+    ffi.Pointer<ffi.Uint8> subscriber_out,
+    ffi.Pointer<ffi.Uint8> handler_out,
+    ffi.Pointer<ffi.Uint8> session,
+    ffi.Pointer<ffi.Char> key_expr,
+    int capacity,
+    int channel,
+    ffi.Pointer<ffi.Pointer<zd_pull_waiter_t>> waiter_out,
+  ) {
+    return _zd_declare_pull_subscriber(
+      subscriber_out,
+      handler_out,
+      session,
+      key_expr,
+      capacity,
+      channel,
+      waiter_out,
+    );
+  }
+
+  late final _zd_declare_pull_subscriberPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int8 Function(
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Int32,
+            ffi.Int8,
+            ffi.Pointer<ffi.Pointer<zd_pull_waiter_t>>,
+          )
+        >
+      >('zd_declare_pull_subscriber');
+  late final _zd_declare_pull_subscriber = _zd_declare_pull_subscriberPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Uint8>,
+          ffi.Pointer<ffi.Uint8>,
+          ffi.Pointer<ffi.Uint8>,
+          ffi.Pointer<ffi.Char>,
+          int,
+          int,
+          ffi.Pointer<ffi.Pointer<zd_pull_waiter_t>>,
+        )
+      >();
+
+  /// Returns the number of samples pushed into the channel so far.
+  ///
+  /// Read it before trying to receive, then pass it as `seen` to
+  /// zd_pull_waiter_wait() or zd_pull_waiter_arm() so that an arrival in
+  /// between is never missed.
+  ///
+  /// @param waiter  The pull subscriber's waiter.
+  /// @return The arrival count.
+  int zd_pull_waiter_arrivals(ffi.Pointer<zd_pull_waiter_t> waiter) {
+    return _zd_pull_waiter_arrivals(waiter);
+  }
+
+  late final _zd_pull_waiter_arrivalsPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Uint64 Function(ffi.Pointer<zd_pull_waiter_t>)>
+      >('zd_pull_waiter_arrivals');
+  late final _zd_pull_waiter_arrivals = _zd_pull_waiter_arrivalsPtr
+      .asFunction<int Function(ffi.Pointer<zd_pull_waiter_t>)>();
+
+  /// Blocks until a sample arrives after `seen`, the subscriber is dropped
+  /// or the timeout expires.
+  ///
+  /// @param waiter      The pull subscriber's waiter.
+  /// @param seen        Arrival count read before the last receive attempt.
+  /// @param timeout_us  Timeout in microseconds, or negative to wait forever.
+  /// @return 0 if a sample arrived, 1 on timeout, -1 if the subscriber was
+  /// dropped (buffered samples can still be received).
+  int zd_pull_waiter_wait(
+    ffi.Pointer<zd_pull_waiter_t> waiter,
+    int seen,
+    int timeout_us,
+  ) {
+    return _zd_pull_waiter_wait(waiter, seen, timeout_us);
+  }
+
+  late final _zd_pull_waiter_waitPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int8 Function(
+            ffi.Pointer<zd_pull_waiter_t>,
+            ffi.Uint64,
+            ffi.Int64,
+          )
+        >
+      >('zd_pull_waiter_wait');
+  late final _zd_pull_waiter_wait = _zd_pull_waiter_waitPtr
+      .asFunction<int Function(ffi.Pointer<zd_pull_waiter_t>, int, int)>();
+
+  /// Arms a one-shot doorbell: a null message is posted to `dart_port` when
+  /// the next sample arrives or the subscriber is dropped.
+  ///
+  /// @param waiter     The pull subscriber's waiter.
+  /// @param dart_port  Native port to post the doorbell to.
+  /// @param seen       Arrival count read before the last receive attempt.
+  /// @return 0 if armed, 1 if a sample already arrived after `seen` (not
+  /// armed), -1 if the subscriber was dropped (not armed).
+  int zd_pull_waiter_arm(
+    ffi.Pointer<zd_pull_waiter_t> waiter,
+    int dart_port,
+    int seen,
+  ) {
+    return _zd_pull_waiter_arm(waiter, dart_port, seen);
+  }
+
+  late final _zd_pull_waiter_armPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int8 Function(
+            ffi.Pointer<zd_pull_waiter_t>,
+            ffi.Int64,
+            ffi.Uint64,
+          )
+        >
+      >('zd_pull_waiter_arm');
+  late final _zd_pull_waiter_arm = _zd_pull_waiter_armPtr
+      .asFunction<int Function(ffi.Pointer<zd_pull_waiter_t>, int, int)>();
+
+  /// Releases the caller's reference to a pull waiter.
+  ///
+  /// @param waiter  The pull subscriber's waiter.
+  void zd_pull_waiter_free(ffi.Pointer<zd_pull_waiter_t> waiter) {
+    return _zd_pull_waiter_free(waiter);
+  }
+
+  late final _zd_pull_waiter_freePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<zd_pull_waiter_t>)>
+      >('zd_pull_waiter_free');
+  late final _zd_pull_waiter_free = _zd_pull_waiter_freePtr
+      .asFunction<void Function(ffi.Pointer<zd_pull_waiter_t>)>();
+
+  /// Tries to receive a sample from the channel handler.
+  ///
+  /// Return codes: 0=sample available, 1=channel disconnected, 2=buffer empty.
+  /// When 0, all out_ parameters are populated (malloc'd; caller must free).
+  /// The payload and attachment are read directly into buffers sized by
+  /// z_bytes_len(), so each is copied exactly once; the caller may adopt
+  /// them instead of copying again.
+  ///
+  /// @param handler           Const pointer to an owned ring or FIFO handler (as uint8_t*).
+  /// @param channel           The ZD_PULL_CHANNEL_* kind of `handler`.
+  /// @param out_keyexpr       Out: malloc'd null-terminated key expression string.
+  /// @param out_payload       Out: malloc'd payload bytes (or NULL if empty).
+  /// @param out_payload_len   Out: payload length.
+  /// @param out_kind          Out: sample kind (0=put, 1=delete).
+  /// @param out_encoding      Out: malloc'd null-terminated encoding string (or NULL).
+  /// @param out_attachment     Out: malloc'd attachment bytes (or NULL if absent or empty).
+  /// @param out_attachment_len Out: attachment length.
+  /// @return 0=sample, 1=disconnected, 2=empty.
+  int zd_pull_subscriber_try_recv(
+    ffi.Pointer<ffi.Uint8> handler,
+    int channel,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> out_keyexpr,
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> out_payload,
+    ffi.Pointer<ffi.Int32> out_payload_len,
+    ffi.Pointer<ffi.Int8> out_kind,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> out_encoding,
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> out_attachment,
+    ffi.Pointer<ffi.Int32> out_attachment_len,
+  ) {
+    return _zd_pull_subscriber_try_recv(
+      handler,
+      channel,
+      out_keyexpr,
+      out_payload,
+      out_payload_len,
+      out_kind,
+      out_encoding,
+      out_attachment,
+      out_attachment_len,
+    );
+  }
+
+  late final _zd_pull_subscriber_try_recvPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int8 Function(
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Int8,
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+            ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+            ffi.Pointer<ffi.Int32>,
+            ffi.Pointer<ffi.Int8>,
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+            ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+            ffi.Pointer<ffi.Int32>,
+          )
+        >
+      >('zd_pull_subscriber_try_recv');
+  late final _zd_pull_subscriber_try_recv = _zd_pull_subscriber_try_recvPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Uint8>,
+          int,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+          ffi.Pointer<ffi.Int32>,
+          ffi.Pointer<ffi.Int8>,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+          ffi.Pointer<ffi.Int32>,
+        )
+      >();
+
+  /// Tries to receive a sample from the channel handler into a reusable
+  /// descriptor.
+  ///
+  /// Unlike zd_pull_subscriber_try_recv(), the fields are written in place
+  /// into `recv` rather than into fresh malloc'd buffers, and an unchanged
+  /// key expression or encoding is not copied again.
+  ///
+  /// @param handler  Const pointer to an owned ring or FIFO handler (as uint8_t*).
+  /// @param channel  The ZD_PULL_CHANNEL_* kind of `handler`.
+  /// @param recv     Descriptor to fill; see zd_pull_recv_t.
+  /// @return 0=sample, 1=disconnected, 2=empty, -1 if a scratch buffer could
+  /// not be grown (the sample is lost).
+  int zd_pull_subscriber_try_recv_into(
+    ffi.Pointer<ffi.Uint8> handler,
+    int channel,
+    ffi.Pointer<zd_pull_recv_t> recv,
+  ) {
+    return _zd_pull_subscriber_try_recv_into(handler, channel, recv);
+  }
+
+  late final _zd_pull_subscriber_try_recv_intoPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int8 Function(
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Int8,
+            ffi.Pointer<zd_pull_recv_t>,
+          )
+        >
+      >('zd_pull_subscriber_try_recv_into');
+  late final _zd_pull_subscriber_try_recv_into =
+      _zd_pull_subscriber_try_recv_intoPtr
+          .asFunction<
+            int Function(
+              ffi.Pointer<ffi.Uint8>,
+              int,
+              ffi.Pointer<zd_pull_recv_t>,
+            )
+          >();
+
+  /// Frees the scratch buffers of a receive descriptor and zeroes it.
+  ///
+  /// A payload whose ownership passed to the caller is not freed.
+  ///
+  /// @param recv  The descriptor.
+  void zd_pull_recv_release(ffi.Pointer<zd_pull_recv_t> recv) {
+    return _zd_pull_recv_release(recv);
+  }
+
+  late final _zd_pull_recv_releasePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<zd_pull_recv_t>)>
+      >('zd_pull_recv_release');
+  late final _zd_pull_recv_release = _zd_pull_recv_releasePtr
+      .asFunction<void Function(ffi.Pointer<zd_pull_recv_t>)>();
+
+  /// Drains up to `max_samples` samples from the channel handler into `arena`
+  /// in one call.
+  ///
+  /// Samples are written back to back as frames: an 8-byte prefix whose
+  /// first uint32 is the frame length, followed by the sample in the flat
+  /// wire format (see zd_sample_wire_header_t) padded to 8 bytes. Draining
+  /// stops at the first sample that does not fit in the rest of the arena;
+  /// that sample is framed into a malloc'd buffer returned through
+  /// `overflow_out` instead of being lost.
+  ///
+  /// @param handler         Const pointer to an owned ring or FIFO handler (as uint8_t*).
+  /// @param channel         The ZD_PULL_CHANNEL_* kind of `handler`.
+  /// @param arena           Buffer receiving the frames.
+  /// @param arena_len       Size of `arena` in bytes.
+  /// @param max_samples     Maximum number of samples to drain into `arena`.
+  /// @param arena_used_out  Out: number of bytes written to `arena`.
+  /// @param overflow_out    Out: malloc'd frame of a sample that did not fit
+  /// (caller must free), or NULL.
+  /// @return The number of frames written to `arena`, -1 if the channel is
+  /// disconnected and empty, or -2 if the frame of a sample that did
+  /// not fit could not be allocated. That sample is lost;
+  /// `arena_used_out` still covers the frames written before it.
+  int zd_pull_subscriber_try_recv_batch(
+    ffi.Pointer<ffi.Uint8> handler,
+    int channel,
+    ffi.Pointer<ffi.Uint8> arena,
+    int arena_len,
+    int max_samples,
+    ffi.Pointer<ffi.Size> arena_used_out,
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> overflow_out,
+  ) {
+    return _zd_pull_subscriber_try_recv_batch(
+      handler,
+      channel,
+      arena,
+      arena_len,
+      max_samples,
+      arena_used_out,
+      overflow_out,
+    );
+  }
+
+  late final _zd_pull_subscriber_try_recv_batchPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int32 Function(
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Int8,
+            ffi.Pointer<ffi.Uint8>,
+            ffi.Size,
+            ffi.Int32,
+            ffi.Pointer<ffi.Size>,
+            ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+          )
+        >
+      >('zd_pull_subscriber_try_recv_batch');
+  late final _zd_pull_subscriber_try_recv_batch =
+      _zd_pull_subscriber_try_recv_batchPtr
+          .asFunction<
+            int Function(
+              ffi.Pointer<ffi.Uint8>,
+              int,
+              ffi.Pointer<ffi.Uint8>,
+              int,
+              int,
+              ffi.Pointer<ffi.Size>,
+              ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+            )
+          >();
+
+  /// Drops (frees) the ring handler.
+  ///
+  /// @param handler  Pointer to a z_owned_ring_handler_sample_t (as uint8_t*).
+  void zd_ring_handler_sample_drop(ffi.Pointer<ffi.Uint8> handler) {
+    return _zd_ring_handler_sample_drop(handler);
+  }
+
+  late final _zd_ring_handler_sample_dropPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Uint8>)>>(
+        'zd_ring_handler_sample_drop',
+      );
+  late final _zd_ring_handler_sample_drop = _zd_ring_handler_sample_dropPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Uint8>)>();
+
+  /// Drops (frees) the FIFO handler.
+  ///
+  /// @param handler  Pointer to a z_owned_fifo_handler_sample_t (as uint8_t*).
+  void zd_fifo_handler_sample_drop(ffi.Pointer<ffi.Uint8> handler) {
+    return _zd_fifo_handler_sample_drop(handler);
+  }
+
+  late final _zd_fifo_handler_sample_dropPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Uint8>)>>(
+        'zd_fifo_handler_sample_drop',
+      );
+  late final _zd_fifo_handler_sample_drop = _zd_fifo_handler_sample_dropPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Uint8>)>();
+
+  /// Declares a subscriber that writes samples into a shared ring.
+  ///
+  /// Dart reads frames between its tail and zd_sample_ring_acquire()
+  /// directly from zd_sample_ring_data(), then returns the space with
+  /// zd_sample_ring_release(). A doorbell (an int64) is posted to
+  /// `dart_port` only when a sample arrives after Dart armed it by
+  /// releasing an empty ring. Samples that do not fit are dropped and
+  /// counted, never blocking the zenoh callback.
+  ///
+  /// The ring is freed when the subscriber is dropped.
+  ///
+  /// @param session     Const pointer to a loaned session.
+  /// @param subscriber  Pointer to an uninitialized z_owned_subscriber_t.
+  /// @param keyexpr     Const pointer to a loaned key expression.
+  /// @param dart_port   The Dart native port to post doorbells to.
+  /// @param capacity    Ring size in bytes, rounded up to a power of two.
+  /// @param ring_out    Receives the ring on success.
+  /// @return 0 on success, negative on failure.
+  int zd_declare_ring_subscriber(
+    ffi.Pointer<ffi.Opaque> session,
+    ffi.Pointer<ffi.Opaque> subscriber,
+    ffi.Pointer<ffi.Opaque> keyexpr,
+    int dart_port,
+    int capacity,
+    ffi.Pointer<ffi.Pointer<zd_sample_ring_t>> ring_out,
+  ) {
+    return _zd_declare_ring_subscriber(
+      session,
+      subscriber,
+      keyexpr,
+      dart_port,
+      capacity,
+      ring_out,
+    );
+  }
+
+  late final _zd_declare_ring_subscriberPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Int64,
+            ffi.Size,
+            ffi.Pointer<ffi.Pointer<zd_sample_ring_t>>,
+          )
+        >
+      >('zd_declare_ring_subscriber');
+  late final _zd_declare_ring_subscriber = _zd_declare_ring_subscriberPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<ffi.Opaque>,
+          ffi.Pointer<ffi.Opaque>,
+          int,
+          int,
+          ffi.Pointer<ffi.Pointer<zd_sample_ring_t>>,
+        )
+      >();
+
+  /// Returns the ring's data buffer of zd_sample_ring_capacity() bytes.
+  ///
+  /// @param ring  The ring returned by zd_declare_ring_subscriber().
+  /// @return Pointer to the frame data.
+  ffi.Pointer<ffi.Uint8> zd_sample_ring_data(
+    ffi.Pointer<zd_sample_ring_t> ring,
+  ) {
+    return _zd_sample_ring_data(ring);
+  }
+
+  late final _zd_sample_ring_dataPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<zd_sample_ring_t>)
+        >
+      >('zd_sample_ring_data');
+  late final _zd_sample_ring_data = _zd_sample_ring_dataPtr
+      .asFunction<
+        ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<zd_sample_ring_t>)
+      >();
+
+  /// Returns the ring's capacity in bytes (a power of two).
+  ///
+  /// @param ring  The ring returned by zd_declare_ring_subscriber().
+  /// @return The capacity in bytes.
+  int zd_sample_ring_capacity(ffi.Pointer<zd_sample_ring_t> ring) {
+    return _zd_sample_ring_capacity(ring);
+  }
+
+  late final _zd_sample_ring_capacityPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Size Function(ffi.Pointer<zd_sample_ring_t>)>
+      >('zd_sample_ring_capacity');
+  late final _zd_sample_ring_capacity = _zd_sample_ring_capacityPtr
+      .asFunction<int Function(ffi.Pointer<zd_sample_ring_t>)>();
+
+  /// Returns the producer position; frames before it are ready to read.
+  ///
+  /// @param ring  The ring returned by zd_declare_ring_subscriber().
+  /// @return The head position (monotonic, mask with capacity - 1).
+  int zd_sample_ring_acquire(ffi.Pointer<zd_sample_ring_t> ring) {
+    return _zd_sample_ring_acquire(ring);
+  }
+
+  late final _zd_sample_ring_acquirePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Uint64 Function(ffi.Pointer<zd_sample_ring_t>)>
+      >('zd_sample_ring_acquire');
+  late final _zd_sample_ring_acquire = _zd_sample_ring_acquirePtr
+      .asFunction<int Function(ffi.Pointer<zd_sample_ring_t>)>();
+
+  /// Returns consumed space to the producer and arms the doorbell.
+  ///
+  /// @param ring  The ring returned by zd_declare_ring_subscriber().
+  /// @param tail  Position just past the last frame read.
+  /// @return true if more frames arrived and the caller should keep
+  /// reading; false if the ring is empty or a doorbell is pending.
+  bool zd_sample_ring_release(ffi.Pointer<zd_sample_ring_t> ring, int tail) {
+    return _zd_sample_ring_release(ring, tail);
+  }
+
+  late final _zd_sample_ring_releasePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<zd_sample_ring_t>, ffi.Uint64)
+        >
+      >('zd_sample_ring_release');
+  late final _zd_sample_ring_release = _zd_sample_ring_releasePtr
+      .asFunction<bool Function(ffi.Pointer<zd_sample_ring_t>, int)>();
+
+  /// Returns the number of samples dropped because the ring was full.
+  ///
+  /// @param ring  The ring returned by zd_declare_ring_subscriber().
+  /// @return The dropped sample count.
+  int zd_sample_ring_dropped(ffi.Pointer<zd_sample_ring_t> ring) {
+    return _zd_sample_ring_dropped(ring);
+  }
+
+  late final _zd_sample_ring_droppedPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Uint64 Function(ffi.Pointer<zd_sample_ring_t>)>
+      >('zd_sample_ring_dropped');
+  late final _zd_sample_ring_dropped = _zd_sample_ring_droppedPtr
+      .asFunction<int Function(ffi.Pointer<zd_sample_ring_t>)>();
+
+  /// Declares a subscriber that keeps only the newest sample per key.
+  ///
+  /// Each sample replaces the one held for its key expression. A doorbell
+  /// (an int64) is posted to `dart_port` when a key is updated while no
+  /// doorbell is outstanding; Dart then collects every updated key with
+  /// zd_conflation_take(), which re-arms the doorbell. Memory and Dart work
+  /// are bounded by the number of distinct keys, not the sample rate.
+  ///
+  /// The map is freed when the subscriber is dropped.
   ///
-  /// @param subscriber_out  Pointer to an uninitialized z_owned_subscriber_t (as uint8_t*).
-  /// @param handler_out     Pointer to an uninitialized z_owned_ring_handler_sample_t (as uint8_t*).
-  /// @param session         Const pointer to a loaned session (as uint8_t*).
-  /// @param key_expr        Null-terminated key expression string.
-  /// @param capacity        Ring buffer capacity.
+  /// @param session         Const pointer to a loaned session.
+  /// @param subscriber      Pointer to an uninitialized z_owned_subscriber_t.
+  /// @param keyexpr         Const pointer to a loaned key expression.
+  /// @param dart_port       The Dart native port to post doorbells to.
+  /// @param conflation_out  Receives the map on success.
   /// @return 0 on success, negative on failure.
-  int zd_declare_pull_subscriber(
-    ffi.Pointer<ffi.Uint8> subscriber_out,
-    ffi.Pointer<ffi.Uint8> handler_out,
-    ffi.Pointer<ffi.Uint8> session,
-    ffi.Pointer<ffi.Char> key_expr,
-    int capacity,
+  int zd_declare_conflating_subscriber(
+    ffi.Pointer<ffi.Opaque> session,
+    ffi.Pointer<ffi.Opaque> subscriber,
+    ffi.Pointer<ffi.Opaque> keyexpr,
+    int dart_port,
+    ffi.Pointer<ffi.Pointer<zd_conflation_t>> conflation_out,
   ) {
-    return _zd_declare_pull_subscriber(
-      subscriber_out,
-      handler_out,
+    return _zd_declare_conflating_subscriber(
       session,
-      key_expr,
-      capacity,
+      subscriber,
+      keyexpr,
+      dart_port,
+      conflation_out,
     );
   }
 
-  late final _zd_declare_pull_subscriberPtr =
+  late final _zd_declare_conflating_subscriberPtr =
       _lookup<
         ffi.NativeFunction<
-          ffi.Int8 Function(
-            ffi.Pointer<ffi.Uint8>,
-            ffi.Pointer<ffi.Uint8>,
-            ffi.Pointer<ffi.Uint8>,
-            ffi.Pointer<ffi.Char>,
-            ffi.Int32,
+          ffi.Int Function(
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Int64,
+            ffi.Pointer<ffi.Pointer<zd_conflation_t>>,
           )
         >
-      >('zd_declare_pull_subscriber');
-  late final _zd_declare_pull_subscriber = _zd_declare_pull_subscriberPtr
-      .asFunction<
-        int Function(
-          ffi.Pointer<ffi.Uint8>,
-          ffi.Pointer<ffi.Uint8>,
-          ffi.Pointer<ffi.Uint8>,
-          ffi.Pointer<ffi.Char>,
-          int,
-        )
-      >();
+      >('zd_declare_conflating_subscriber');
+  late final _zd_declare_conflating_subscriber =
+      _zd_declare_conflating_subscriberPtr
+          .asFunction<
+            int Function(
+              ffi.Pointer<ffi.Opaque>,
+              ffi.Pointer<ffi.Opaque>,
+              ffi.Pointer<ffi.Opaque>,
+              int,
+              ffi.Pointer<ffi.Pointer<zd_conflation_t>>,
+            )
+          >();
 
-  /// Tries to receive a sample from the ring handler.
+  /// Removes the newest sample of every key updated since the last call and
+  /// re-arms the doorbell.
   ///
-  /// Return codes: 0=sample available, 1=channel disconnected, 2=buffer empty.
-  /// When 0, all out_ parameters are populated (malloc'd; caller must free).
+  /// The samples are returned as frames laid out like zd_sample_ring_t
+  /// frames: an 8-byte prefix whose first uint32 is the frame length, then
+  /// the sample in the flat wire format, padded to 8 bytes. Keys appear in
+  /// the order they were first updated.
   ///
-  /// @param handler           Const pointer to an owned ring handler (as uint8_t*).
-  /// @param out_keyexpr       Out: malloc'd null-terminated key expression string.
-  /// @param out_payload       Out: malloc'd payload bytes.
-  /// @param out_payload_len   Out: payload length.
-  /// @param out_kind          Out: sample kind (0=put, 1=delete).
-  /// @param out_encoding      Out: malloc'd null-terminated encoding string (or NULL).
-  /// @param out_attachment     Out: malloc'd attachment bytes (or NULL).
-  /// @param out_attachment_len Out: attachment length.
-  /// @return 0=sample, 1=disconnected, 2=empty.
-  int zd_pull_subscriber_try_recv(
-    ffi.Pointer<ffi.Uint8> handler,
-    ffi.Pointer<ffi.Pointer<ffi.Char>> out_keyexpr,
-    ffi.Pointer<ffi.Pointer<ffi.Uint8>> out_payload,
-    ffi.Pointer<ffi.Int32> out_payload_len,
-    ffi.Pointer<ffi.Int8> out_kind,
-    ffi.Pointer<ffi.Pointer<ffi.Char>> out_encoding,
-    ffi.Pointer<ffi.Pointer<ffi.Uint8>> out_attachment,
-    ffi.Pointer<ffi.Int32> out_attachment_len,
+  /// @param conflation  The map returned by zd_declare_conflating_subscriber().
+  /// @param len_out     Receives the total length of the frames in bytes.
+  /// @return Malloc'd frames the caller must free, or NULL if no key was
+  ///         updated or on allocation failure.
+  ffi.Pointer<ffi.Uint8> zd_conflation_take(
+    ffi.Pointer<zd_conflation_t> conflation,
+    ffi.Pointer<ffi.Size> len_out,
   ) {
-    return _zd_pull_subscriber_try_recv(
-      handler,
-      out_keyexpr,
-      out_payload,
-      out_payload_len,
-      out_kind,
-      out_encoding,
-      out_attachment,
-      out_attachment_len,
-    );
+    return _zd_conflation_take(conflation, len_out);
   }
 
-  late final _zd_pull_subscriber_try_recvPtr =
+  late final _zd_conflation_takePtr =
       _lookup<
         ffi.NativeFunction<
-          ffi.Int8 Function(
-            ffi.Pointer<ffi.Uint8>,
-            ffi.Pointer<ffi.Pointer<ffi.Char>>,
-            ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
-            ffi.Pointer<ffi.Int32>,
-            ffi.Pointer<ffi.Int8>,
-            ffi.Pointer<ffi.Pointer<ffi.Char>>,
-            ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
-            ffi.Pointer<ffi.Int32>,
+          ffi.Pointer<ffi.Uint8> Function(
+            ffi.Pointer<zd_conflation_t>,
+            ffi.Pointer<ffi.Size>,
           )
         >
-      >('zd_pull_subscriber_try_recv');
-  late final _zd_pull_subscriber_try_recv = _zd_pull_subscriber_try_recvPtr
+      >('zd_conflation_take');
+  late final _zd_conflation_take = _zd_conflation_takePtr
       .asFunction<
-        int Function(
-          ffi.Pointer<ffi.Uint8>,
-          ffi.Pointer<ffi.Pointer<ffi.Char>>,
-          ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
-          ffi.Pointer<ffi.Int32>,
-          ffi.Pointer<ffi.Int8>,
-          ffi.Pointer<ffi.Pointer<ffi.Char>>,
-          ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
-          ffi.Pointer<ffi.Int32>,
+        ffi.Pointer<ffi.Uint8> Function(
+          ffi.Pointer<zd_conflation_t>,
+          ffi.Pointer<ffi.Size>,
         )
       >();
 
-  /// Drops (frees) the ring handler.
+  /// Returns the number of samples replaced by a newer one before Dart
+  /// took them.
   ///
-  /// @param handler  Pointer to a z_owned_ring_handler_sample_t (as uint8_t*).
-  void zd_ring_handler_sample_drop(ffi.Pointer<ffi.Uint8> handler) {
-    return _zd_ring_handler_sample_drop(handler);
+  /// @param conflation  The map returned by zd_declare_conflating_subscriber().
+  /// @return The conflated sample count.
+  int zd_conflation_conflated(ffi.Pointer<zd_conflation_t> conflation) {
+    return _zd_conflation_conflated(conflation);
   }
 
-  late final _zd_ring_handler_sample_dropPtr =
-      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Uint8>)>>(
-        'zd_ring_handler_sample_drop',
-      );
-  late final _zd_ring_handler_sample_drop = _zd_ring_handler_sample_dropPtr
-      .asFunction<void Function(ffi.Pointer<ffi.Uint8>)>();
+  late final _zd_conflation_conflatedPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Uint64 Function(ffi.Pointer<zd_conflation_t>)>
+      >('zd_conflation_conflated');
+  late final _zd_conflation_conflated = _zd_conflation_conflatedPtr
+      .asFunction<int Function(ffi.Pointer<zd_conflation_t>)>();
+
+  /// Initializes aggregator options to their defaults (raw float64
+  /// payloads, 1 s tumbling windows).
+  ///
+  /// @param options  Pointer to the options struct to initialize.
+  void zd_aggregator_options_default(
+    ffi.Pointer<zd_aggregator_options_t> options,
+  ) {
+    return _zd_aggregator_options_default(options);
+  }
+
+  late final _zd_aggregator_options_defaultPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<zd_aggregator_options_t>)
+        >
+      >('zd_aggregator_options_default');
+  late final _zd_aggregator_options_default = _zd_aggregator_options_defaultPtr
+      .asFunction<void Function(ffi.Pointer<zd_aggregator_options_t>)>();
+
+  /// Declares a subscriber that aggregates numeric payloads per key.
+  ///
+  /// Payloads are decoded in the zenoh callback and folded into per-key
+  /// count, min, max and sum accumulators; nothing is posted per sample.
+  /// Every `step_us` a native timer closes the window ending at that
+  /// moment and posts one message for all keys that received samples in
+  /// it: [window_end_us(int64), records(array)], where each record is
+  /// [keyexpr(string), count(int64), min, max, mean(double)] and min and
+  /// max are doubles or int64s according to `value_type`. Windows are
+  /// measured on arrival time; window_end_us is the wall-clock time of
+  /// the close in microseconds since the epoch.
+  ///
+  /// @param session     Const pointer to a loaned session.
+  /// @param subscriber  Pointer to an uninitialized z_owned_subscriber_t.
+  /// @param keyexpr     Const pointer to a loaned key expression.
+  /// @param dart_port   The Dart native port to post aggregates to.
+  /// @param options     Aggregation options (NULL = defaults).
+  /// @return 0 on success, negative on failure.
+  int zd_declare_aggregating_subscriber(
+    ffi.Pointer<ffi.Opaque> session,
+    ffi.Pointer<ffi.Opaque> subscriber,
+    ffi.Pointer<ffi.Opaque> keyexpr,
+    int dart_port,
+    ffi.Pointer<zd_aggregator_options_t> options,
+  ) {
+    return _zd_declare_aggregating_subscriber(
+      session,
+      subscriber,
+      keyexpr,
+      dart_port,
+      options,
+    );
+  }
+
+  late final _zd_declare_aggregating_subscriberPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Pointer<ffi.Opaque>,
+            ffi.Int64,
+            ffi.Pointer<zd_aggregator_options_t>,
+          )
+        >
+      >('zd_declare_aggregating_subscriber');
+  late final _zd_declare_aggregating_subscriber =
+      _zd_declare_aggregating_subscriberPtr
+          .asFunction<
+            int Function(
+              ffi.Pointer<ffi.Opaque>,
+              ffi.Pointer<ffi.Opaque>,
+              ffi.Pointer<ffi.Opaque>,
+              int,
+              ffi.Pointer<zd_aggregator_options_t>,
+            )
+          >();
 
   /// Returns the size of z_owned_querier_t in bytes.
   int zd_querier_sizeof() {
@@ -4571,3 +5907,375 @@ final class z_moved_subscriber_t extends ffi.Struct {
 final class z_moved_task_t extends ffi.Struct {
   external z_owned_task_t _this;
 }
+
+/// A fixed set of equally sized native buffers that can be filled in place
+/// and published without copying.
+///
+/// A buffer wrapped with zd_bytes_from_pool_buffer() returns to the pool
+/// when zenoh drops its last reference to the bytes, typically once the
+/// transport has written it out.
+final class zd_buffer_pool_t extends ffi.Opaque {}
+
+/// Header of a sample in the flat wire format.
+///
+/// A flat sample is one Uint8List laid out as this header (native byte
+/// order), a zd_sample_metadata_t when ZD_SAMPLE_WIRE_METADATA is set,
+/// the key expression and encoding strings (UTF-8, not null-terminated),
+/// the attachment bytes, zero padding up to `payload_offset` (a multiple
+/// of 8) and the payload bytes.
+final class zd_sample_wire_header_t extends ffi.Struct {
+  /// Sample kind (0 = put, 1 = delete).
+  @ffi.Uint8()
+  external int kind;
+
+  /// Bit set of ZD_SAMPLE_WIRE_* flags.
+  @ffi.Uint8()
+  external int flags;
+
+  /// Cached encoding id when ZD_SAMPLE_WIRE_ENCODING_ID is set.
+  @ffi.Uint16()
+  external int encoding_id;
+
+  @ffi.Uint32()
+  external int key_len;
+
+  @ffi.Uint32()
+  external int encoding_len;
+
+  @ffi.Uint32()
+  external int attachment_len;
+
+  /// Offset of the payload from the start of the buffer.
+  @ffi.Uint32()
+  external int payload_offset;
+
+  @ffi.Uint32()
+  external int payload_len;
+}
+
+/// Timestamp, source and QoS of a sample, packed in native byte order.
+///
+/// Posted as a Uint8List by subscribers that request
+/// ZD_SAMPLE_FIELD_METADATA, and filled by zd_sample_metadata() for lazily
+/// delivered samples.
+final class zd_sample_metadata_t extends ffi.Struct {
+  /// NTP64 time, valid when ZD_SAMPLE_META_HAS_TIMESTAMP is set.
+  @ffi.Uint64()
+  external int timestamp;
+
+  /// Zenoh id of the runtime that created the timestamp.
+  @ffi.Array.multi([16])
+  external ffi.Array<ffi.Uint8> timestamp_id;
+
+  /// Zenoh id of the publishing session, valid when
+  /// ZD_SAMPLE_META_HAS_SOURCE is set.
+  @ffi.Array.multi([16])
+  external ffi.Array<ffi.Uint8> source_zid;
+
+  /// Entity id of the publisher within its session.
+  @ffi.Uint32()
+  external int source_eid;
+
+  /// Sequence number of the sample within its publisher.
+  @ffi.Uint32()
+  external int source_sn;
+
+  /// z_priority_t value (1-7).
+  @ffi.Uint8()
+  external int priority;
+
+  /// z_congestion_control_t value (0 = block, 1 = drop).
+  @ffi.Uint8()
+  external int congestion_control;
+
+  /// Bit set of ZD_SAMPLE_META_* flags.
+  @ffi.Uint8()
+  external int flags;
+
+  @ffi.Array.multi([5])
+  external ffi.Array<ffi.Uint8> reserved;
+}
+
+/// Bounds the number of samples a subscriber has handed to Dart that Dart
+/// has not acknowledged with zd_flow_control_ack().
+///
+/// Created with zd_flow_control_new() and passed through
+/// zd_subscriber_options_t, and may be used by one subscriber only. The
+/// subscriber holds a reference until its drop callback has run, so the
+/// caller may free its own reference as soon as the subscriber is dropped.
+final class zd_flow_control_t extends ffi.Opaque {}
+
+/// Counters a subscriber updates as it processes samples.
+///
+/// Created with zd_subscriber_stats_new() and passed through
+/// zd_subscriber_options_t. Every subscriber counting into it holds a
+/// reference until its drop callback has run, so the caller may free its
+/// own reference as soon as the subscriber is dropped. Fields are updated
+/// atomically from zenoh threads.
+final class zd_subscriber_stats_t extends ffi.Struct {
+  /// Samples dropped by the native filters.
+  @ffi.Uint64()
+  external int filtered;
+
+  /// Samples dropped or replaced by the per-key rate limit.
+  @ffi.Uint64()
+  external int rate_limited;
+
+  /// Samples an aggregating subscriber could not decode as a number.
+  @ffi.Uint64()
+  external int undecodable;
+}
+
+/// Options controlling how a subscriber delivers samples to Dart.
+///
+/// Initialize with zd_subscriber_options_default() before setting fields.
+final class zd_subscriber_options_t extends ffi.Struct {
+  /// Deliver payload and attachment without copying them.
+  ///
+  /// The bytes are cloned (a reference count bump) and posted as external
+  /// typed data whose finalizer drops the clone, so contiguous payloads
+  /// reach Dart with no memcpy. Fragmented payloads are read once into a
+  /// buffer adopted by Dart.
+  @ffi.Bool()
+  external bool zero_copy;
+
+  /// Post each sample as a single buffer in the flat wire format (see
+  /// zd_sample_wire_header_t) instead of an array of separate objects.
+  /// Takes precedence over `zero_copy`.
+  @ffi.Bool()
+  external bool flat;
+
+  /// Post only a cloned sample handle with its key expression and kind as
+  /// a [sample_ptr(int64), keyexpr(string), kind(int64)] message; the other
+  /// fields are read on demand with the zd_sample_* accessors and the
+  /// handle is released with zd_sample_drop(). Takes precedence over `flat`
+  /// and `zero_copy`, and disables the encoding cache.
+  @ffi.Bool()
+  external bool lazy;
+
+  /// Bit set of ZD_SAMPLE_FIELD_* values to extract and post.
+  ///
+  /// Fields left out are never converted: a missing payload is posted as
+  /// its length (int64) in place of the bytes, and a missing attachment or
+  /// encoding as null. Requested metadata is appended to the sample array
+  /// as a sixth element (Uint8List). Ignored by lazy subscribers.
+  @ffi.Uint32()
+  external int fields;
+
+  /// Intern up to this many distinct key expressions (0 = disabled).
+  ///
+  /// The first sample on a key is preceded by a [0, id(int64),
+  /// keyexpr(string)] definition message; the sample and every later one
+  /// carry the id (int64) in place of the key string. Keys seen after the
+  /// table is full are sent as strings.
+  @ffi.Uint32()
+  external int intern_max_keys;
+
+  /// Cache up to this many distinct encodings (0 = disabled).
+  ///
+  /// Encodings are compared with z_encoding_equals instead of being
+  /// formatted for every sample. A new encoding is announced with a [1,
+  /// id(int64), encoding(string)] definition message and samples carry
+  /// its id (int64) in the encoding slot. Encodings seen after the cache is
+  /// full are sent as strings.
+  @ffi.Uint32()
+  external int encoding_cache_size;
+
+  /// Maximum samples per batched post (0 or 1 = post each sample).
+  ///
+  /// When greater than 1, samples are buffered natively and posted as one
+  /// `Dart_CObject` array of sample arrays when this count, the byte limit
+  /// or the deadline is reached.
+  @ffi.Uint32()
+  external int batch_max_samples;
+
+  /// Flush once buffered key, payload and attachment bytes reach this
+  /// size (0 = no byte limit).
+  @ffi.Size()
+  external int batch_max_bytes;
+
+  /// Flush a partial batch this many microseconds after its first sample
+  /// was buffered.
+  @ffi.Uint32()
+  external int batch_max_delay_us;
+
+  /// Drop samples whose payload is shorter than this many bytes.
+  @ffi.Size()
+  external int filter_min_payload_len;
+
+  /// Drop samples whose payload is longer than this many bytes
+  /// (SIZE_MAX = no limit).
+  @ffi.Size()
+  external int filter_max_payload_len;
+
+  /// Deliver only samples of this kind (-1 = any, 0 = put, 1 = delete).
+  @ffi.Int8()
+  external int filter_kind;
+
+  /// Deliver only samples whose payload starts with these bytes (NULL =
+  /// no constraint). Copied at declaration.
+  external ffi.Pointer<ffi.Uint8> filter_payload_prefix;
+
+  @ffi.Size()
+  external int filter_payload_prefix_len;
+
+  /// Deliver only samples with an attachment starting with these bytes
+  /// (NULL = no constraint). Copied at declaration.
+  external ffi.Pointer<ffi.Uint8> filter_attachment_prefix;
+
+  @ffi.Size()
+  external int filter_attachment_prefix_len;
+
+  /// Drop samples whose key expression intersects any of these key
+  /// expressions. Parsed at declaration; an invalid one fails it.
+  external ffi.Pointer<ffi.Pointer<ffi.Char>> filter_exclude_keyexprs;
+
+  @ffi.Size()
+  external int filter_exclude_keyexprs_len;
+
+  /// Deliver at most one sample per key expression every this many
+  /// microseconds (0 = no rate limit).
+  ///
+  /// Limiter state is kept per distinct key expression seen, so the limit
+  /// applies to each key of a wildcard subscription independently.
+  @ffi.Uint32()
+  external int rate_limit_interval_us;
+
+  /// ZD_RATE_LIMIT_* policy for samples arriving within the interval.
+  @ffi.Uint8()
+  external int rate_limit_mode;
+
+  /// Maximum number of key expressions with limiter state (0 =
+  /// unbounded). A new key beyond it evicts idle state, preferring keys
+  /// whose interval has elapsed; if every key holds a sample, the new key
+  /// is delivered unlimited.
+  @ffi.Uint32()
+  external int rate_limit_max_keys;
+
+  /// Counters from zd_subscriber_stats_new() (NULL = not counted).
+  /// Samples rejected by the filters above are dropped in the zenoh
+  /// callback and counted in `filtered`; samples dropped by the rate limit
+  /// in `rate_limited`.
+  external ffi.Pointer<zd_subscriber_stats_t> stats;
+
+  /// In-flight limit and overflow policy (NULL = unbounded). Every sample
+  /// posted or batched counts as in flight until acknowledged.
+  external ffi.Pointer<zd_flow_control_t> flow_control;
+}
+
+/// Tracks sample arrivals into a pull subscriber's channel so that receivers
+/// can block or be woken instead of polling.
+///
+/// Created by zd_declare_pull_subscriber() and released with
+/// zd_pull_waiter_free(); it stays valid after the subscriber is dropped.
+final class zd_pull_waiter_t extends ffi.Opaque {}
+
+/// A reusable receive descriptor filled in place by
+/// zd_pull_subscriber_try_recv_into().
+///
+/// Allocate it zeroed and keep it across calls: the key expression,
+/// encoding and attachment are written to scratch buffers owned by the
+/// descriptor, which only grow when a sample needs more room, and a payload
+/// of up to ZD_PULL_RECV_INLINE_SIZE bytes is written to `inline_payload`.
+/// Steady-state polling of small samples therefore does no heap
+/// allocation. Release the scratch buffers with zd_pull_recv_release().
+final class zd_pull_recv_t extends ffi.Struct {
+  /// Key expression of the last sample (UTF-8, not null-terminated).
+  external ffi.Pointer<ffi.Char> keyexpr;
+
+  @ffi.Size()
+  external int keyexpr_len;
+
+  @ffi.Size()
+  external int keyexpr_cap;
+
+  /// Encoding of the last sample (UTF-8, not null-terminated).
+  external ffi.Pointer<ffi.Char> encoding;
+
+  @ffi.Size()
+  external int encoding_len;
+
+  @ffi.Size()
+  external int encoding_cap;
+
+  /// Attachment of the last sample, valid when `has_attachment` is set.
+  external ffi.Pointer<ffi.Uint8> attachment;
+
+  @ffi.Size()
+  external int attachment_len;
+
+  @ffi.Size()
+  external int attachment_cap;
+
+  /// Payload of the last sample: `inline_payload`, or a malloc'd buffer
+  /// the caller takes ownership of when `payload_owned` is set.
+  external ffi.Pointer<ffi.Uint8> payload;
+
+  @ffi.Size()
+  external int payload_len;
+
+  /// Private: the last encoding, compared to skip reformatting it.
+  external ffi.Pointer<ffi.Void> last_encoding;
+
+  /// Set when the key expression differs from the previous sample's.
+  @ffi.Bool()
+  external bool keyexpr_changed;
+
+  /// Set when the encoding differs from the previous sample's.
+  @ffi.Bool()
+  external bool encoding_changed;
+
+  @ffi.Bool()
+  external bool has_attachment;
+
+  @ffi.Bool()
+  external bool payload_owned;
+
+  /// Sample kind (0 = put, 1 = delete).
+  @ffi.Int8()
+  external int kind;
+
+  @ffi.Array.multi([256])
+  external ffi.Array<ffi.Uint8> inline_payload;
+}
+
+/// Single-producer/single-consumer sample ring shared between a ring
+/// subscriber's zenoh callback and a Dart isolate.
+///
+/// The ring data is a sequence of frames, each an 8-byte prefix whose
+/// first uint32 is the frame length, followed by one sample in the flat
+/// wire format (see zd_sample_wire_header_t) padded to 8 bytes. A zero
+/// length marks the unused end of the buffer; reading resumes at offset 0.
+final class zd_sample_ring_t extends ffi.Opaque {}
+
+/// Latest-sample-per-key map shared between a conflating subscriber's
+/// zenoh callback and a Dart isolate.
+final class zd_conflation_t extends ffi.Opaque {}
+
+/// Options for an aggregating subscriber.
+///
+/// Initialize with zd_aggregator_options_default() before setting fields.
+final class zd_aggregator_options_t extends ffi.Struct {
+  /// ZD_AGGREGATE_* type of every payload.
+  @ffi.Uint8()
+  external int value_type;
+
+  /// Decode payloads with ze_deserializer instead of as 8 raw
+  /// little-endian bytes.
+  @ffi.Bool()
+  external bool serialized;
+
+  /// Window length in microseconds.
+  @ffi.Uint64()
+  external int window_us;
+
+  /// Interval between window closes in microseconds; equal to
+  /// `window_us` for tumbling windows, smaller for sliding ones. Must
+  /// divide `window_us`.
+  @ffi.Uint64()
+  external int step_us;
+
+  /// Counters from zd_subscriber_stats_new() (NULL = not counted).
+  /// Payloads that fail to decode are counted in `undecodable`.
+  external ffi.Pointer<zd_subscriber_stats_t> stats;
+}
@@ -0,0 +1,155 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import 'bindings.dart' show zd_buffer_pool_t;
+import 'bytes.dart';
+import 'exceptions.dart';
+import 'native_lib.dart';
+
+/// A pool of equally sized native buffers for zero-copy publishing.
+///
+/// Acquire a [PooledBuffer], fill its [PooledBuffer.data] in place and
+/// turn it into a [ZBytes] with [PooledBuffer.toBytes]; zenoh then sends
+/// the buffer without copying it. The buffer returns to the pool when
+/// zenoh drops its last reference to the payload, typically once the
+/// transport has written it out.
+///
+/// Call [close] when done. Buffers still held by zenoh stay valid until
+/// it releases them.
+class BufferPool {
+  final Pointer<zd_buffer_pool_t> _ptr;
+  bool _closed = false;
+
+  /// The size of each buffer in bytes.
+  final int bufferSize;
+
+  /// The number of buffers in the pool.
+  final int count;
+
+  /// Creates a pool of [count] buffers of [bufferSize] bytes each.
+  ///
+  /// Throws [ArgumentError] if either value is not positive.
+  /// Throws [ZenohException] if the pool cannot be allocated.
+  BufferPool({required this.bufferSize, required this.count})
+    : _ptr = _create(bufferSize, count);
+
+  static Pointer<zd_buffer_pool_t> _create(int bufferSize, int count) {
+    if (bufferSize < 1) {
+      throw ArgumentError.value(bufferSize, 'bufferSize', 'must be positive');
+    }
+    if (count < 1) {
+      throw ArgumentError.value(count, 'count', 'must be positive');
+    }
+    final ptr = bindings.zd_buffer_pool_new(bufferSize, count);
+    if (ptr == nullptr) {
+      throw ZenohException('Failed to create buffer pool', -1);
+    }
+    return ptr;
+  }
+
+  void _ensureOpen() {
+    if (_closed) throw StateError('BufferPool has been closed');
+  }
+
+  /// The number of buffers that [acquire] can take right now.
+  ///
+  /// Throws [StateError] if the pool has been closed.
+  int get available {
+    _ensureOpen();
+    return bindings.zd_buffer_pool_available(_ptr);
+  }
+
+  /// Takes a free buffer from the pool.
+  ///
+  /// Returns null if every buffer is acquired or still held by zenoh.
+  ///
+  /// Throws [StateError] if the pool has been closed.
+  PooledBuffer? acquire() {
+    _ensureOpen();
+    final data = bindings.zd_buffer_pool_acquire(_ptr);
+    if (data == nullptr) return null;
+    return PooledBuffer._(this, data);
+  }
+
+  /// Releases the pool.
+  ///
+  /// Buffers acquired but not yet passed to [PooledBuffer.toBytes] must not
+  /// be used afterwards. Safe to call multiple times -- subsequent calls
+  /// are no-ops.
+  void close() {
+    if (_closed) return;
+    _closed = true;
+    bindings.zd_buffer_pool_free(_ptr);
+  }
+}
+
+/// A buffer acquired from a [BufferPool].
+///
+/// Either pass it to zenoh with [toBytes] or give it back with [release].
+class PooledBuffer {
+  final BufferPool _pool;
+  final Pointer<Uint8> _data;
+  bool _done = false;
+
+  PooledBuffer._(this._pool, this._data);
+
+  void _ensureUsable() {
+    if (_done) throw StateError('PooledBuffer has been released');
+    _pool._ensureOpen();
+  }
+
+  /// A writable view of the whole buffer, [BufferPool.bufferSize] bytes
+  /// long.
+  ///
+  /// The view aliases native memory: it must not be used after [toBytes]
+  /// or [release].
+  ///
+  /// Throws [StateError] if the buffer has been released.
+  Uint8List get data {
+    _ensureUsable();
+    return _data.asTypedList(_pool.bufferSize);
+  }
+
+  /// Converts the first [length] bytes of this buffer into a [ZBytes]
+  /// without copying. [length] defaults to the whole buffer.
+  ///
+  /// The buffer then belongs to the returned payload and returns to the
+  /// pool once zenoh drops it. The caller owns the [ZBytes] and must
+  /// publish or [ZBytes.dispose] it.
+  ///
+  /// Throws [StateError] if the buffer has been released.
+  /// Throws [RangeError] if [length] exceeds the buffer size.
+  /// Throws [ZenohException] if the conversion fails.
+  ZBytes toBytes([int? length]) {
+    _ensureUsable();
+    final len = length ?? _pool.bufferSize;
+    RangeError.checkValueInInterval(len, 0, _pool.bufferSize, 'length');
+    final Pointer<Void> bytesPtr = calloc.allocate(bindings.zd_bytes_sizeof());
+    final rc = bindings.zd_bytes_from_pool_buffer(
+      bytesPtr.cast(),
+      _pool._ptr,
+      _data,
+      len,
+    );
+    // The buffer belongs to the bytes from here on, even on failure.
+    _done = true;
+    if (rc != 0) {
+      calloc.free(bytesPtr);
+      throw ZenohException('Failed to convert PooledBuffer to ZBytes', rc);
+    }
+    return ZBytes.fromNative(bytesPtr);
+  }
+
+  /// Returns this buffer to the pool without publishing it.
+  ///
+  /// Safe to call multiple times -- subsequent calls are no-ops, as is a
+  /// call after [toBytes].
+  void release() {
+    if (_done) return;
+    _done = true;
+    if (_pool._closed) return;
+    bindings.zd_buffer_pool_release(_pool._ptr, _data);
+  }
+}
@@ -24,7 +24,8 @@ class ZBytes {
 
   /// Creates [ZBytes] wrapping an existing native z_owned_bytes_t pointer.
   ///
-  /// Used internally by [ShmMutBuffer.toBytes] for zero-copy conversion.
+  /// Used internally by [ShmMutBuffer.toBytes] and [PooledBuffer.toBytes]
+  /// for zero-copy conversion.
   ZBytes.fromNative(this._ptr);
 
   /// Creates [ZBytes] by copying the given [value] string.
@@ -47,25 +48,26 @@ class ZBytes {
 
   /// Creates [ZBytes] by copying the given [data] buffer.
   ///
-  /// Throws [ZenohException] if the native copy fails.
+  /// The data is copied once, into a native buffer that zenoh then adopts.
+  /// To publish without any copy, fill a [PooledBuffer] instead.
+  ///
+  /// Throws [ZenohException] if the native conversion fails.
   factory ZBytes.fromUint8List(Uint8List data) {
     final Pointer<Void> ptr = calloc.allocate(bindings.zd_bytes_sizeof());
-    final Pointer<Uint8> nativeBuf = calloc<Uint8>(data.length);
-    for (var i = 0; i < data.length; i++) {
-      nativeBuf[i] = data[i];
+    Pointer<Uint8> nativeBuf = nullptr;
+    if (data.isNotEmpty) {
+      nativeBuf = malloc<Uint8>(data.length);
+      nativeBuf.asTypedList(data.length).setAll(0, data);
     }
-    try {
-      final rc = bindings.zd_bytes_copy_from_buf(
-        ptr.cast(),
-        nativeBuf,
-        data.length,
-      );
-      if (rc != 0) {
-        calloc.free(ptr);
-        throw ZenohException('Failed to create ZBytes from buffer', rc);
-      }
-    } finally {
-      calloc.free(nativeBuf);
+    // The native buffer belongs to the bytes from here on, even on failure.
+    final rc = bindings.zd_bytes_from_malloc(
+      ptr.cast(),
+      nativeBuf,
+      data.length,
+    );
+    if (rc != 0) {
+      calloc.free(ptr);
+      throw ZenohException('Failed to create ZBytes from buffer', rc);
     }
     return ZBytes._(ptr);
   }
@@ -0,0 +1,136 @@
+import 'dart:async';
+import 'dart:ffi';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import 'bindings.dart';
+import 'exceptions.dart';
+import 'native_lib.dart';
+import 'sample.dart';
+
+/// A zenoh subscriber that delivers only the newest sample per key.
+///
+/// The zenoh callback stores each sample in a native map keyed by key
+/// expression, overwriting any sample this isolate has not taken yet. A
+/// native port message (the doorbell) is posted only when the map goes
+/// from fully taken to updated, and each doorbell delivers every updated
+/// key at once. Under bursts, Dart work and native memory are bounded by
+/// the number of distinct keys rather than the message rate.
+///
+/// Suited to state-type topics where intermediate values are irrelevant.
+/// Call [close] when done to undeclare the subscriber and release native
+/// resources.
+class ConflatingSubscriber {
+  // Frame layout (mirrors zd_conflation_take): an 8-byte prefix holding
+  // the uint32 frame length, then the sample in the flat wire format,
+  // padded to 8 bytes.
+  static const int _frameHeaderSize = 8;
+
+  final Pointer<Void> _ptr;
+  final Pointer<zd_conflation_t> _conflation;
+  final ReceivePort _receivePort;
+  final StreamController<Sample> _controller;
+  bool _closed = false;
+
+  ConflatingSubscriber._(
+    this._ptr,
+    this._conflation,
+    this._receivePort,
+    this._controller,
+  ) {
+    _receivePort.listen((_) => _take());
+  }
+
+  /// Creates a conflating subscriber on the given session and key
+  /// expression.
+  ///
+  /// This is called internally by [Session.declareConflatingSubscriber].
+  static ConflatingSubscriber declare(
+    Pointer<Void> loanedSession,
+    Pointer<Void> loanedKe,
+  ) {
+    final size = bindings.zd_subscriber_sizeof();
+    final Pointer<Void> ptr = calloc.allocate(size);
+    final conflationOut = calloc<Pointer<zd_conflation_t>>();
+    final receivePort = ReceivePort();
+
+    try {
+      final rc = bindings.zd_declare_conflating_subscriber(
+        loanedSession.cast(),
+        ptr.cast(),
+        loanedKe.cast(),
+        receivePort.sendPort.nativePort,
+        conflationOut,
+      );
+
+      if (rc != 0) {
+        receivePort.close();
+        calloc.free(ptr);
+        throw ZenohException('Failed to declare conflating subscriber', rc);
+      }
+
+      return ConflatingSubscriber._(
+        ptr,
+        conflationOut.value,
+        receivePort,
+        StreamController<Sample>(),
+      );
+    } finally {
+      calloc.free(conflationOut);
+    }
+  }
+
+  /// A stream of the newest [Sample] per key expression.
+  Stream<Sample> get stream => _controller.stream;
+
+  /// The number of samples overwritten by a newer sample on the same key
+  /// before they were delivered.
+  ///
+  /// Throws [StateError] if the subscriber has been closed.
+  int get conflatedCount {
+    if (_closed) throw StateError('ConflatingSubscriber is closed');
+    return bindings.zd_conflation_conflated(_conflation);
+  }
+
+  /// Takes every updated key from the native map and adds its sample to
+  /// [stream].
+  void _take() {
+    if (_closed) return;
+    final lenOut = calloc<Size>();
+    try {
+      final frames = bindings.zd_conflation_take(_conflation, lenOut);
+      if (frames == nullptr) return;
+      try {
+        final data = frames.asTypedList(lenOut.value);
+        final view = ByteData.sublistView(data);
+        var offset = 0;
+        while (offset < data.length) {
+          final length = view.getUint32(offset, Endian.host);
+          final start = offset + _frameHeaderSize;
+          // Copy the frame out: the native buffer is freed below.
+          _controller.add(Sample.fromWire(data.sublist(start, start + length)));
+          offset += (_frameHeaderSize + length + 7) & ~7;
+        }
+      } finally {
+        malloc.free(frames);
+      }
+    } finally {
+      calloc.free(lenOut);
+    }
+  }
+
+  /// Undeclares the subscriber and releases native resources.
+  ///
+  /// Samples not yet delivered are discarded. Safe to call multiple
+  /// times -- subsequent calls are no-ops.
+  void close() {
+    if (_closed) return;
+    _closed = true;
+    bindings.zd_subscriber_drop(_ptr.cast());
+    _receivePort.close();
+    _controller.close();
+    calloc.free(_ptr);
+  }
+}
@@ -1,3 +1,10 @@
+import 'dart:ffi';
+
+import 'package:ffi/ffi.dart';
+
+import 'exceptions.dart';
+import 'native_lib.dart';
+
 /// Represents the encoding of a zenoh payload.
 ///
 /// Uses MIME type strings to describe the encoding format.
@@ -21,6 +28,15 @@ class Encoding {
   static const imagePng = Encoding('image/png');
   static const imageJpeg = Encoding('image/jpeg');
 
+  /// Parses this encoding once into a native [CompiledEncoding].
+  ///
+  /// Passing the result wherever a put or reply accepts an [Encoding]
+  /// clones the parsed native encoding instead of marshalling and parsing
+  /// [mimeType] on every call. Call [CompiledEncoding.dispose] when done.
+  ///
+  /// Throws [ZenohException] if the MIME type cannot be parsed.
+  CompiledEncoding compile() => CompiledEncoding._(mimeType);
+
   @override
   String toString() => mimeType;
 
@@ -31,3 +47,49 @@ class Encoding {
   @override
   int get hashCode => mimeType.hashCode;
 }
+
+/// An [Encoding] parsed once into a native `z_owned_encoding_t`.
+///
+/// Created by [Encoding.compile]. Compares equal to the [Encoding] with
+/// the same MIME type. Must be [dispose]d when no longer needed to release
+/// native memory.
+class CompiledEncoding extends Encoding {
+  final Pointer<Void> _ptr;
+  bool _disposed = false;
+
+  CompiledEncoding._(super.mimeType)
+    : _ptr = calloc.allocate(bindings.zd_encoding_sizeof()) {
+    final nativeStr = mimeType.toNativeUtf8();
+    try {
+      final rc = bindings.zd_encoding_from_str(_ptr.cast(), nativeStr.cast());
+      if (rc != 0) {
+        calloc.free(_ptr);
+        throw ZenohException('Invalid encoding: "$mimeType"', rc);
+      }
+    } finally {
+      malloc.free(nativeStr);
+    }
+  }
+
+  /// Internal: returns the native `z_owned_encoding_t` pointer.
+  ///
+  /// Throws [StateError] if this encoding has been disposed.
+  Pointer<Void> get nativePtr {
+    if (_disposed) throw StateError('CompiledEncoding has been disposed');
+    return _ptr;
+  }
+
+  /// Returns this encoding, which is already compiled.
+  @override
+  CompiledEncoding compile() => this;
+
+  /// Releases the native encoding.
+  ///
+  /// Safe to call multiple times -- subsequent calls are no-ops.
+  void dispose() {
+    if (_disposed) return;
+    _disposed = true;
+    bindings.zd_encoding_drop(_ptr.cast());
+    calloc.free(_ptr);
+  }
+}
@@ -0,0 +1,194 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import 'bindings.dart';
+import 'native_lib.dart';
+import 'sample.dart';
+
+/// A sample delivered as a native handle by a subscriber declared with
+/// `SubscriberOptions.lazy`.
+///
+/// Only the key expression and kind cross the native port. The payload,
+/// attachment, encoding and timestamp stay in a cloned `z_owned_sample_t`
+/// and are copied out on first access, so samples that are filtered on
+/// [keyExpr] or [kind] never pay for a payload copy.
+///
+/// The native sample is released by [dispose], or by a [NativeFinalizer]
+/// once the [LazySample] is garbage collected. Fields read before
+/// [dispose] remain available afterwards.
+class LazySample implements Sample {
+  static final _finalizer = NativeFinalizer(
+    nativeLibrary.lookup<NativeFinalizerFunction>('zd_sample_drop'),
+  );
+
+  final Pointer<Uint8> _handle;
+  bool _disposed = false;
+
+  @override
+  final String keyExpr;
+
+  @override
+  final SampleKind kind;
+
+  Uint8List? _payloadBytes;
+  String? _payload;
+  bool _attachmentRead = false;
+  Uint8List? _attachmentBytes;
+  String? _attachment;
+  bool _encodingRead = false;
+  String? _encoding;
+  bool _timestampRead = false;
+  int? _timestamp;
+  SampleMetadata? _metadata;
+
+  /// Creates a LazySample from NativePort message data.
+  ///
+  /// This is called internally by the subscriber stream handler, which
+  /// transfers ownership of the native sample at [handle].
+  LazySample({required int handle, required this.keyExpr, required this.kind})
+    : _handle = Pointer.fromAddress(handle) {
+    _finalizer.attach(this, _handle.cast(), detach: this);
+  }
+
+  void _ensureNotDisposed() {
+    if (_disposed) {
+      throw StateError('LazySample has been disposed');
+    }
+  }
+
+  /// The raw payload bytes, copied from the native sample on first access.
+  ///
+  /// Throws [StateError] if first accessed after [dispose].
+  @override
+  Uint8List get payloadBytes {
+    if (_payloadBytes == null) {
+      _ensureNotDisposed();
+      final len = bindings.zd_sample_payload(_handle, nullptr, 0);
+      _payloadBytes = _copyOut(
+        len,
+        (buf) => bindings.zd_sample_payload(_handle, buf, len),
+      );
+    }
+    return _payloadBytes!;
+  }
+
+  /// The payload size in bytes, read without copying the payload.
+  ///
+  /// Throws [StateError] if first accessed after [dispose].
+  @override
+  int get payloadLength {
+    final bytes = _payloadBytes;
+    if (bytes != null) return bytes.length;
+    _ensureNotDisposed();
+    return bindings.zd_sample_payload(_handle, nullptr, 0);
+  }
+
+  @override
+  String get payload => _payload ??= utf8.decode(payloadBytes);
+
+  /// The raw attachment bytes, or null if the sample has none.
+  ///
+  /// Throws [StateError] if first accessed after [dispose].
+  Uint8List? get attachmentBytes {
+    if (!_attachmentRead) {
+      _ensureNotDisposed();
+      final len = bindings.zd_sample_attachment(_handle, nullptr, 0);
+      if (len >= 0) {
+        _attachmentBytes = _copyOut(
+          len,
+          (buf) => bindings.zd_sample_attachment(_handle, buf, len),
+        );
+      }
+      _attachmentRead = true;
+    }
+    return _attachmentBytes;
+  }
+
+  @override
+  String? get attachment {
+    if (_attachment == null) {
+      final bytes = attachmentBytes;
+      if (bytes != null) _attachment = utf8.decode(bytes);
+    }
+    return _attachment;
+  }
+
+  /// Throws [StateError] if first accessed after [dispose].
+  @override
+  String? get encoding {
+    if (!_encodingRead) {
+      _ensureNotDisposed();
+      final ptr = bindings.zd_sample_encoding(_handle);
+      if (ptr != nullptr) {
+        _encoding = ptr.cast<Utf8>().toDartString();
+        malloc.free(ptr);
+      }
+      _encodingRead = true;
+    }
+    return _encoding;
+  }
+
+  /// The sample's NTP64 timestamp, or null if it was published without one.
+  ///
+  /// Throws [StateError] if first accessed after [dispose].
+  int? get timestamp {
+    if (!_timestampRead) {
+      _ensureNotDisposed();
+      final out = calloc<Uint64>();
+      try {
+        if (bindings.zd_sample_timestamp(_handle, out)) {
+          _timestamp = out.value;
+        }
+      } finally {
+        calloc.free(out);
+      }
+      _timestampRead = true;
+    }
+    return _timestamp;
+  }
+
+  /// The timestamp, source and QoS, copied from the native sample on first
+  /// access. Always available for lazy samples.
+  ///
+  /// Throws [StateError] if first accessed after [dispose].
+  @override
+  SampleMetadata get metadata {
+    if (_metadata == null) {
+      _ensureNotDisposed();
+      final out = calloc<zd_sample_metadata_t>();
+      try {
+        bindings.zd_sample_metadata(_handle, out);
+        _metadata = SampleMetadata.fromBytes(
+          Uint8List.fromList(
+            out.cast<Uint8>().asTypedList(sizeOf<zd_sample_metadata_t>()),
+          ),
+        );
+      } finally {
+        calloc.free(out);
+      }
+    }
+    return _metadata!;
+  }
+
+  /// Releases the native sample without waiting for garbage collection.
+  ///
+  /// Safe to call multiple times.
+  void dispose() {
+    if (_disposed) return;
+    _disposed = true;
+    _finalizer.detach(this);
+    bindings.zd_sample_drop(_handle);
+  }
+
+  /// Reads [len] bytes into a native buffer owned by the returned list,
+  /// so the bytes are copied only once.
+  static Uint8List _copyOut(int len, void Function(Pointer<Uint8>) read) {
+    if (len == 0) return Uint8List(0);
+    final buf = malloc<Uint8>(len);
+    read(buf);
+    return buf.asTypedList(len, finalizer: malloc.nativeFree);
+  }
+}
@@ -6,6 +6,7 @@ import 'bindings.dart';
 
 bool _initialized = false;
 late ZenohDartBindings _bindings;
+late DynamicLibrary _library;
 
 /// Returns the singleton [ZenohDartBindings] instance.
 ///
@@ -21,6 +22,17 @@ ZenohDartBindings get bindings {
   return _bindings;
 }
 
+/// Returns the loaded libzenoh_dart.so library.
+///
+/// Used to look up native function pointers, such as [NativeFinalizer]
+/// callbacks, that the generated bindings do not expose.
+///
+/// Auto-initializes on first access.
+DynamicLibrary get nativeLibrary {
+  if (!_initialized) ensureInitialized();
+  return _library;
+}
+
 /// Resolves the absolute path to a prebuilt native library.
 ///
 /// Prefers the `native/linux/x86_64/` directory (original prebuilts) over
@@ -96,6 +108,7 @@ void ensureInitialized() {
     }
   }
 
+  _library = lib;
   _bindings = ZenohDartBindings(lib);
 
   final result = _bindings.zd_init_dart_api_dl(NativeApi.initializeApiDLData);
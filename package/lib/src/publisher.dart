@@ -1,6 +1,8 @@
 import 'dart:async';
+import 'dart:convert';
 import 'dart:ffi';
 import 'dart:isolate';
+import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
 
@@ -10,6 +12,36 @@ import 'encoding.dart';
 import 'exceptions.dart';
 import 'native_lib.dart';
 import 'priority.dart';
+import 'shm_provider.dart';
+
+/// The outcome of [Publisher.benchmark].
+class PublishBenchmarkResult {
+  /// The number of messages published.
+  final int messages;
+
+  /// The number of payload bytes published.
+  final int bytes;
+
+  /// The time the publish loop ran for.
+  final Duration elapsed;
+
+  /// Creates a PublishBenchmarkResult.
+  const PublishBenchmarkResult({
+    required this.messages,
+    required this.bytes,
+    required this.elapsed,
+  });
+
+  /// Messages published per second.
+  double get messagesPerSecond => _perSecond(messages);
+
+  /// Payload bytes published per second.
+  double get bytesPerSecond => _perSecond(bytes);
+
+  double _perSecond(int value) => elapsed.inMicroseconds == 0
+      ? 0
+      : value * Duration.microsecondsPerSecond / elapsed.inMicroseconds;
+}
 
 /// A zenoh publisher for efficiently publishing multiple messages on a
 /// single key expression.
@@ -17,12 +49,36 @@ import 'priority.dart';
 /// Wraps `z_owned_publisher_t`. Call [close] when done to undeclare the
 /// publisher and release native resources.
 class Publisher {
+  /// The default [shmThreshold]: payloads longer than this go through
+  /// shared memory when a [shmProvider] is attached.
+  static const int defaultShmThreshold = 4096;
+
   final Pointer<Void> _ptr;
   bool _closed = false;
+  bool _benchmarking = false;
   final ReceivePort? _matchingPort;
   final StreamController<bool>? _matchingController;
 
-  Publisher._(this._ptr, this._matchingPort, this._matchingController);
+  /// The shared memory provider payloads above [shmThreshold] are
+  /// allocated from, or null to keep every payload on the heap.
+  ///
+  /// Applies to payloads the publisher builds itself, in [put],
+  /// [putUint8List] and [putBatch]; a [ZBytes] passed to [putBytes] is
+  /// published as is. If the provider has no room for a payload, it falls
+  /// back to the heap. The provider is not owned by the publisher and
+  /// must stay open while the publisher is in use.
+  final ShmProvider? shmProvider;
+
+  /// The payload length in bytes above which [shmProvider] is used.
+  final int shmThreshold;
+
+  Publisher._(
+    this._ptr,
+    this._matchingPort,
+    this._matchingController,
+    this.shmProvider,
+    this.shmThreshold,
+  );
 
   /// Creates a publisher on the given session and key expression.
   ///
@@ -35,7 +91,10 @@ class Publisher {
     Priority priority = Priority.data,
     bool isExpress = false,
     bool enableMatchingListener = false,
+    ShmProvider? shmProvider,
+    int shmThreshold = defaultShmThreshold,
   }) {
+    RangeError.checkNotNegative(shmThreshold, 'shmThreshold');
     final size = bindings.zd_publisher_sizeof();
     final Pointer<Void> ptr = calloc.allocate(size);
 
@@ -90,7 +149,13 @@ class Publisher {
       }
     }
 
-    return Publisher._(ptr, matchingPort, matchingController);
+    return Publisher._(
+      ptr,
+      matchingPort,
+      matchingController,
+      shmProvider,
+      shmThreshold,
+    );
   }
 
   void _ensureOpen() {
@@ -114,15 +179,19 @@ class Publisher {
 
   /// Publishes a string [value] through this publisher.
   ///
-  /// Optionally override the [encoding] for this specific put.
+  /// Optionally override the [encoding] for this specific put; pass a
+  /// [CompiledEncoding] to skip parsing it on every call.
   /// An optional [attachment] can be included (consumed by this call).
   void put(String value, {Encoding? encoding, ZBytes? attachment}) {
     _ensureOpen();
     final loaned = bindings.zd_publisher_loan(_ptr.cast());
-    final payload = ZBytes.fromString(value);
+    final payload = shmProvider == null
+        ? ZBytes.fromString(value)
+        : _payloadFrom(utf8.encode(value));
 
-    final encodingStr = encoding != null
-        ? encoding.mimeType.toNativeUtf8()
+    final encodingStr = _encodingString(encoding);
+    final compiledEncoding = encoding is CompiledEncoding
+        ? encoding.nativePtr
         : nullptr;
     final attachmentPtr = attachment != null ? attachment.nativePtr : nullptr;
 
@@ -131,6 +200,7 @@ class Publisher {
         loaned,
         payload.nativePtr.cast(),
         encodingStr.cast(),
+        compiledEncoding.cast(),
         attachmentPtr.cast(),
       );
 
@@ -154,8 +224,9 @@ class Publisher {
     final loaned = bindings.zd_publisher_loan(_ptr.cast());
     final payloadPtr = payload.nativePtr;
 
-    final encodingStr = encoding != null
-        ? encoding.mimeType.toNativeUtf8()
+    final encodingStr = _encodingString(encoding);
+    final compiledEncoding = encoding is CompiledEncoding
+        ? encoding.nativePtr
         : nullptr;
     final attachmentPtr = attachment != null ? attachment.nativePtr : nullptr;
 
@@ -164,6 +235,7 @@ class Publisher {
         loaned,
         payloadPtr.cast(),
         encodingStr.cast(),
+        compiledEncoding.cast(),
         attachmentPtr.cast(),
       );
 
@@ -178,6 +250,274 @@ class Publisher {
     }
   }
 
+  /// Publishes the bytes in [data] through this publisher.
+  ///
+  /// [data] is copied once, into shared memory when it is longer than
+  /// [shmThreshold] and a [shmProvider] is attached, or into the heap
+  /// otherwise. An optional [attachment] can be included (consumed by this
+  /// call).
+  void putUint8List(Uint8List data, {Encoding? encoding, ZBytes? attachment}) {
+    _ensureOpen();
+    putBytes(_payloadFrom(data), encoding: encoding, attachment: attachment);
+  }
+
+  /// Copies [data] into a new payload, in shared memory if it is longer
+  /// than [shmThreshold] and [shmProvider] has room for it.
+  ZBytes _payloadFrom(Uint8List data) {
+    final provider = shmProvider;
+    if (provider != null && data.length > shmThreshold) {
+      // Non-blocking allocation: a full provider falls back to the heap
+      // rather than stalling the isolate.
+      final buffer = provider.alloc(data.length);
+      if (buffer != null) {
+        try {
+          buffer.data.asTypedList(data.length).setAll(0, data);
+          return buffer.toBytes();
+        } finally {
+          buffer.dispose();
+        }
+      }
+    }
+    return ZBytes.fromUint8List(data);
+  }
+
+  /// Publishes every payload in [payloads] through this publisher with a
+  /// single native call.
+  ///
+  /// The payloads, and the optional [attachments] (one per payload, null
+  /// for none), are packed into one native arena and published in order,
+  /// so the FFI transition and the Dart-side allocation are paid once per
+  /// batch rather than once per message. The optional [encoding] override
+  /// applies to every message.
+  ///
+  /// With a [shmProvider] attached, payloads longer than [shmThreshold]
+  /// are published individually from shared memory, and the runs of
+  /// payloads between them as batches, keeping the order.
+  ///
+  /// Throws [ArgumentError] if [attachments] does not have one entry per
+  /// payload. Throws [ZenohException] if a put fails; the messages before
+  /// it have been published.
+  void putBatch(
+    List<Uint8List> payloads, {
+    List<Uint8List?>? attachments,
+    Encoding? encoding,
+  }) {
+    _ensureOpen();
+    if (attachments != null && attachments.length != payloads.length) {
+      throw ArgumentError.value(
+        attachments,
+        'attachments',
+        'must have one entry per payload',
+      );
+    }
+
+    if (shmProvider == null) {
+      _putBatchHeap(payloads, attachments, encoding, 0, payloads.length);
+      return;
+    }
+    var start = 0;
+    for (var i = 0; i < payloads.length; i++) {
+      if (payloads[i].length <= shmThreshold) continue;
+      _putBatchHeap(
+        payloads.sublist(start, i),
+        attachments?.sublist(start, i),
+        encoding,
+        start,
+        payloads.length,
+      );
+      final attachment = attachments?[i];
+      try {
+        putBytes(
+          _payloadFrom(payloads[i]),
+          encoding: encoding,
+          attachment: attachment == null
+              ? null
+              : ZBytes.fromUint8List(attachment),
+        );
+      } on ZenohException catch (e) {
+        throw ZenohException(
+          'Publisher batch put failed after $i of ${payloads.length} '
+          'messages',
+          e.returnCode,
+        );
+      }
+      start = i + 1;
+    }
+    _putBatchHeap(
+      payloads.sublist(start),
+      attachments?.sublist(start),
+      encoding,
+      start,
+      payloads.length,
+    );
+  }
+
+  /// Publishes [payloads] with one zd_publisher_put_batch call; [offset]
+  /// and [total] place them within the caller's batch for error messages.
+  void _putBatchHeap(
+    List<Uint8List> payloads,
+    List<Uint8List?>? attachments,
+    Encoding? encoding,
+    int offset,
+    int total,
+  ) {
+    final count = payloads.length;
+    if (count == 0) return;
+
+    // Arena layout: payload pointers and lengths, attachment pointers and
+    // lengths (when given), the published count, then the message bytes.
+    final tableSize = count * (sizeOf<Pointer<Uint8>>() + sizeOf<Size>());
+    final headerSize =
+        tableSize * (attachments != null ? 2 : 1) + sizeOf<Int64>();
+    var dataSize = 0;
+    for (final payload in payloads) {
+      dataSize += payload.length;
+    }
+    for (final attachment in attachments ?? const <Uint8List?>[]) {
+      dataSize += attachment?.length ?? 0;
+    }
+
+    final compiledEncoding = encoding is CompiledEncoding
+        ? encoding.nativePtr
+        : nullptr;
+    final arena = malloc<Uint8>(headerSize + dataSize);
+    final encodingStr = _encodingString(encoding);
+    try {
+      final payloadPtrs = arena.cast<Pointer<Uint8>>();
+      final payloadLens = (payloadPtrs + count).cast<Size>();
+      var attachmentPtrs = nullptr.cast<Pointer<Uint8>>();
+      var attachmentLens = nullptr.cast<Size>();
+      var next = (payloadLens + count).cast<Uint8>();
+      if (attachments != null) {
+        attachmentPtrs = next.cast<Pointer<Uint8>>();
+        attachmentLens = (attachmentPtrs + count).cast<Size>();
+        next = (attachmentLens + count).cast<Uint8>();
+      }
+      final publishedOut = next.cast<Int32>();
+      var data = next + sizeOf<Int64>();
+
+      for (var i = 0; i < count; i++) {
+        final payload = payloads[i];
+        data.asTypedList(payload.length).setAll(0, payload);
+        payloadPtrs[i] = data;
+        payloadLens[i] = payload.length;
+        data += payload.length;
+
+        if (attachments != null) {
+          final attachment = attachments[i];
+          if (attachment == null) {
+            attachmentPtrs[i] = nullptr;
+            attachmentLens[i] = 0;
+          } else {
+            data.asTypedList(attachment.length).setAll(0, attachment);
+            attachmentPtrs[i] = data;
+            attachmentLens[i] = attachment.length;
+            data += attachment.length;
+          }
+        }
+      }
+
+      final rc = bindings.zd_publisher_put_batch(
+        bindings.zd_publisher_loan(_ptr.cast()),
+        payloadPtrs,
+        payloadLens,
+        attachmentPtrs,
+        attachmentLens,
+        count,
+        encodingStr.cast(),
+        compiledEncoding.cast(),
+        publishedOut,
+      );
+      if (rc != 0) {
+        throw ZenohException(
+          'Publisher batch put failed after '
+          '${offset + publishedOut.value} of $total messages',
+          rc,
+        );
+      }
+    } finally {
+      malloc.free(arena);
+      if (encodingStr != nullptr) malloc.free(encodingStr);
+    }
+  }
+
+  /// Publishes [payloadSize]-byte messages in a tight loop on a native
+  /// thread and reports the throughput achieved.
+  ///
+  /// The loop stops after [count] messages or once [duration] has elapsed,
+  /// whichever comes first; at least one must be given. Each message is a
+  /// shallow clone of one payload, as in `example/z_pub_thr.dart`, but no
+  /// Dart code or FFI transition runs per message, so comparing the result
+  /// with a Dart publish loop separates the binding overhead from the
+  /// network stack. [close] takes effect once the benchmark completes.
+  ///
+  /// Throws [ArgumentError] if neither limit is given or one is not
+  /// positive. Throws [StateError] if a benchmark is already running.
+  /// Throws [ZenohException] if the loop cannot start or a put fails.
+  Future<PublishBenchmarkResult> benchmark(
+    int payloadSize, {
+    int? count,
+    Duration? duration,
+  }) async {
+    _ensureOpen();
+    if (_benchmarking) {
+      throw StateError('Publisher is already running a benchmark');
+    }
+    RangeError.checkNotNegative(payloadSize, 'payloadSize');
+    if (count == null && duration == null) {
+      throw ArgumentError('Either count or duration must be given');
+    }
+    if (count != null && count < 1) {
+      throw ArgumentError.value(count, 'count', 'must be positive');
+    }
+    if (duration != null && duration.inMicroseconds < 1) {
+      throw ArgumentError.value(duration, 'duration', 'must be positive');
+    }
+
+    final port = ReceivePort();
+    final rc = bindings.zd_publisher_benchmark(
+      bindings.zd_publisher_loan(_ptr.cast()),
+      payloadSize,
+      count ?? 0,
+      duration?.inMicroseconds ?? 0,
+      port.sendPort.nativePort,
+    );
+    if (rc != 0) {
+      port.close();
+      throw ZenohException('Failed to start publish benchmark', rc);
+    }
+
+    // The message is [messages, bytes, elapsed_ns, rc].
+    final List<dynamic> message;
+    _benchmarking = true;
+    try {
+      message = await port.first as List<dynamic>;
+    } finally {
+      _benchmarking = false;
+      if (_closed) _drop();
+    }
+    final messages = message[0] as int;
+    final putRc = message[3] as int;
+    if (putRc != 0) {
+      throw ZenohException(
+        'Publish benchmark failed after $messages messages',
+        putRc,
+      );
+    }
+    return PublishBenchmarkResult(
+      messages: messages,
+      bytes: message[1] as int,
+      elapsed: Duration(microseconds: (message[2] as int) ~/ 1000),
+    );
+  }
+
+  /// Marshals [encoding] for a put, or returns `nullptr` when there is no
+  /// override or it is passed pre-parsed as a [CompiledEncoding].
+  static Pointer<Utf8> _encodingString(Encoding? encoding) =>
+      encoding == null || encoding is CompiledEncoding
+      ? nullptr
+      : encoding.mimeType.toNativeUtf8();
+
   /// Sends a DELETE through this publisher.
   void deleteResource() {
     _ensureOpen();
@@ -211,13 +551,18 @@ class Publisher {
 
   /// Undeclares the publisher and releases native resources.
   ///
-  /// Safe to call multiple times -- subsequent calls are no-ops.
+  /// While a [benchmark] runs, the publisher is undeclared once it
+  /// completes. Safe to call multiple times -- subsequent calls are no-ops.
   void close() {
     if (_closed) return;
     _closed = true;
-    bindings.zd_publisher_drop(_ptr.cast());
     _matchingPort?.close();
     _matchingController?.close();
+    if (!_benchmarking) _drop();
+  }
+
+  void _drop() {
+    bindings.zd_publisher_drop(_ptr.cast());
     calloc.free(_ptr);
   }
 }
@@ -1,130 +1,293 @@
-import 'dart:convert';
+import 'dart:async';
 import 'dart:ffi';
+import 'dart:isolate';
+import 'dart:math';
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
 
+import 'bindings.dart';
+import 'exceptions.dart';
 import 'native_lib.dart';
 import 'sample.dart';
 
-/// A zenoh pull subscriber that receives samples via a ring buffer.
+/// The buffer a [PullSubscriber] holds samples in.
+enum PullChannel {
+  /// A ring buffer: when full, the oldest sample is dropped to make room.
+  ring,
+
+  /// A FIFO buffer: when full, the zenoh callback blocks until a sample is
+  /// received, applying backpressure instead of dropping samples.
+  fifo,
+}
+
+/// A zenoh pull subscriber that receives samples via a ring or FIFO buffer.
 ///
 /// Unlike [Subscriber] which delivers samples asynchronously via a stream,
-/// PullSubscriber buffers samples in a ring channel and delivers them
-/// on-demand via [tryRecv].
+/// PullSubscriber buffers samples in a [PullChannel] and delivers them
+/// on-demand via [tryRecv] or, many at a time, via [tryRecvBatch]. To wait
+/// for a sample without polling, use [recv] (blocking) or [next] (async).
 ///
 /// Call [close] when done to undeclare the subscriber and release
 /// native resources.
 class PullSubscriber {
+  // Frame layout (mirrors zd_pull_subscriber_try_recv_batch): an 8-byte
+  // prefix holding the uint32 frame length, then the sample in the flat
+  // wire format, padded to 8 bytes.
+  static const int _frameHeaderSize = 8;
+
   final Pointer<Uint8> _subscriberHandle;
   final Pointer<Uint8> _handlerHandle;
+  final PullChannel _channel;
+  final Pointer<zd_pull_waiter_t> _waiter;
   final String _keyExpr;
   bool _closed = false;
 
+  // Receive descriptor reused by [tryRecv], with the strings decoded from
+  // it for the last sample.
+  final Pointer<zd_pull_recv_t> _recv = calloc<zd_pull_recv_t>();
+  String? _lastKeyExpr;
+  String? _lastEncoding;
+
+  // Arena and out-parameters of [tryRecvBatch], kept across calls until
+  // samples returned from it reference the arena.
+  Pointer<Uint8> _arena = nullptr;
+  int _arenaSize = 0;
+  final Pointer<Size> _arenaUsed = calloc<Size>();
+  final Pointer<Pointer<Uint8>> _overflow = calloc<Pointer<Uint8>>();
+
+  // Doorbell used by [next], created on first use.
+  RawReceivePort? _doorbellPort;
+  Completer<void>? _doorbell;
+
   /// Internal constructor. Use [Session.declarePullSubscriber] instead.
-  PullSubscriber(this._subscriberHandle, this._handlerHandle, this._keyExpr);
+  PullSubscriber(
+    this._subscriberHandle,
+    this._handlerHandle,
+    this._channel,
+    this._waiter,
+    this._keyExpr,
+  );
 
   /// The key expression this pull subscriber is declared on.
   String get keyExpr => _keyExpr;
 
-  /// Tries to receive a sample from the ring buffer.
+  /// The kind of buffer this pull subscriber holds samples in.
+  PullChannel get channel => _channel;
+
+  /// Tries to receive a sample from the buffer.
   ///
   /// Returns a [Sample] if one is available, or `null` if the buffer is
   /// empty or the channel has been disconnected.
   ///
+  /// The sample is written into a native receive descriptor owned by this
+  /// subscriber and reused across calls, so polling small samples does no
+  /// native heap allocation. Payloads larger than the descriptor's inline
+  /// area are handed over in their own buffer instead of being copied.
+  ///
   /// Throws [StateError] if the subscriber has been closed.
   Sample? tryRecv() {
     if (_closed) throw StateError('PullSubscriber is closed');
 
-    final outKeyexpr = calloc<Pointer<Char>>();
-    final outPayload = calloc<Pointer<Uint8>>();
-    final outPayloadLen = calloc<Int32>();
-    final outKind = calloc<Int8>();
-    final outEncoding = calloc<Pointer<Char>>();
-    final outAttachment = calloc<Pointer<Uint8>>();
-    final outAttachmentLen = calloc<Int32>();
-
-    try {
-      final rc = bindings.zd_pull_subscriber_try_recv(
-        _handlerHandle,
-        outKeyexpr.cast(),
-        outPayload.cast(),
-        outPayloadLen,
-        outKind,
-        outEncoding.cast(),
-        outAttachment.cast(),
-        outAttachmentLen,
+    final rc = bindings.zd_pull_subscriber_try_recv_into(
+      _handlerHandle,
+      // PullChannel indices mirror the ZD_PULL_CHANNEL_* values.
+      _channel.index,
+      _recv,
+    );
+    if (rc != 0) {
+      // 1 = disconnected, 2 = empty, -1 = out of memory — all return null
+      return null;
+    }
+
+    final recv = _recv.ref;
+    // The key expression and encoding are only decoded when they change.
+    if (recv.keyexpr_changed) {
+      _lastKeyExpr = recv.keyexpr.cast<Utf8>().toDartString(
+        length: recv.keyexpr_len,
       );
+    }
+    if (recv.encoding_changed) {
+      _lastEncoding = recv.encoding_len > 0
+          ? recv.encoding.cast<Utf8>().toDartString(length: recv.encoding_len)
+          : null;
+    }
 
-      if (rc != 0) {
-        // 1 = disconnected, 2 = empty — both return null
-        return null;
-      }
+    final payloadBytes = recv.payload_owned
+        ? recv.payload.asTypedList(
+            recv.payload_len,
+            finalizer: malloc.nativeFree,
+          )
+        : Uint8List.fromList(recv.payload.asTypedList(recv.payload_len));
+    final attachmentBytes = recv.has_attachment && recv.attachment_len > 0
+        ? Uint8List.fromList(recv.attachment.asTypedList(recv.attachment_len))
+        : null;
 
-      // Extract fields from malloc'd pointers
-      final keyExprPtr = outKeyexpr.value;
-      final keyExprStr = keyExprPtr.cast<Utf8>().toDartString();
-
-      final payloadLen = outPayloadLen.value;
-      final payloadPtr = outPayload.value;
-      Uint8List payloadBytes;
-      String payloadStr;
-      if (payloadLen > 0 && payloadPtr != nullptr) {
-        payloadBytes = Uint8List.fromList(payloadPtr.asTypedList(payloadLen));
-        payloadStr = utf8.decode(payloadBytes);
-      } else {
-        payloadBytes = Uint8List(0);
-        payloadStr = '';
-      }
+    return Sample.fromBytes(
+      keyExpr: _lastKeyExpr!,
+      payloadBytes: payloadBytes,
+      kind: recv.kind == 0 ? SampleKind.put : SampleKind.delete,
+      attachmentBytes: attachmentBytes,
+      encoding: _lastEncoding,
+    );
+  }
 
-      final kind = outKind.value;
+  /// Receives a sample from the buffer, blocking the calling isolate
+  /// until one arrives or [timeout] expires.
+  ///
+  /// The wait is a native condition variable signalled by the zenoh
+  /// callback, so no CPU is spent polling. Returns `null` on timeout, or
+  /// once the buffer is drained after the channel has been disconnected.
+  /// Waits forever when [timeout] is null.
+  ///
+  /// Throws [StateError] if the subscriber has been closed.
+  Sample? recv({Duration? timeout}) {
+    if (_closed) throw StateError('PullSubscriber is closed');
 
-      final encodingPtr = outEncoding.value;
-      String? encodingStr;
-      if (encodingPtr != nullptr) {
-        encodingStr = encodingPtr.cast<Utf8>().toDartString();
-      }
+    final stopwatch = Stopwatch()..start();
+    while (true) {
+      final seen = bindings.zd_pull_waiter_arrivals(_waiter);
+      final sample = tryRecv();
+      if (sample != null) return sample;
 
-      final attachmentLen = outAttachmentLen.value;
-      final attachmentPtr = outAttachment.value;
-      String? attachmentStr;
-      if (attachmentLen > 0 && attachmentPtr != nullptr) {
-        final attachmentBytes = Uint8List.fromList(
-          attachmentPtr.asTypedList(attachmentLen),
-        );
-        attachmentStr = utf8.decode(attachmentBytes);
-      }
+      final remaining = timeout == null
+          ? -1
+          : max(0, (timeout - stopwatch.elapsed).inMicroseconds);
+      final rc = bindings.zd_pull_waiter_wait(_waiter, seen, remaining);
+      if (rc == 1) return null; // timed out
+      if (rc == -1) return tryRecv(); // disconnected
+    }
+  }
 
-      // Free all malloc'd C buffers (allocated by C malloc)
-      if (keyExprPtr != nullptr) {
-        malloc.free(keyExprPtr.cast());
-      }
-      if (payloadPtr != nullptr) {
-        malloc.free(payloadPtr.cast());
-      }
-      if (encodingPtr != nullptr) {
-        malloc.free(encodingPtr.cast());
-      }
-      if (attachmentPtr != nullptr) {
-        malloc.free(attachmentPtr.cast());
+  /// Receives the next sample from the buffer, completing as soon as
+  /// one arrives.
+  ///
+  /// When the buffer is empty a one-shot native doorbell is armed and
+  /// rung by the zenoh callback on the next arrival, so waiting costs no
+  /// polling. Completes with `null` if the subscriber is closed while
+  /// waiting, or once the buffer is drained after the channel has been
+  /// disconnected.
+  ///
+  /// Throws [StateError] if the subscriber has been closed.
+  Future<Sample?> next() async {
+    if (_closed) throw StateError('PullSubscriber is closed');
+
+    while (!_closed) {
+      final seen = bindings.zd_pull_waiter_arrivals(_waiter);
+      final sample = tryRecv();
+      if (sample != null) return sample;
+
+      // Concurrent callers share the armed doorbell.
+      final pending = _doorbell;
+      if (pending != null) {
+        await pending.future;
+        continue;
       }
+      final port = _doorbellPort ??= _newDoorbellPort();
+      final rc = bindings.zd_pull_waiter_arm(
+        _waiter,
+        port.sendPort.nativePort,
+        seen,
+      );
+      if (rc == 1) continue; // arrived while arming
+      if (rc == -1) return tryRecv(); // disconnected
+
+      // Keep the isolate alive only while a doorbell is armed.
+      port.keepIsolateAlive = true;
+      final doorbell = _doorbell = Completer<void>();
+      await doorbell.future;
+    }
+    return null;
+  }
+
+  // The port must not keep the isolate alive until a doorbell is armed.
+  RawReceivePort _newDoorbellPort() =>
+      RawReceivePort(_onDoorbell)..keepIsolateAlive = false;
+
+  void _onDoorbell(dynamic _) {
+    _doorbellPort?.keepIsolateAlive = false;
+    final doorbell = _doorbell;
+    _doorbell = null;
+    doorbell?.complete();
+  }
+
+  /// Receives up to [maxSamples] samples from the buffer with a single
+  /// native call.
+  ///
+  /// The samples are framed into a native arena of [arenaSize] bytes and
+  /// each returned [Sample] reads its fields from a view into it; the
+  /// arena is freed once every sample backed by it has been garbage
+  /// collected. Calls that return no sample from the arena keep it for the
+  /// next call, so polling an empty buffer allocates nothing. A sample
+  /// larger than the space left is returned in its own buffer and ends the
+  /// batch, so fewer than [maxSamples] may be returned while the buffer
+  /// still holds samples.
+  ///
+  /// Returns an empty list if the buffer is empty or the channel has been
+  /// disconnected.
+  ///
+  /// Throws [StateError] if the subscriber has been closed.
+  /// Throws [ZenohException] if a sample that did not fit in the arena
+  /// could not be allocated; it is lost along with the rest of the batch.
+  List<Sample> tryRecvBatch({int maxSamples = 256, int arenaSize = 65536}) {
+    if (_closed) throw StateError('PullSubscriber is closed');
+
+    if (_arena != nullptr && _arenaSize != arenaSize) {
+      malloc.free(_arena);
+      _arena = nullptr;
+    }
+    if (_arena == nullptr) {
+      _arena = malloc<Uint8>(arenaSize);
+      _arenaSize = arenaSize;
+    }
+    final arena = _arena;
+    final count = bindings.zd_pull_subscriber_try_recv_batch(
+      _handlerHandle,
+      _channel.index,
+      arena,
+      arenaSize,
+      maxSamples,
+      _arenaUsed,
+      _overflow,
+    );
+    if (count == -2) {
+      throw ZenohException('Failed to allocate an overflow sample', count);
+    }
+    final used = _arenaUsed.value;
+    final overflow = _overflow.value;
 
-      return Sample(
-        keyExpr: keyExprStr,
-        payload: payloadStr,
-        payloadBytes: payloadBytes,
-        kind: kind == 0 ? SampleKind.put : SampleKind.delete,
-        attachment: attachmentStr,
-        encoding: encodingStr,
+    final samples = <Sample>[];
+    if (count > 0) {
+      // Dart owns the arena from here on; the next call allocates another.
+      _arena = nullptr;
+      _readFrames(
+        arena.asTypedList(used, finalizer: malloc.nativeFree),
+        samples,
       );
-    } finally {
-      calloc.free(outKeyexpr);
-      calloc.free(outPayload);
-      calloc.free(outPayloadLen);
-      calloc.free(outKind);
-      calloc.free(outEncoding);
-      calloc.free(outAttachment);
-      calloc.free(outAttachmentLen);
+    }
+    if (overflow != nullptr) {
+      final length = overflow.cast<Uint32>().value;
+      _readFrames(
+        overflow.asTypedList(
+          (_frameHeaderSize + length + 7) & ~7,
+          finalizer: malloc.nativeFree,
+        ),
+        samples,
+      );
+    }
+    return samples;
+  }
+
+  static void _readFrames(Uint8List data, List<Sample> samples) {
+    final view = ByteData.sublistView(data);
+    var offset = 0;
+    while (offset < data.length) {
+      final length = view.getUint32(offset, Endian.host);
+      final start = offset + _frameHeaderSize;
+      samples.add(
+        Sample.fromWire(Uint8List.sublistView(data, start, start + length)),
+      );
+      offset += (_frameHeaderSize + length + 7) & ~7;
     }
   }
 
@@ -134,12 +297,29 @@ class PullSubscriber {
   void close() {
     if (_closed) return;
     _closed = true;
-    // Drop subscriber first (undeclares from the session)
-    bindings.zd_subscriber_drop(_subscriberHandle.cast());
-    // Then drop ring handler
-    bindings.zd_ring_handler_sample_drop(_handlerHandle);
+    if (_channel == PullChannel.fifo) {
+      // Drop the FIFO handler first: this disconnects the channel and
+      // unblocks a zenoh callback waiting for room, so the subscriber
+      // drop below cannot stall behind it.
+      bindings.zd_fifo_handler_sample_drop(_handlerHandle);
+      bindings.zd_subscriber_drop(_subscriberHandle.cast());
+    } else {
+      // Drop subscriber first (undeclares from the session)
+      bindings.zd_subscriber_drop(_subscriberHandle.cast());
+      // Then drop ring handler
+      bindings.zd_ring_handler_sample_drop(_handlerHandle);
+    }
+    bindings.zd_pull_waiter_free(_waiter);
+    bindings.zd_pull_recv_release(_recv);
+    // Wake pending [next] calls, which complete with null
+    _doorbellPort?.close();
+    _onDoorbell(null);
     // Free allocated handle memory
     calloc.free(_subscriberHandle);
     calloc.free(_handlerHandle);
+    calloc.free(_recv);
+    if (_arena != nullptr) malloc.free(_arena);
+    calloc.free(_arenaUsed);
+    calloc.free(_overflow);
   }
 }
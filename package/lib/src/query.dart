@@ -74,8 +74,12 @@ class Query {
 
     final keyExprNative = keyExpr.toNativeUtf8();
 
+    // A CompiledEncoding is passed pre-parsed instead of as a string.
+    final compiledEncoding = encoding is CompiledEncoding
+        ? encoding.nativePtr
+        : nullptr;
     Pointer<Utf8> encodingNative = nullptr;
-    if (encoding != null) {
+    if (encoding != null && encoding is! CompiledEncoding) {
       encodingNative = encoding.mimeType.toNativeUtf8();
     }
 
@@ -84,7 +88,8 @@ class Query {
         Pointer.fromAddress(_handle).cast(),
         keyExprNative.cast(),
         payload.nativePtr.cast(),
-        encoding != null ? encodingNative.cast() : nullptr,
+        encodingNative.cast(),
+        compiledEncoding.cast(),
       );
 
       if (rc != 0) {
@@ -94,7 +99,7 @@ class Query {
       payload.markConsumed();
     } finally {
       calloc.free(keyExprNative);
-      if (encoding != null) {
+      if (encodingNative != nullptr) {
         calloc.free(encodingNative);
       }
     }
@@ -1,5 +1,10 @@
+import 'dart:convert';
 import 'dart:typed_data';
 
+import 'congestion_control.dart';
+import 'id.dart';
+import 'priority.dart';
+
 /// The kind of a sample (put or delete).
 enum SampleKind {
   /// A put sample: data was published.
@@ -9,36 +14,333 @@ enum SampleKind {
   delete,
 }
 
+/// An optional sample field a subscriber can be asked to deliver.
+///
+/// The key expression and kind are always delivered. See
+/// `SubscriberOptions.fields`.
+enum SampleField {
+  /// The payload bytes. When omitted only [Sample.payloadLength] is set.
+  payload,
+
+  /// The attachment bytes.
+  attachment,
+
+  /// The encoding string.
+  encoding,
+
+  /// The timestamp, source and QoS, delivered as [Sample.metadata].
+  /// Not requested by default.
+  metadata,
+}
+
+/// The timestamp, source and QoS of a received sample.
+///
+/// Decoded on access from the packed bytes posted by the subscriber.
+class SampleMetadata {
+  // Packed layout (mirrors zd_sample_metadata_t).
+  static const int _timestampOffset = 0;
+  static const int _timestampIdOffset = 8;
+  static const int _sourceIdOffset = 24;
+  static const int _sourceEntityIdOffset = 40;
+  static const int _sourceSnOffset = 44;
+  static const int _priorityOffset = 48;
+  static const int _congestionControlOffset = 49;
+  static const int _flagsOffset = 50;
+  static const int _size = 56;
+  static const int _hasTimestamp = 0x01;
+  static const int _hasSource = 0x02;
+  static const int _express = 0x04;
+
+  final ByteData _data;
+
+  /// Creates a [SampleMetadata] over the packed bytes of a
+  /// `zd_sample_metadata_t`.
+  SampleMetadata.fromBytes(Uint8List bytes)
+    : _data = ByteData.sublistView(bytes, 0, _size);
+
+  int get _flags => _data.getUint8(_flagsOffset);
+
+  /// The NTP64 timestamp, or null if the sample was published without one.
+  ///
+  /// The upper 32 bits count seconds since the Unix epoch and the lower 32
+  /// bits the fraction of a second.
+  int? get timestamp => (_flags & _hasTimestamp) != 0
+      ? _data.getUint64(_timestampOffset, Endian.host)
+      : null;
+
+  /// [timestamp] as a UTC [DateTime], with microsecond precision.
+  DateTime? get time {
+    final ntp64 = timestamp;
+    if (ntp64 == null) return null;
+    final seconds = ntp64 >>> 32;
+    final fraction = ntp64 & 0xFFFFFFFF;
+    return DateTime.fromMicrosecondsSinceEpoch(
+      seconds * 1000000 + ((fraction * 1000000) >>> 32),
+      isUtc: true,
+    );
+  }
+
+  /// The id of the zenoh runtime that created [timestamp].
+  ZenohId? get timestampId => (_flags & _hasTimestamp) != 0
+      ? ZenohId(_id(_timestampIdOffset))
+      : null;
+
+  /// The id of the publishing session, or null if the sample carries no
+  /// source info.
+  ZenohId? get sourceId =>
+      (_flags & _hasSource) != 0 ? ZenohId(_id(_sourceIdOffset)) : null;
+
+  /// The entity id of the publisher within its session.
+  int? get sourceEntityId => (_flags & _hasSource) != 0
+      ? _data.getUint32(_sourceEntityIdOffset, Endian.host)
+      : null;
+
+  /// The sequence number of the sample within its publisher, for gap and
+  /// reordering detection.
+  int? get sourceSequenceNumber => (_flags & _hasSource) != 0
+      ? _data.getUint32(_sourceSnOffset, Endian.host)
+      : null;
+
+  /// The priority the sample was published with.
+  Priority get priority =>
+      // zenoh-c uses 1-indexed priority.
+      Priority.values[_data.getUint8(_priorityOffset) - 1];
+
+  /// The congestion control the sample was published with.
+  CongestionControl get congestionControl =>
+      _data.getUint8(_congestionControlOffset) == 0
+      ? CongestionControl.block
+      : CongestionControl.drop;
+
+  /// Whether the sample was published without batching.
+  bool get isExpress => (_flags & _express) != 0;
+
+  Uint8List _id(int offset) =>
+      Uint8List.sublistView(_data, offset, offset + 16);
+}
+
 /// A sample received from a subscriber.
 ///
 /// Contains the key expression, payload, kind, and optional attachment
 /// extracted from a zenoh sample notification.
 class Sample {
-  /// The key expression the sample was published on.
-  final String keyExpr;
-
-  /// The payload as a UTF-8 string.
-  final String payload;
+  // Flat wire format header layout (mirrors zd_sample_wire_header_t).
+  static const int _wireKindOffset = 0;
+  static const int _wireFlagsOffset = 1;
+  static const int _wireKeyLenOffset = 4;
+  static const int _wireEncodingLenOffset = 8;
+  static const int _wireAttachmentLenOffset = 12;
+  static const int _wirePayloadOffsetOffset = 16;
+  static const int _wirePayloadLenOffset = 20;
+  static const int _wireHeaderSize = 24;
+  static const int _wireHasAttachment = 0x01;
+  static const int _wireKeyId = 0x02;
+  static const int _wireEncodingId = 0x04;
+  static const int _wireEncodingIdOffset = 2;
+  static const int _wireNoPayload = 0x08;
+  static const int _wireMetadata = 0x10;
 
   /// The raw payload bytes.
+  ///
+  /// For subscribers declared with `SubscriberOptions.zeroCopy` this is an
+  /// unmodifiable view of native memory owned by zenoh.
   final Uint8List payloadBytes;
 
   /// The kind of sample (put or delete).
   final SampleKind kind;
 
-  /// Optional attachment metadata as a UTF-8 string.
-  final String? attachment;
+  final int? _payloadLength;
+  String? _keyExpr;
+  String? _encoding;
+  String? _payload;
+  String? _attachment;
+  Uint8List? _attachmentBytes;
+  final Uint8List? _metadataBytes;
+  SampleMetadata? _metadata;
 
-  /// The encoding of the payload as a MIME type string, or null if unknown.
-  final String? encoding;
+  // Set for samples backed by a flat wire buffer; fields are sliced out of
+  // it on first access.
+  final Uint8List? _wire;
+  final int _wireBodyOffset;
+  final int _wireKeyLen;
+  final int _wireEncodingLen;
+  final int _wireAttachmentLen;
+  final bool _wireHasAttachmentFlag;
 
   /// Creates a [Sample] with the given fields.
   Sample({
-    required this.keyExpr,
-    required this.payload,
+    required String keyExpr,
+    required String payload,
     required this.payloadBytes,
     required this.kind,
-    this.attachment,
-    this.encoding,
-  });
+    String? attachment,
+    String? encoding,
+  }) : _payloadLength = null,
+       _keyExpr = keyExpr,
+       _payload = payload,
+       _attachment = attachment,
+       _encoding = encoding,
+       _metadataBytes = null,
+       _wire = null,
+       _wireBodyOffset = 0,
+       _wireKeyLen = 0,
+       _wireEncodingLen = 0,
+       _wireAttachmentLen = 0,
+       _wireHasAttachmentFlag = false;
+
+  /// Creates a [Sample] from raw bytes, decoding [payload] and
+  /// [attachment] on first access.
+  ///
+  /// Used by the subscriber channels so that samples which are only
+  /// inspected as bytes never pay for a UTF-8 decode. A [payloadLength]
+  /// is given instead of [payloadBytes] when the payload was not
+  /// requested (see [SampleField]). [metadataBytes] holds a packed
+  /// `zd_sample_metadata_t` when [SampleField.metadata] was requested.
+  Sample.fromBytes({
+    required String keyExpr,
+    Uint8List? payloadBytes,
+    int? payloadLength,
+    required this.kind,
+    Uint8List? attachmentBytes,
+    String? encoding,
+    Uint8List? metadataBytes,
+  }) : payloadBytes = payloadBytes ?? Uint8List(0),
+       _payloadLength = payloadLength,
+       _keyExpr = keyExpr,
+       _attachmentBytes = attachmentBytes,
+       _encoding = encoding,
+       _metadataBytes = metadataBytes,
+       _wire = null,
+       _wireBodyOffset = 0,
+       _wireKeyLen = 0,
+       _wireEncodingLen = 0,
+       _wireAttachmentLen = 0,
+       _wireHasAttachmentFlag = false;
+
+  /// Creates a [Sample] over a buffer in the flat wire format posted by
+  /// subscribers declared with `SubscriberOptions.flatWireFormat`.
+  ///
+  /// Only the fixed header is read up front; the key expression, encoding,
+  /// attachment and payload are views into [wire] materialized on first
+  /// access. Interned key ids are resolved in [keys] and cached encoding
+  /// ids in [encodings].
+  factory Sample.fromWire(
+    Uint8List wire, {
+    List<String> keys = const [],
+    List<String> encodings = const [],
+  }) {
+    final header = ByteData.sublistView(wire, 0, _wireHeaderSize);
+    final flags = header.getUint8(_wireFlagsOffset);
+    final keyLen = header.getUint32(_wireKeyLenOffset, Endian.host);
+    final internedKey = (flags & _wireKeyId) != 0;
+    final cachedEncoding = (flags & _wireEncodingId) != 0;
+    final payloadLen = header.getUint32(_wirePayloadLenOffset, Endian.host);
+    final noPayload = (flags & _wireNoPayload) != 0;
+    final hasMetadata = (flags & _wireMetadata) != 0;
+    return Sample._fromWire(
+      wire,
+      keyExpr: internedKey ? keys[keyLen] : null,
+      encoding: cachedEncoding
+          ? encodings[header.getUint16(_wireEncodingIdOffset, Endian.host)]
+          : null,
+      kind: header.getUint8(_wireKindOffset) == 0
+          ? SampleKind.put
+          : SampleKind.delete,
+      hasAttachment: (flags & _wireHasAttachment) != 0,
+      metadataLen: hasMetadata ? SampleMetadata._size : 0,
+      keyLen: internedKey ? 0 : keyLen,
+      encodingLen: header.getUint32(_wireEncodingLenOffset, Endian.host),
+      attachmentLen: header.getUint32(_wireAttachmentLenOffset, Endian.host),
+      payloadOffset: header.getUint32(_wirePayloadOffsetOffset, Endian.host),
+      payloadLen: noPayload ? 0 : payloadLen,
+      payloadLength: noPayload ? payloadLen : null,
+    );
+  }
+
+  Sample._fromWire(
+    Uint8List wire, {
+    required String? keyExpr,
+    required String? encoding,
+    required this.kind,
+    required bool hasAttachment,
+    required int metadataLen,
+    required int keyLen,
+    required int encodingLen,
+    required int attachmentLen,
+    required int payloadOffset,
+    required int payloadLen,
+    required int? payloadLength,
+  }) : _payloadLength = payloadLength,
+       _keyExpr = keyExpr,
+       _encoding = encoding,
+       _metadataBytes = metadataLen > 0
+           ? Uint8List.sublistView(
+               wire,
+               _wireHeaderSize,
+               _wireHeaderSize + metadataLen,
+             )
+           : null,
+       _wire = wire,
+       _wireBodyOffset = _wireHeaderSize + metadataLen,
+       _wireKeyLen = keyLen,
+       _wireEncodingLen = encodingLen,
+       _wireAttachmentLen = attachmentLen,
+       _wireHasAttachmentFlag = hasAttachment,
+       payloadBytes = Uint8List.sublistView(
+         wire,
+         payloadOffset,
+         payloadOffset + payloadLen,
+       );
+
+  /// The key expression the sample was published on.
+  String get keyExpr =>
+      _keyExpr ??= _wireString(_wireBodyOffset, _wireKeyLen);
+
+  /// The payload size in bytes.
+  ///
+  /// Available even when the payload itself was not requested, in which
+  /// case [payloadBytes] is empty.
+  int get payloadLength => _payloadLength ?? payloadBytes.length;
+
+  /// The payload as a UTF-8 string.
+  String get payload => _payload ??= utf8.decode(payloadBytes);
+
+  /// Optional attachment metadata as a UTF-8 string.
+  String? get attachment {
+    if (_attachment == null) {
+      final bytes = _attachmentView();
+      if (bytes != null) _attachment = utf8.decode(bytes);
+    }
+    return _attachment;
+  }
+
+  /// The encoding of the payload as a MIME type string, or null if unknown.
+  String? get encoding {
+    if (_encoding == null && _wire != null && _wireEncodingLen > 0) {
+      _encoding = _wireString(_wireBodyOffset + _wireKeyLen, _wireEncodingLen);
+    }
+    return _encoding;
+  }
+
+  /// The timestamp, source and QoS of the sample, or null unless the
+  /// subscriber requested [SampleField.metadata].
+  SampleMetadata? get metadata {
+    final bytes = _metadataBytes;
+    if (bytes == null) return null;
+    return _metadata ??= SampleMetadata.fromBytes(bytes);
+  }
+
+  Uint8List? _attachmentView() {
+    final wire = _wire;
+    if (wire == null || !_wireHasAttachmentFlag) return _attachmentBytes;
+    final start = _wireBodyOffset + _wireKeyLen + _wireEncodingLen;
+    return _attachmentBytes ??= Uint8List.sublistView(
+      wire,
+      start,
+      start + _wireAttachmentLen,
+    );
+  }
+
+  String _wireString(int start, int length) =>
+      utf8.decode(Uint8List.sublistView(_wire!, start, start + length));
 }
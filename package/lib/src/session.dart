@@ -8,8 +8,11 @@ import 'package:ffi/ffi.dart';
 
 import 'advanced_publisher.dart';
 import 'advanced_subscriber.dart';
+import 'aggregating_subscriber.dart';
+import 'bindings.dart';
 import 'bytes.dart';
 import 'config.dart';
+import 'conflating_subscriber.dart';
 import 'congestion_control.dart';
 import 'consolidation_mode.dart';
 import 'encoding.dart';
@@ -25,7 +28,10 @@ import 'querier.dart';
 import 'query_target.dart';
 import 'queryable.dart';
 import 'reply.dart';
+import 'ring_subscriber.dart';
 import 'sample.dart';
+import 'sharded_subscriber.dart';
+import 'shm_provider.dart';
 import 'subscriber.dart';
 
 /// A Zenoh session.
@@ -223,6 +229,10 @@ class Session {
   /// Returns a [Publisher] that can efficiently publish multiple messages
   /// to the same key expression. Call [Publisher.close] when done.
   ///
+  /// With a [shmProvider], payloads the publisher builds itself that are
+  /// longer than [shmThreshold] bytes are written into shared memory
+  /// instead of the heap; see [Publisher.shmProvider].
+  ///
   /// Throws [ZenohException] if the key expression is invalid.
   /// Throws [StateError] if the session has been closed.
   Publisher declarePublisher(
@@ -232,6 +242,8 @@ class Session {
     Priority priority = Priority.data,
     bool isExpress = false,
     bool enableMatchingListener = false,
+    ShmProvider? shmProvider,
+    int shmThreshold = Publisher.defaultShmThreshold,
   }) {
     _ensureOpen();
     final ke = KeyExpr(keyExpr);
@@ -248,6 +260,8 @@ class Session {
         priority: priority,
         isExpress: isExpress,
         enableMatchingListener: enableMatchingListener,
+        shmProvider: shmProvider,
+        shmThreshold: shmThreshold,
       );
     } finally {
       ke.dispose();
@@ -358,20 +372,27 @@ class Session {
   /// It lives until the session is closed, at which point the stream
   /// completes automatically.
   ///
+  /// [options] controls how samples are delivered (see [SubscriberOptions]).
+  ///
   /// Throws [ZenohException] if the key expression is invalid.
   /// Throws [StateError] if the session has been closed.
-  Stream<Sample> declareBackgroundSubscriber(String keyExpr) {
+  Stream<Sample> declareBackgroundSubscriber(
+    String keyExpr, {
+    SubscriberOptions options = const SubscriberOptions(),
+  }) {
     _ensureOpen();
     final (receivePort, controller) = Subscriber.createSampleChannel();
     final loanedSession =
         bindings.zd_session_loan(_ptr.cast()) as Pointer<Void>;
     final keyExprNative = keyExpr.toNativeUtf8();
+    final nativeOptions = Subscriber.allocateNativeOptions(options);
 
     try {
       final rc = bindings.zd_declare_background_subscriber(
         loanedSession.cast(),
         keyExprNative.cast(),
         receivePort.sendPort.nativePort,
+        nativeOptions,
       );
 
       if (rc != 0) {
@@ -381,6 +402,7 @@ class Session {
       }
     } finally {
       calloc.free(keyExprNative);
+      Subscriber.freeNativeOptions(nativeOptions);
     }
 
     return controller.stream;
@@ -391,9 +413,174 @@ class Session {
   /// Returns a [Subscriber] whose [Subscriber.stream] delivers [Sample]s.
   /// Call [Subscriber.close] when done to undeclare and release resources.
   ///
+  /// [options] controls how samples are delivered (see [SubscriberOptions]).
+  ///
+  /// Throws [ZenohException] if the key expression is invalid.
+  /// Throws [StateError] if the session has been closed.
+  Subscriber declareSubscriber(
+    String keyExpr, {
+    SubscriberOptions options = const SubscriberOptions(),
+  }) {
+    _ensureOpen();
+    final ke = KeyExpr(keyExpr);
+    try {
+      final loanedSession =
+          bindings.zd_session_loan(_ptr.cast()) as Pointer<Void>;
+      final loanedKe =
+          bindings.zd_view_keyexpr_loan(ke.nativePtr.cast()) as Pointer<Void>;
+      return Subscriber.declare(loanedSession, loanedKe, options: options);
+    } finally {
+      ke.dispose();
+    }
+  }
+
+  /// Declares a subscriber on the given [keyExpr] whose samples are
+  /// spread across [shardPorts] according to [mode].
+  ///
+  /// Each port must belong to a channel created with
+  /// [Subscriber.createSampleChannel], usually in a worker isolate, and
+  /// receives messages as a [Subscriber] declared with [options] would.
+  /// [SubscriberOptions.maxInFlight] is ignored. See
+  /// [spawnShardedSubscriber] to have the workers spawned for you.
+  ///
+  /// Throws [ArgumentError] if [shardPorts] is empty, or if
+  /// [SubscriberOptions.rateLimitInterval] is set with
+  /// [ShardMode.roundRobin].
+  /// Throws [ZenohException] if the key expression is invalid.
+  /// Throws [StateError] if the session has been closed.
+  ShardedSubscriber declareShardedSubscriber(
+    String keyExpr, {
+    required List<SendPort> shardPorts,
+    ShardMode mode = ShardMode.byKey,
+    SubscriberOptions options = const SubscriberOptions(),
+  }) => _declareShardedSubscriber(keyExpr, shardPorts, mode, options, []);
+
+  /// Spawns [shards] worker isolates, each running [worker] on the stream
+  /// of samples routed to it, and declares a sharded subscriber on
+  /// [keyExpr] feeding them.
+  ///
+  /// [worker] is sent to each isolate, so it must be a top-level function
+  /// or a closure over sendable values only. By-key sharding keeps
+  /// per-key ordering within a worker. Closing the returned subscriber
+  /// completes every worker's stream.
+  ///
+  /// Throws [ArgumentError] if [shards] is less than 1, or if
+  /// [SubscriberOptions.rateLimitInterval] is set with
+  /// [ShardMode.roundRobin].
+  /// Throws [ZenohException] if the key expression is invalid.
+  /// Throws [StateError] if the session has been closed.
+  Future<ShardedSubscriber> spawnShardedSubscriber(
+    String keyExpr, {
+    required int shards,
+    required ShardWorker worker,
+    ShardMode mode = ShardMode.byKey,
+    SubscriberOptions options = const SubscriberOptions(),
+  }) {
+    _ensureOpen();
+    return ShardedSubscriber.spawn(
+      (ports, isolates) =>
+          _declareShardedSubscriber(keyExpr, ports, mode, options, isolates),
+      shards: shards,
+      worker: worker,
+    );
+  }
+
+  ShardedSubscriber _declareShardedSubscriber(
+    String keyExpr,
+    List<SendPort> shardPorts,
+    ShardMode mode,
+    SubscriberOptions options,
+    List<Isolate> isolates,
+  ) {
+    _ensureOpen();
+    final ke = KeyExpr(keyExpr);
+    try {
+      final loanedSession =
+          bindings.zd_session_loan(_ptr.cast()) as Pointer<Void>;
+      final loanedKe =
+          bindings.zd_view_keyexpr_loan(ke.nativePtr.cast()) as Pointer<Void>;
+      return ShardedSubscriber.declare(
+        loanedSession,
+        loanedKe,
+        shardPorts: shardPorts,
+        mode: mode,
+        options: options,
+        isolates: isolates,
+      );
+    } finally {
+      ke.dispose();
+    }
+  }
+
+  /// Declares an aggregating subscriber on the given [keyExpr].
+  ///
+  /// Returns an [AggregatingSubscriber] whose
+  /// [AggregatingSubscriber.stream] delivers per-key count, min, max and
+  /// mean of numeric payloads once per window, as configured by
+  /// [options]. Call [AggregatingSubscriber.close] when done.
+  ///
+  /// Throws [ZenohException] if the key expression is invalid or the
+  /// window is not a multiple of the slide.
+  /// Throws [ArgumentError] if the window or slide is not positive.
+  /// Throws [StateError] if the session has been closed.
+  AggregatingSubscriber declareAggregatingSubscriber(
+    String keyExpr, {
+    AggregationOptions options = const AggregationOptions(),
+  }) {
+    _ensureOpen();
+    final ke = KeyExpr(keyExpr);
+    try {
+      final loanedSession =
+          bindings.zd_session_loan(_ptr.cast()) as Pointer<Void>;
+      final loanedKe =
+          bindings.zd_view_keyexpr_loan(ke.nativePtr.cast()) as Pointer<Void>;
+      return AggregatingSubscriber.declare(
+        loanedSession,
+        loanedKe,
+        options: options,
+      );
+    } finally {
+      ke.dispose();
+    }
+  }
+
+  /// Declares a conflating subscriber on the given [keyExpr].
+  ///
+  /// Returns a [ConflatingSubscriber] whose [ConflatingSubscriber.stream]
+  /// delivers only the newest [Sample] per key expression: samples that
+  /// are superseded before this isolate takes them are dropped natively.
+  /// Call [ConflatingSubscriber.close] when done.
+  ///
+  /// Throws [ZenohException] if the key expression is invalid.
+  /// Throws [StateError] if the session has been closed.
+  ConflatingSubscriber declareConflatingSubscriber(String keyExpr) {
+    _ensureOpen();
+    final ke = KeyExpr(keyExpr);
+    try {
+      final loanedSession =
+          bindings.zd_session_loan(_ptr.cast()) as Pointer<Void>;
+      final loanedKe =
+          bindings.zd_view_keyexpr_loan(ke.nativePtr.cast()) as Pointer<Void>;
+      return ConflatingSubscriber.declare(loanedSession, loanedKe);
+    } finally {
+      ke.dispose();
+    }
+  }
+
+  /// Declares a ring subscriber on the given [keyExpr].
+  ///
+  /// Returns a [RingSubscriber] whose [RingSubscriber.stream] delivers
+  /// [Sample]s read from a native ring of [capacity] bytes (rounded up to
+  /// a power of two). Suited to high-rate, low-latency topics; size the
+  /// ring for the largest burst expected between event-loop turns.
+  /// Call [RingSubscriber.close] when done.
+  ///
   /// Throws [ZenohException] if the key expression is invalid.
   /// Throws [StateError] if the session has been closed.
-  Subscriber declareSubscriber(String keyExpr) {
+  RingSubscriber declareRingSubscriber(
+    String keyExpr, {
+    int capacity = 1 << 20,
+  }) {
     _ensureOpen();
     final ke = KeyExpr(keyExpr);
     try {
@@ -401,7 +588,11 @@ class Session {
           bindings.zd_session_loan(_ptr.cast()) as Pointer<Void>;
       final loanedKe =
           bindings.zd_view_keyexpr_loan(ke.nativePtr.cast()) as Pointer<Void>;
-      return Subscriber.declare(loanedSession, loanedKe);
+      return RingSubscriber.declare(
+        loanedSession,
+        loanedKe,
+        capacity: capacity,
+      );
     } finally {
       ke.dispose();
     }
@@ -409,19 +600,29 @@ class Session {
 
   /// Declares a pull subscriber on the given [keyExpr].
   ///
-  /// Returns a [PullSubscriber] that buffers samples in a ring channel of
-  /// the given [capacity]. Use [PullSubscriber.tryRecv] to poll for samples.
-  /// Call [PullSubscriber.close] when done.
+  /// Returns a [PullSubscriber] that buffers samples in a channel of the
+  /// given [capacity]. A [PullChannel.ring] drops the oldest sample when
+  /// full; a [PullChannel.fifo] instead blocks delivery until a sample is
+  /// received, for lossless bounded buffering. Use [PullSubscriber.tryRecv]
+  /// to poll for samples, or [PullSubscriber.recv] and [PullSubscriber.next]
+  /// to wait for them. Call [PullSubscriber.close] when done.
   ///
   /// Throws [ZenohException] if the key expression is invalid.
   /// Throws [StateError] if the session has been closed.
-  PullSubscriber declarePullSubscriber(String keyExpr, {int capacity = 256}) {
+  PullSubscriber declarePullSubscriber(
+    String keyExpr, {
+    int capacity = 256,
+    PullChannel channel = PullChannel.ring,
+  }) {
     _ensureOpen();
 
     final subscriberSize = bindings.zd_subscriber_sizeof();
-    final handlerSize = bindings.zd_ring_handler_sample_sizeof();
+    final handlerSize = channel == PullChannel.fifo
+        ? bindings.zd_fifo_handler_sample_sizeof()
+        : bindings.zd_ring_handler_sample_sizeof();
     final subscriberHandle = calloc<Uint8>(subscriberSize);
     final handlerHandle = calloc<Uint8>(handlerSize);
+    final waiterOut = calloc<Pointer<zd_pull_waiter_t>>();
 
     final loanedSession =
         bindings.zd_session_loan(_ptr.cast()) as Pointer<Void>;
@@ -434,6 +635,9 @@ class Session {
         loanedSession.cast(),
         keyExprNative.cast(),
         capacity,
+        // PullChannel indices mirror the ZD_PULL_CHANNEL_* values.
+        channel.index,
+        waiterOut,
       );
 
       if (rc != 0) {
@@ -441,11 +645,18 @@ class Session {
         calloc.free(handlerHandle);
         throw ZenohException('Failed to declare pull subscriber', rc);
       }
+
+      return PullSubscriber(
+        subscriberHandle,
+        handlerHandle,
+        channel,
+        waiterOut.value,
+        keyExpr,
+      );
     } finally {
       calloc.free(keyExprNative);
+      calloc.free(waiterOut);
     }
-
-    return PullSubscriber(subscriberHandle, handlerHandle, keyExpr);
   }
 
   /// Declares a queryable on the given [keyExpr].
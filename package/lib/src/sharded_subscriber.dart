@@ -0,0 +1,163 @@
+import 'dart:async';
+import 'dart:ffi';
+import 'dart:isolate';
+
+import 'package:ffi/ffi.dart';
+
+import 'bindings.dart';
+import 'exceptions.dart';
+import 'native_lib.dart';
+import 'sample.dart';
+import 'subscriber.dart';
+
+/// How a [ShardedSubscriber] picks the port for each sample.
+enum ShardMode {
+  /// Route every sample on a key expression to the same shard, keeping
+  /// per-key ordering.
+  byKey,
+
+  /// Spread samples evenly across shards, with no ordering across them.
+  roundRobin,
+}
+
+/// A worker isolate entry point for [ShardedSubscriber.spawn]. It receives
+/// the stream of samples routed to its shard, which completes when the
+/// subscriber is closed.
+typedef ShardWorker = void Function(Stream<Sample> samples);
+
+/// A zenoh subscriber whose samples are spread natively across several
+/// Dart ports, typically one per worker isolate.
+///
+/// Each shard receives messages exactly as a [Subscriber] declared with
+/// the same [SubscriberOptions] would, so a worker parses them with the
+/// channel from [Subscriber.createSampleChannel]. This lets one hot
+/// subscription use several cores without declaring duplicate zenoh
+/// subscribers.
+///
+/// Call [close] when done; every shard's stream then completes.
+class ShardedSubscriber {
+  final Pointer<Void> _ptr;
+  final List<Isolate> _isolates;
+  bool _closed = false;
+
+  ShardedSubscriber._(this._ptr, this._isolates);
+
+  /// Creates a sharded subscriber delivering to [shardPorts].
+  ///
+  /// This is called internally by [Session.declareShardedSubscriber].
+  static ShardedSubscriber declare(
+    Pointer<Void> loanedSession,
+    Pointer<Void> loanedKe, {
+    required List<SendPort> shardPorts,
+    ShardMode mode = ShardMode.byKey,
+    SubscriberOptions options = const SubscriberOptions(),
+    List<Isolate> isolates = const [],
+  }) {
+    if (shardPorts.isEmpty) {
+      throw ArgumentError.value(shardPorts, 'shardPorts', 'must not be empty');
+    }
+    // Each shard limits the keys it sees; round-robin would spread one key
+    // over every shard and multiply its rate.
+    final rateLimitInterval = options.rateLimitInterval;
+    if (mode == ShardMode.roundRobin &&
+        rateLimitInterval != null &&
+        rateLimitInterval > Duration.zero) {
+      throw ArgumentError.value(
+        options,
+        'options',
+        'rateLimitInterval requires ShardMode.byKey',
+      );
+    }
+    final size = bindings.zd_subscriber_sizeof();
+    final Pointer<Void> ptr = calloc.allocate(size);
+    final ports = calloc<Int64>(shardPorts.length);
+    for (var i = 0; i < shardPorts.length; i++) {
+      ports[i] = shardPorts[i].nativePort;
+    }
+    // Flow control is bound to a single port, so it is not forwarded.
+    final nativeOptions = Subscriber.allocateNativeOptions(options);
+
+    final int rc;
+    try {
+      rc = bindings.zd_declare_sharded_subscriber(
+        loanedSession.cast(),
+        ptr.cast(),
+        loanedKe.cast(),
+        ports,
+        shardPorts.length,
+        // ShardMode indices mirror the ZD_SHARD_* values.
+        mode.index,
+        nativeOptions,
+      );
+    } finally {
+      calloc.free(ports);
+      Subscriber.freeNativeOptions(nativeOptions);
+    }
+
+    if (rc != 0) {
+      calloc.free(ptr);
+      throw ZenohException('Failed to declare sharded subscriber', rc);
+    }
+    return ShardedSubscriber._(ptr, isolates);
+  }
+
+  /// Spawns [shards] isolates running [worker] and declares a sharded
+  /// subscriber feeding them.
+  ///
+  /// This is called internally by [Session.spawnShardedSubscriber].
+  static Future<ShardedSubscriber> spawn(
+    ShardedSubscriber Function(List<SendPort> ports, List<Isolate> isolates)
+    declare, {
+    required int shards,
+    required ShardWorker worker,
+  }) async {
+    if (shards < 1) {
+      throw ArgumentError.value(shards, 'shards', 'must be at least 1');
+    }
+    final isolates = <Isolate>[];
+    final ports = <SendPort>[];
+    final handshake = ReceivePort();
+    final replies = StreamIterator(handshake);
+    try {
+      for (var i = 0; i < shards; i++) {
+        isolates.add(
+          await Isolate.spawn(_shardWorkerMain, (handshake.sendPort, worker)),
+        );
+        await replies.moveNext();
+        ports.add(replies.current as SendPort);
+      }
+      return declare(ports, isolates);
+    } catch (_) {
+      for (final isolate in isolates) {
+        isolate.kill(priority: Isolate.immediate);
+      }
+      rethrow;
+    } finally {
+      await replies.cancel();
+    }
+  }
+
+  /// The worker isolates started by [spawn], if any.
+  List<Isolate> get isolates => List.unmodifiable(_isolates);
+
+  /// Undeclares the subscriber and releases native resources.
+  ///
+  /// Every shard's stream completes once its pending samples are
+  /// delivered, which lets spawned workers exit. Safe to call multiple
+  /// times -- subsequent calls are no-ops.
+  void close() {
+    if (_closed) return;
+    _closed = true;
+    bindings.zd_subscriber_drop(_ptr.cast());
+    calloc.free(_ptr);
+  }
+}
+
+/// Worker isolate entry point: opens a sample channel, hands its port back
+/// to the spawning isolate and runs the worker on the stream.
+void _shardWorkerMain((SendPort, ShardWorker) args) {
+  final (reply, worker) = args;
+  final (receivePort, controller) = Subscriber.createSampleChannel();
+  reply.send(receivePort.sendPort);
+  worker(controller.stream);
+}
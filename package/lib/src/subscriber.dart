@@ -1,15 +1,213 @@
 import 'dart:async';
-import 'dart:convert';
 import 'dart:ffi';
 import 'dart:isolate';
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
 
+import 'bindings.dart';
 import 'exceptions.dart';
+import 'lazy_sample.dart';
 import 'native_lib.dart';
 import 'sample.dart';
 
+/// What a rate-limited subscriber does with samples that arrive before a
+/// key's interval has elapsed. See [SubscriberOptions.rateLimitInterval].
+enum RateLimitMode {
+  /// Deliver the first sample of each interval and drop the rest.
+  dropNewest,
+
+  /// Hold back the most recent sample and deliver it when the interval
+  /// ends, so the last value on every key is always seen.
+  keepLatest,
+}
+
+/// What a subscriber with [SubscriberOptions.maxInFlight] does with a
+/// sample that arrives while the limit is reached.
+enum OverflowPolicy {
+  /// Drop the arriving sample.
+  dropNewest,
+
+  /// Queue the arriving sample natively, dropping the oldest queued sample
+  /// when the queue (of `maxInFlight` samples) is full.
+  dropOldest,
+
+  /// Stall the zenoh callback until the listener catches up. Slows down
+  /// every subscriber sharing the zenoh runtime thread.
+  block,
+}
+
+/// Predicates evaluated natively in the zenoh callback, before a sample
+/// is converted or posted to Dart.
+///
+/// A sample is delivered only if it passes every configured check.
+/// Rejected samples are dropped without crossing into Dart and counted in
+/// [Subscriber.filteredCount].
+class SampleFilter {
+  /// Minimum payload size in bytes.
+  final int minPayloadLength;
+
+  /// Maximum payload size in bytes, or null for no limit.
+  final int? maxPayloadLength;
+
+  /// Deliver only samples of this kind, or null for both kinds.
+  final SampleKind? kind;
+
+  /// Deliver only samples whose payload starts with these bytes.
+  final List<int>? payloadPrefix;
+
+  /// Deliver only samples with an attachment starting with these bytes.
+  final List<int>? attachmentPrefix;
+
+  /// Drop samples whose key expression intersects any of these.
+  final List<String> excludeKeyExprs;
+
+  /// Creates a sample filter.
+  const SampleFilter({
+    this.minPayloadLength = 0,
+    this.maxPayloadLength,
+    this.kind,
+    this.payloadPrefix,
+    this.attachmentPrefix,
+    this.excludeKeyExprs = const [],
+  });
+}
+
+/// Options for configuring how a subscriber delivers samples.
+class SubscriberOptions {
+  /// Whether to deliver payloads and attachments without copying them.
+  ///
+  /// Contiguous payloads reach Dart as unmodifiable views of the zenoh
+  /// buffer, which is released when the [Sample.payloadBytes] list is
+  /// garbage collected. Worth enabling for large payloads; for small ones
+  /// the finalizer bookkeeping outweighs the copy it saves.
+  final bool zeroCopy;
+
+  /// Whether each sample is posted as one contiguous buffer in the flat
+  /// wire format.
+  ///
+  /// The payload is copied once into that buffer and [Sample] fields are
+  /// sliced out of it on first access, so a sample costs a single Dart
+  /// heap object until inspected. Takes precedence over [zeroCopy].
+  final bool flatWireFormat;
+
+  /// Whether samples are delivered as [LazySample]s backed by a native
+  /// handle.
+  ///
+  /// Only the key expression and kind are sent eagerly; the payload,
+  /// attachment, encoding and timestamp are copied out on first access.
+  /// Suited to consumers that discard most samples by key or kind. Takes
+  /// precedence over [flatWireFormat] and [zeroCopy].
+  final bool lazy;
+
+  /// The optional fields to extract and deliver (default: all but
+  /// [SampleField.metadata]).
+  ///
+  /// The key expression and kind are always delivered. Leaving out
+  /// [SampleField.payload] skips the payload copy entirely while keeping
+  /// [Sample.payloadLength]; left-out attachments and encodings are null.
+  /// Adding [SampleField.metadata] delivers [Sample.metadata] (timestamp,
+  /// source id and sequence number, priority, congestion control and
+  /// express flag) as a packed 56-byte block.
+  /// Suited to presence and activity monitoring of large-payload topics.
+  /// Ignored when [lazy] is set.
+  final Set<SampleField> fields;
+
+  /// Maximum number of distinct key expressions to intern (0 = disabled).
+  ///
+  /// With interning, each key expression string crosses the native port
+  /// and is allocated in Dart once; later samples on the same key carry a
+  /// small integer id and share the same [String]. Keys beyond the limit
+  /// are sent as strings. Suited to subscribers with a stable key space.
+  final int internMaxKeys;
+
+  /// Maximum number of distinct encodings cached natively (0 = disabled).
+  ///
+  /// Cached encodings are matched with `z_encoding_equals` instead of
+  /// being formatted to a string for every sample, and each encoding
+  /// string is sent to Dart once. Encodings beyond the limit are sent as
+  /// strings. Values above [maxEncodingCacheSize] are clamped.
+  final int encodingCacheSize;
+
+  /// Largest effective [encodingCacheSize]; the flat wire format stores
+  /// encoding ids in 16 bits.
+  static const int maxEncodingCacheSize = 65535;
+
+  /// Native filter applied before samples are delivered, or null.
+  final SampleFilter? filter;
+
+  /// Minimum time between two deliveries on the same key expression, or
+  /// null for no rate limit.
+  ///
+  /// The limit is enforced natively per distinct key, so a wildcard
+  /// subscription on a high-rate source costs one port message per key
+  /// and interval. Dropped samples are counted in
+  /// [Subscriber.rateLimitedCount].
+  final Duration? rateLimitInterval;
+
+  /// How samples arriving within [rateLimitInterval] are handled.
+  final RateLimitMode rateLimitMode;
+
+  /// Maximum number of distinct keys the rate limit tracks (0 =
+  /// unbounded).
+  ///
+  /// A new key beyond the limit evicts idle state, preferring keys whose
+  /// interval has elapsed, so an evicted key may deliver early. If every
+  /// tracked key holds a sample, the new key is delivered unlimited.
+  final int rateLimitMaxKeys;
+
+  /// Maximum samples handed to Dart but not yet received by the stream
+  /// listener (0 = unbounded).
+  ///
+  /// Without a limit a slow listener lets the isolate's port queue grow
+  /// without bound. With one, samples count as in flight until the
+  /// listener receives them, and [overflowPolicy] applies once the limit
+  /// is reached. Pausing the stream subscription therefore applies
+  /// backpressure. Ignored by background subscribers.
+  final int maxInFlight;
+
+  /// What to do with samples that arrive while [maxInFlight] is reached.
+  /// Dropped samples are counted in [Subscriber.overflowDroppedCount].
+  final OverflowPolicy overflowPolicy;
+
+  /// Maximum number of samples coalesced into one native port message
+  /// (0 or 1 = no batching).
+  ///
+  /// Batching trades up to [batchMaxDelay] of latency for far fewer port
+  /// messages and event-loop turns at high message rates.
+  final int batchMaxSamples;
+
+  /// Flush a batch once its key, payload and attachment bytes reach this
+  /// size (0 = no byte limit).
+  final int batchMaxBytes;
+
+  /// Maximum time a sample waits in a partial batch before it is flushed.
+  final Duration batchMaxDelay;
+
+  /// Creates subscriber options.
+  const SubscriberOptions({
+    this.zeroCopy = false,
+    this.flatWireFormat = false,
+    this.lazy = false,
+    this.fields = const {
+      SampleField.payload,
+      SampleField.attachment,
+      SampleField.encoding,
+    },
+    this.internMaxKeys = 0,
+    this.encodingCacheSize = 0,
+    this.filter,
+    this.rateLimitInterval,
+    this.rateLimitMode = RateLimitMode.dropNewest,
+    this.rateLimitMaxKeys = 4096,
+    this.maxInFlight = 0,
+    this.overflowPolicy = OverflowPolicy.dropNewest,
+    this.batchMaxSamples = 0,
+    this.batchMaxBytes = 0,
+    this.batchMaxDelay = const Duration(milliseconds: 1),
+  });
+}
+
 /// A zenoh subscriber that receives samples on a key expression.
 ///
 /// Wraps `z_owned_subscriber_t`. Samples are delivered asynchronously
@@ -17,11 +215,22 @@ import 'sample.dart';
 /// and release native resources.
 class Subscriber {
   final Pointer<Void> _ptr;
-  final ReceivePort _receivePort;
   final StreamController<Sample> _controller;
+  final Pointer<zd_subscriber_stats_t> _stats;
+  final Pointer<zd_flow_control_t> _flow;
+  late final Stream<Sample> _stream = _flow == nullptr
+      ? _controller.stream
+      : _controller.stream.map(_received);
+  int _unacknowledged = 0;
   bool _closed = false;
 
-  Subscriber._(this._ptr, this._receivePort, this._controller);
+  Subscriber._(
+    this._ptr,
+    this._controller, [
+    Pointer<zd_subscriber_stats_t>? stats,
+    Pointer<zd_flow_control_t>? flow,
+  ]) : _stats = stats ?? nullptr,
+       _flow = flow ?? nullptr;
 
   /// Sets up a [ReceivePort] and [StreamController] pair that parses
   /// incoming NativePort sample messages into [Sample] objects.
@@ -29,50 +238,216 @@ class Subscriber {
   /// Returns `(ReceivePort, StreamController<Sample>)`. The caller is
   /// responsible for passing `receivePort.sendPort.nativePort` to the
   /// C shim and for cleanup on failure.
+  ///
+  /// The port closes itself on the null message posted when the native
+  /// subscriber is dropped. Samples still queued after the controller was
+  /// closed are discarded, releasing the native sample of lazy ones.
   static (ReceivePort, StreamController<Sample>) createSampleChannel() {
     final receivePort = ReceivePort();
     final controller = StreamController<Sample>();
 
+    // Interned key expressions and cached encodings, indexed by the id
+    // assigned natively.
+    final keys = <String>[];
+    final encodings = <String>[];
+
+    Sample parse(Object element) => element is Uint8List
+        ? Sample.fromWire(element, keys: keys, encodings: encodings)
+        : _parseSample(element as List, keys, encodings);
+
+    void deliver(Object element) {
+      if (!controller.isClosed) {
+        controller.add(parse(element));
+      } else if (element is List && element.length == 3) {
+        // A lazy sample nobody will see: drop its cloned native sample.
+        bindings.zd_sample_drop(Pointer.fromAddress(element[0] as int));
+      }
+    }
+
     receivePort.listen((dynamic message) {
       if (message == null) {
         receivePort.close();
         controller.close();
-      } else if (message is List) {
-        final keyExpr = message[0] as String;
-        final payloadBytes = message[1] as Uint8List;
-        final kind = message[2] as int;
-        final attachmentBytes = message[3] as Uint8List?;
-        final encoding = message.length > 4 ? message[4] as String? : null;
-
-        final sample = Sample(
-          keyExpr: keyExpr,
-          payload: utf8.decode(payloadBytes),
-          payloadBytes: payloadBytes,
-          kind: kind == 0 ? SampleKind.put : SampleKind.delete,
-          attachment: attachmentBytes != null
-              ? utf8.decode(attachmentBytes)
-              : null,
-          encoding: encoding,
-        );
-        controller.add(sample);
+      } else if (message is Uint8List) {
+        deliver(message);
+      } else if (message is List && message.isNotEmpty) {
+        final head = message[0];
+        if (message.length == 3 && head is int && message[2] is String) {
+          // Definition: [0 = keyexpr / 1 = encoding, id, string].
+          final table = head == 0 ? keys : encodings;
+          assert(message[1] == table.length);
+          table.add(message[2] as String);
+        } else if (head is String || head is int) {
+          deliver(message);
+        } else {
+          // Batched post: a list of sample messages.
+          for (final element in message) {
+            deliver(element as Object);
+          }
+        }
       }
     });
 
     return (receivePort, controller);
   }
 
+  /// Parses one `[keyexpr, payload, kind, attachment, encoding]` message,
+  /// or a `[sample_ptr, keyexpr, kind]` message into a [LazySample].
+  ///
+  /// An int in the keyexpr slot is an interned key id resolved in [keys];
+  /// an int in the encoding slot is a cached encoding id resolved in
+  /// [encodings].
+  static Sample _parseSample(
+    List message,
+    List<String> keys,
+    List<String> encodings,
+  ) {
+    if (message.length == 3) {
+      final key = message[1];
+      return LazySample(
+        handle: message[0] as int,
+        keyExpr: key is int ? keys[key] : key as String,
+        kind: (message[2] as int) == 0
+            ? SampleKind.put
+            : SampleKind.delete,
+      );
+    }
+    final key = message[0];
+    final keyExpr = key is int ? keys[key] : key as String;
+    // An int in the payload slot is the length of an unrequested payload.
+    final payloadSlot = message[1];
+    final kind = message[2] as int;
+    final attachmentBytes = message[3] as Uint8List?;
+    final encodingSlot = message.length > 4 ? message[4] : null;
+    final metadataBytes = message.length > 5 ? message[5] as Uint8List : null;
+    final encoding = encodingSlot is int
+        ? encodings[encodingSlot]
+        : encodingSlot as String?;
+
+    return Sample.fromBytes(
+      keyExpr: keyExpr,
+      payloadBytes: payloadSlot is int ? null : payloadSlot as Uint8List,
+      payloadLength: payloadSlot is int ? payloadSlot : null,
+      kind: kind == 0 ? SampleKind.put : SampleKind.delete,
+      attachmentBytes: attachmentBytes,
+      encoding: encoding,
+      metadataBytes: metadataBytes,
+    );
+  }
+
+  /// Allocates a native `zd_subscriber_options_t` mirroring [options].
+  ///
+  /// If [stats] is non-null, samples rejected by [SubscriberOptions.filter]
+  /// are counted there. If [flow] is non-null, it bounds the samples in
+  /// flight. The caller must release the returned pointer with
+  /// [freeNativeOptions].
+  static Pointer<zd_subscriber_options_t> allocateNativeOptions(
+    SubscriberOptions options, {
+    Pointer<zd_subscriber_stats_t>? stats,
+    Pointer<zd_flow_control_t>? flow,
+  }) {
+    final native = calloc<zd_subscriber_options_t>();
+    bindings.zd_subscriber_options_default(native);
+    native.ref.zero_copy = options.zeroCopy;
+    native.ref.flat = options.flatWireFormat;
+    native.ref.lazy = options.lazy;
+    // SampleField indices mirror the ZD_SAMPLE_FIELD_* bit positions.
+    native.ref.fields = options.fields.fold(
+      0,
+      (mask, field) => mask | (1 << field.index),
+    );
+    native.ref.intern_max_keys = options.internMaxKeys;
+    native.ref.encoding_cache_size = options.encodingCacheSize.clamp(
+      0,
+      SubscriberOptions.maxEncodingCacheSize,
+    );
+    native.ref.batch_max_samples = options.batchMaxSamples;
+    native.ref.batch_max_bytes = options.batchMaxBytes;
+    native.ref.batch_max_delay_us = options.batchMaxDelay.inMicroseconds;
+    final filter = options.filter;
+    if (filter != null) {
+      native.ref.filter_min_payload_len = filter.minPayloadLength;
+      if (filter.maxPayloadLength != null) {
+        native.ref.filter_max_payload_len = filter.maxPayloadLength!;
+      }
+      if (filter.kind != null) {
+        native.ref.filter_kind = filter.kind == SampleKind.put ? 0 : 1;
+      }
+      final payloadPrefix = filter.payloadPrefix;
+      if (payloadPrefix != null && payloadPrefix.isNotEmpty) {
+        native.ref.filter_payload_prefix = _allocateBytes(payloadPrefix);
+        native.ref.filter_payload_prefix_len = payloadPrefix.length;
+      }
+      final attachmentPrefix = filter.attachmentPrefix;
+      if (attachmentPrefix != null && attachmentPrefix.isNotEmpty) {
+        native.ref.filter_attachment_prefix = _allocateBytes(attachmentPrefix);
+        native.ref.filter_attachment_prefix_len = attachmentPrefix.length;
+      }
+      final exclude = filter.excludeKeyExprs;
+      if (exclude.isNotEmpty) {
+        final array = calloc<Pointer<Char>>(exclude.length);
+        for (var i = 0; i < exclude.length; i++) {
+          array[i] = exclude[i].toNativeUtf8().cast();
+        }
+        native.ref.filter_exclude_keyexprs = array;
+        native.ref.filter_exclude_keyexprs_len = exclude.length;
+      }
+    }
+    final rateLimitInterval = options.rateLimitInterval;
+    if (rateLimitInterval != null && rateLimitInterval > Duration.zero) {
+      native.ref.rate_limit_interval_us = rateLimitInterval.inMicroseconds;
+      // RateLimitMode indices mirror the ZD_RATE_LIMIT_* values.
+      native.ref.rate_limit_mode = options.rateLimitMode.index;
+      native.ref.rate_limit_max_keys = options.rateLimitMaxKeys;
+    }
+    native.ref.stats = stats ?? nullptr;
+    native.ref.flow_control = flow ?? nullptr;
+    return native;
+  }
+
+  /// Releases options returned by [allocateNativeOptions], including the
+  /// filter buffers they own.
+  ///
+  /// The shim copies everything it keeps, so this is safe to call as soon
+  /// as the subscriber has been declared.
+  static void freeNativeOptions(Pointer<zd_subscriber_options_t> native) {
+    final ref = native.ref;
+    if (ref.filter_payload_prefix != nullptr) {
+      calloc.free(ref.filter_payload_prefix);
+    }
+    if (ref.filter_attachment_prefix != nullptr) {
+      calloc.free(ref.filter_attachment_prefix);
+    }
+    final exclude = ref.filter_exclude_keyexprs;
+    if (exclude != nullptr) {
+      for (var i = 0; i < ref.filter_exclude_keyexprs_len; i++) {
+        malloc.free(exclude[i]);
+      }
+      calloc.free(exclude);
+    }
+    calloc.free(native);
+  }
+
+  static Pointer<Uint8> _allocateBytes(List<int> bytes) {
+    final buf = calloc<Uint8>(bytes.length);
+    buf.asTypedList(bytes.length).setAll(0, bytes);
+    return buf;
+  }
+
   /// Creates a Subscriber from a pre-allocated native handle and a
   /// sample channel pair.
   ///
   /// Used by [Session.declareLivelinessSubscriber] where the native
   /// subscriber is declared through a different C shim function but
-  /// uses the same `z_owned_subscriber_t` type.
+  /// uses the same `z_owned_subscriber_t` type. [receivePort] must come
+  /// from [createSampleChannel]; it closes itself once the native
+  /// subscriber is dropped.
   factory Subscriber.fromParts(
     Pointer<Void> ptr,
     ReceivePort receivePort,
     StreamController<Sample> controller,
   ) {
-    return Subscriber._(ptr, receivePort, controller);
+    return Subscriber._(ptr, controller);
   }
 
   /// Creates a subscriber on the given session and key expression.
@@ -80,32 +455,105 @@ class Subscriber {
   /// This is called internally by [Session.declareSubscriber].
   static Subscriber declare(
     Pointer<Void> loanedSession,
-    Pointer<Void> loanedKe,
-  ) {
+    Pointer<Void> loanedKe, {
+    SubscriberOptions options = const SubscriberOptions(),
+  }) {
     final size = bindings.zd_subscriber_sizeof();
     final Pointer<Void> ptr = calloc.allocate(size);
 
     final (receivePort, controller) = createSampleChannel();
 
-    final rc = bindings.zd_declare_subscriber(
-      loanedSession.cast(),
-      ptr.cast(),
-      loanedKe.cast(),
-      receivePort.sendPort.nativePort,
+    final stats = bindings.zd_subscriber_stats_new();
+    if (stats == nullptr) {
+      receivePort.close();
+      controller.close();
+      calloc.free(ptr);
+      throw ZenohException('Failed to allocate subscriber stats', -1);
+    }
+    final Pointer<zd_flow_control_t> flow = options.maxInFlight > 0
+        ? bindings.zd_flow_control_new(
+            options.maxInFlight,
+            // OverflowPolicy indices mirror the ZD_OVERFLOW_* values.
+            options.overflowPolicy.index,
+          )
+        : nullptr;
+    final nativeOptions = allocateNativeOptions(
+      options,
+      stats: stats,
+      flow: flow,
     );
+    final int rc;
+    try {
+      rc = bindings.zd_declare_subscriber(
+        loanedSession.cast(),
+        ptr.cast(),
+        loanedKe.cast(),
+        receivePort.sendPort.nativePort,
+        nativeOptions,
+      );
+    } finally {
+      freeNativeOptions(nativeOptions);
+    }
 
     if (rc != 0) {
       receivePort.close();
       controller.close();
+      bindings.zd_subscriber_stats_free(stats);
+      if (flow != nullptr) bindings.zd_flow_control_free(flow);
       calloc.free(ptr);
       throw ZenohException('Failed to declare subscriber', rc);
     }
 
-    return Subscriber._(ptr, receivePort, controller);
+    return Subscriber._(ptr, controller, stats, flow);
   }
 
   /// A stream of [Sample]s received by this subscriber.
-  Stream<Sample> get stream => _controller.stream;
+  Stream<Sample> get stream => _stream;
+
+  /// Counts a sample as received by the listener and acknowledges the
+  /// received samples once per microtask.
+  Sample _received(Sample sample) {
+    if (_unacknowledged++ == 0) scheduleMicrotask(_acknowledge);
+    return sample;
+  }
+
+  void _acknowledge() {
+    if (!_closed) bindings.zd_flow_control_ack(_flow, _unacknowledged);
+    _unacknowledged = 0;
+  }
+
+  /// The number of samples dropped by [SubscriberOptions.filter].
+  ///
+  /// Always 0 for subscribers without native statistics, such as
+  /// liveliness subscribers.
+  ///
+  /// Throws [StateError] if the subscriber has been closed.
+  int get filteredCount {
+    if (_closed) throw StateError('Subscriber is closed');
+    if (_stats == nullptr) return 0;
+    return _stats.ref.filtered;
+  }
+
+  /// The number of samples dropped or replaced by
+  /// [SubscriberOptions.rateLimitInterval].
+  ///
+  /// Throws [StateError] if the subscriber has been closed.
+  int get rateLimitedCount {
+    if (_closed) throw StateError('Subscriber is closed');
+    if (_stats == nullptr) return 0;
+    return _stats.ref.rate_limited;
+  }
+
+  /// The number of samples dropped by [SubscriberOptions.overflowPolicy].
+  ///
+  /// Always 0 for subscribers without [SubscriberOptions.maxInFlight].
+  ///
+  /// Throws [StateError] if the subscriber has been closed.
+  int get overflowDroppedCount {
+    if (_closed) throw StateError('Subscriber is closed');
+    if (_flow == nullptr) return 0;
+    return bindings.zd_flow_control_dropped(_flow);
+  }
 
   /// Undeclares the subscriber and releases native resources.
   ///
@@ -113,9 +561,16 @@ class Subscriber {
   void close() {
     if (_closed) return;
     _closed = true;
+    // Wake callbacks blocked on the flow control before undeclaring.
+    if (_flow != nullptr) bindings.zd_flow_control_close(_flow);
     bindings.zd_subscriber_drop(_ptr.cast());
-    _receivePort.close();
+    // The receive port stays open until the drop's null message so that
+    // queued lazy samples are released rather than leaked.
     _controller.close();
     calloc.free(_ptr);
+    // Callbacks still running keep the counters and the flow control alive
+    // through the context until the drop has run.
+    if (_stats != nullptr) bindings.zd_subscriber_stats_free(_stats);
+    if (_flow != nullptr) bindings.zd_flow_control_free(_flow);
   }
 }
@@ -3,9 +3,12 @@ library;
 
 export 'src/advanced_publisher.dart';
 export 'src/advanced_subscriber.dart';
+export 'src/aggregating_subscriber.dart';
+export 'src/buffer_pool.dart';
 export 'src/bytes.dart';
 export 'src/bytes_writer.dart';
 export 'src/config.dart';
+export 'src/conflating_subscriber.dart';
 export 'src/deserializer.dart';
 export 'src/congestion_control.dart';
 export 'src/consolidation_mode.dart';
@@ -14,6 +17,7 @@ export 'src/exceptions.dart';
 export 'src/hello.dart';
 export 'src/id.dart';
 export 'src/keyexpr.dart';
+export 'src/lazy_sample.dart';
 export 'src/liveliness.dart';
 export 'src/priority.dart';
 export 'src/pull_subscriber.dart';
@@ -23,9 +27,11 @@ export 'src/query.dart';
 export 'src/query_target.dart';
 export 'src/queryable.dart';
 export 'src/reply.dart';
+export 'src/ring_subscriber.dart';
 export 'src/sample.dart';
 export 'src/serializer.dart';
 export 'src/session.dart';
+export 'src/sharded_subscriber.dart';
 export 'src/shm_mut_buffer.dart';
 export 'src/shm_provider.dart';
 export 'src/subscriber.dart';
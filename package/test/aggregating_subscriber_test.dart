@@ -0,0 +1,184 @@
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:test/test.dart';
+import 'package:zenoh/zenoh.dart';
+
+void main() {
+  group('AggregatingSubscriber lifecycle', () {
+    late Session session;
+
+    setUpAll(() {
+      session = Session.open();
+    });
+
+    tearDownAll(() {
+      session.close();
+    });
+
+    test('declareAggregatingSubscriber returns an AggregatingSubscriber', () {
+      final sub = session.declareAggregatingSubscriber('demo/example/agg');
+      expect(sub, isA<AggregatingSubscriber>());
+      expect(sub.undecodableCount, equals(0));
+      sub.close();
+    });
+
+    test('AggregatingSubscriber.close is idempotent', () {
+      final sub = session.declareAggregatingSubscriber(
+        'demo/example/agg/idempotent',
+      );
+      sub.close();
+      expect(() => sub.close(), returnsNormally);
+    });
+
+    test('undecodableCount on closed subscriber throws StateError', () {
+      final sub = session.declareAggregatingSubscriber(
+        'demo/example/agg/closed',
+      );
+      sub.close();
+      expect(() => sub.undecodableCount, throwsA(isA<StateError>()));
+    });
+
+    test('a slide that does not divide the window throws', () {
+      expect(
+        () => session.declareAggregatingSubscriber(
+          'demo/example/agg/slide',
+          options: const AggregationOptions(
+            window: Duration(seconds: 1),
+            slide: Duration(milliseconds: 300),
+          ),
+        ),
+        throwsA(isA<ZenohException>()),
+      );
+    });
+
+    test('a non-positive window throws ArgumentError', () {
+      expect(
+        () => session.declareAggregatingSubscriber(
+          'demo/example/agg/negative',
+          options: const AggregationOptions(window: Duration(seconds: -1)),
+        ),
+        throwsA(isA<ArgumentError>()),
+      );
+    });
+
+    test('windows longer than 32 bits of microseconds are accepted', () {
+      final sub = session.declareAggregatingSubscriber(
+        'demo/example/agg/long',
+        options: const AggregationOptions(
+          window: Duration(hours: 2),
+          slide: Duration(hours: 1),
+        ),
+      );
+      expect(sub, isA<AggregatingSubscriber>());
+      sub.close();
+    });
+  });
+
+  group('Aggregating subscriber delivery (TCP 17542)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17542"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17542"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    ZBytes rawFloat64(double value) {
+      final data = ByteData(8)..setFloat64(0, value, Endian.little);
+      return ZBytes.fromUint8List(data.buffer.asUint8List());
+    }
+
+    test('aggregates raw float64 payloads per window', () async {
+      final sub = session2.declareAggregatingSubscriber(
+        'zenoh/dart/test/agg-raw',
+        options: const AggregationOptions(
+          window: Duration(milliseconds: 500),
+        ),
+      );
+      addTearDown(sub.close);
+      final aggregates = <WindowAggregate>[];
+      sub.stream.listen(aggregates.add);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (final value in [1.0, 2.0, 6.0]) {
+        session1.putBytes('zenoh/dart/test/agg-raw', rawFloat64(value));
+      }
+      await Future<void>.delayed(const Duration(milliseconds: 1500));
+
+      // The burst may straddle a window close; combine what arrived.
+      expect(aggregates, isNotEmpty);
+      expect(aggregates.map((a) => a.count).reduce((a, b) => a + b), 3);
+      expect(aggregates.map((a) => a.min).reduce((a, b) => a < b ? a : b), 1.0);
+      expect(aggregates.map((a) => a.max).reduce((a, b) => a > b ? a : b), 6.0);
+      expect(aggregates.first.keyExpr, equals('zenoh/dart/test/agg-raw'));
+      if (aggregates.length == 1) {
+        expect(aggregates.single.mean, equals(3.0));
+      }
+    });
+
+    test('decodes serialized int64 and counts undecodable payloads', () async {
+      final sub = session2.declareAggregatingSubscriber(
+        'zenoh/dart/test/agg-int/*',
+        options: const AggregationOptions(
+          valueType: AggregateValueType.int64,
+          serialized: true,
+          window: Duration(milliseconds: 500),
+        ),
+      );
+      addTearDown(sub.close);
+      final aggregates = <WindowAggregate>[];
+      sub.stream.listen(aggregates.add);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.putBytes('zenoh/dart/test/agg-int/a', ZBytes.fromInt(-5));
+      session1.putBytes('zenoh/dart/test/agg-int/b', ZBytes.fromInt(7));
+      session1.put('zenoh/dart/test/agg-int/a', 'not a number');
+      await Future<void>.delayed(const Duration(milliseconds: 1500));
+
+      final byKey = {for (final a in aggregates) a.keyExpr: a};
+      expect(byKey['zenoh/dart/test/agg-int/a']!.min, equals(-5));
+      expect(byKey['zenoh/dart/test/agg-int/a']!.min, isA<int>());
+      expect(byKey['zenoh/dart/test/agg-int/b']!.max, equals(7));
+      expect(sub.undecodableCount, equals(1));
+    });
+
+    test('a sample appears in every overlapping sliding window', () async {
+      final sub = session2.declareAggregatingSubscriber(
+        'zenoh/dart/test/agg-slide',
+        options: const AggregationOptions(
+          window: Duration(milliseconds: 800),
+          slide: Duration(milliseconds: 200),
+        ),
+      );
+      addTearDown(sub.close);
+      final aggregates = <WindowAggregate>[];
+      sub.stream.listen(aggregates.add);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.putBytes('zenoh/dart/test/agg-slide', rawFloat64(4.0));
+      await Future<void>.delayed(const Duration(milliseconds: 1500));
+
+      // An 800 ms window sliding by 200 ms contains the sample 4 times.
+      expect(aggregates, hasLength(4));
+      expect(aggregates.every((a) => a.count == 1 && a.mean == 4.0), isTrue);
+    });
+  });
+}
@@ -0,0 +1,126 @@
+import 'dart:async';
+
+import 'package:test/test.dart';
+import 'package:zenoh/zenoh.dart';
+
+void main() {
+  group('ConflatingSubscriber lifecycle', () {
+    late Session session;
+
+    setUpAll(() {
+      session = Session.open();
+    });
+
+    tearDownAll(() {
+      session.close();
+    });
+
+    test('declareConflatingSubscriber returns a ConflatingSubscriber', () {
+      final sub = session.declareConflatingSubscriber('demo/example/latest');
+      expect(sub, isA<ConflatingSubscriber>());
+      expect(sub.conflatedCount, equals(0));
+      sub.close();
+    });
+
+    test('ConflatingSubscriber.close is idempotent', () {
+      final sub = session.declareConflatingSubscriber(
+        'demo/example/latest/idempotent',
+      );
+      sub.close();
+      expect(() => sub.close(), returnsNormally);
+    });
+
+    test('conflatedCount on closed subscriber throws StateError', () {
+      final sub = session.declareConflatingSubscriber(
+        'demo/example/latest/closed',
+      );
+      sub.close();
+      expect(() => sub.conflatedCount, throwsA(isA<StateError>()));
+    });
+  });
+
+  group('Conflating subscriber delivery (TCP 17540)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17540"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17540"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('delivers key, payload, kind, attachment and encoding', () async {
+      final sub = session2.declareConflatingSubscriber(
+        'zenoh/dart/test/latest-fields',
+      );
+      addTearDown(sub.close);
+      final publisher = session1.declarePublisher(
+        'zenoh/dart/test/latest-fields',
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      publisher.put(
+        'state',
+        encoding: Encoding.textPlain,
+        attachment: ZBytes.fromString('meta'),
+      );
+
+      final sample = await sub.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+
+      expect(sample.keyExpr, equals('zenoh/dart/test/latest-fields'));
+      expect(sample.kind, equals(SampleKind.put));
+      expect(sample.payload, equals('state'));
+      expect(sample.attachment, equals('meta'));
+      expect(sample.encoding, equals('text/plain'));
+    });
+
+    test('a burst ends with the newest value of every key', () async {
+      final sub = session2.declareConflatingSubscriber(
+        'zenoh/dart/test/latest-burst/*',
+      );
+      addTearDown(sub.close);
+      final latest = <String, String>{};
+      var delivered = 0;
+      sub.stream.listen((s) {
+        latest[s.keyExpr] = s.payload;
+        delivered++;
+      });
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      // Publish synchronously so the isolate cannot take between puts.
+      for (var i = 0; i < 200; i++) {
+        session1.put('zenoh/dart/test/latest-burst/a', 'a$i');
+        session1.put('zenoh/dart/test/latest-burst/b', 'b$i');
+      }
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      expect(
+        latest,
+        equals({
+          'zenoh/dart/test/latest-burst/a': 'a199',
+          'zenoh/dart/test/latest-burst/b': 'b199',
+        }),
+      );
+      expect(delivered + sub.conflatedCount, equals(400));
+      expect(sub.conflatedCount, greaterThan(0));
+    });
+  });
+}
@@ -40,6 +40,22 @@ void main() {
       const b = Encoding('text/plain');
       expect(a, equals(b));
     });
+
+    test('compile returns a CompiledEncoding equal to the original', () {
+      final compiled = Encoding.applicationJson.compile();
+      addTearDown(compiled.dispose);
+      expect(compiled, isA<CompiledEncoding>());
+      expect(compiled.mimeType, equals('application/json'));
+      expect(compiled, equals(Encoding.applicationJson));
+      expect(compiled.compile(), same(compiled));
+    });
+
+    test('CompiledEncoding.dispose is idempotent', () {
+      final compiled = Encoding('application/x-custom;v=1').compile();
+      compiled.dispose();
+      expect(compiled.dispose, returnsNormally);
+      expect(() => compiled.nativePtr, throwsA(isA<StateError>()));
+    });
   });
 
   group('CongestionControl', () {
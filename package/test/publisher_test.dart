@@ -1,4 +1,6 @@
 import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
 
 import 'package:test/test.dart';
 import 'package:zenoh/zenoh.dart';
@@ -114,6 +116,82 @@ void main() {
       expect(() => attachment.nativePtr, throwsA(isA<StateError>()));
     });
 
+    test('Publisher.putBatch publishes payloads without error', () {
+      final publisher = session.declarePublisher('demo/example/pub-batch');
+      addTearDown(publisher.close);
+      expect(
+        () => publisher.putBatch(
+          [
+            Uint8List.fromList([1, 2, 3]),
+            Uint8List(0),
+          ],
+          attachments: [null, Uint8List.fromList([4])],
+          encoding: Encoding.applicationOctetStream,
+        ),
+        returnsNormally,
+      );
+      expect(() => publisher.putBatch([]), returnsNormally);
+    });
+
+    test('Publisher.putBatch with mismatched attachments throws', () {
+      final publisher = session.declarePublisher('demo/example/pub-batch2');
+      addTearDown(publisher.close);
+      expect(
+        () => publisher.putBatch([Uint8List(1)], attachments: []),
+        throwsA(isA<ArgumentError>()),
+      );
+    });
+
+    test('Publisher.benchmark publishes exactly count messages', () async {
+      final publisher = session.declarePublisher('demo/example/pub-bench');
+      addTearDown(publisher.close);
+      final result = await publisher.benchmark(64, count: 1000);
+      expect(result.messages, equals(1000));
+      expect(result.bytes, equals(64000));
+      expect(result.messagesPerSecond, greaterThan(0));
+    });
+
+    test('Publisher.benchmark stops once duration has elapsed', () async {
+      final publisher = session.declarePublisher('demo/example/pub-bench2');
+      addTearDown(publisher.close);
+      const duration = Duration(milliseconds: 200);
+      final result = await publisher.benchmark(8, duration: duration);
+      expect(result.messages, greaterThan(0));
+      expect(result.elapsed, greaterThanOrEqualTo(duration));
+    });
+
+    test('Publisher.benchmark without a limit throws ArgumentError', () {
+      final publisher = session.declarePublisher('demo/example/pub-bench3');
+      addTearDown(publisher.close);
+      expect(publisher.benchmark(8), throwsA(isA<ArgumentError>()));
+    });
+
+    test('Publisher.close during benchmark waits for it to finish', () async {
+      final publisher = session.declarePublisher('demo/example/pub-bench4');
+      final running = publisher.benchmark(
+        8,
+        duration: const Duration(milliseconds: 200),
+      );
+      publisher.close();
+      expect(() => publisher.put('test'), throwsA(isA<StateError>()));
+      final result = await running;
+      expect(result.messages, greaterThan(0));
+    });
+
+    test('Publisher has no shmProvider unless one is attached', () {
+      final publisher = session.declarePublisher('demo/example/pub-shm');
+      addTearDown(publisher.close);
+      expect(publisher.shmProvider, isNull);
+      expect(publisher.shmThreshold, equals(Publisher.defaultShmThreshold));
+      expect(
+        () => session.declarePublisher(
+          'demo/example/pub-shm2',
+          shmThreshold: -1,
+        ),
+        throwsRangeError,
+      );
+    });
+
     test('Publisher.put after close throws StateError', () {
       final publisher = session.declarePublisher('demo/example/pub-closed');
       publisher.close();
@@ -129,6 +207,10 @@ void main() {
         () => publisher.putBytes(ZBytes.fromString('test')),
         throwsA(isA<StateError>()),
       );
+      expect(
+        () => publisher.putBatch([Uint8List(1)]),
+        throwsA(isA<StateError>()),
+      );
       expect(() => publisher.deleteResource(), throwsA(isA<StateError>()));
       expect(() => publisher.keyExpr, throwsA(isA<StateError>()));
       expect(
@@ -229,6 +311,87 @@ void main() {
       expect(sample.attachment, equals('meta'));
     });
 
+    test('Publisher.putBatch messages received in order', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/pub-batch',
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher('zenoh/dart/test/pub-batch');
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(20).toList();
+      publisher.putBatch(
+        [for (var i = 0; i < 20; i++) utf8.encode('msg-$i')],
+        attachments: [
+          for (var i = 0; i < 20; i++) i.isEven ? null : utf8.encode('att-$i'),
+        ],
+        encoding: Encoding.textPlain,
+      );
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(
+        samples.map((s) => s.payload),
+        equals([for (var i = 0; i < 20; i++) 'msg-$i']),
+      );
+      expect(
+        samples.map((s) => s.attachment),
+        equals([for (var i = 0; i < 20; i++) i.isEven ? null : 'att-$i']),
+      );
+      expect(samples.first.encoding, contains('text/plain'));
+    });
+
+    test('Publisher.benchmark messages received by subscriber', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/pub-bench',
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher('zenoh/dart/test/pub-bench');
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(100).toList();
+      final result = await publisher.benchmark(16, count: 100);
+      expect(result.messages, equals(100));
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(samples, hasLength(100));
+      expect(
+        samples.first.payloadBytes,
+        equals([for (var i = 0; i < 16; i++) i % 10]),
+      );
+    });
+
+    test('Publisher.put with a CompiledEncoding received with it', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/pub-cenc',
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher('zenoh/dart/test/pub-cenc');
+      addTearDown(publisher.close);
+      final encoding = Encoding.applicationJson.compile();
+      addTearDown(encoding.dispose);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(3).toList();
+      publisher.put('{"n":1}', encoding: encoding);
+      publisher.putBytes(ZBytes.fromString('{"n":2}'), encoding: encoding);
+      publisher.putBatch([utf8.encode('{"n":3}')], encoding: encoding);
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      for (final sample in samples) {
+        expect(sample.encoding, contains('application/json'));
+      }
+      expect(samples.map((s) => s.payload), [
+        '{"n":1}',
+        '{"n":2}',
+        '{"n":3}',
+      ]);
+    });
+
     test(
       'Publisher.put with encoding received by subscriber with encoding',
       () async {
@@ -1,4 +1,5 @@
 import 'dart:async';
+import 'dart:typed_data';
 
 import 'package:test/test.dart';
 import 'package:zenoh/zenoh.dart';
@@ -27,6 +28,20 @@ void main() {
       pullSub.close();
     });
 
+    test('PullSubscriber.channel returns declared channel kind', () {
+      final ring = session.declarePullSubscriber('demo/example/pull/ring');
+      addTearDown(ring.close);
+      final fifo = session.declarePullSubscriber(
+        'demo/example/pull/fifo',
+        channel: PullChannel.fifo,
+      );
+      addTearDown(fifo.close);
+
+      expect(ring.channel, equals(PullChannel.ring));
+      expect(fifo.channel, equals(PullChannel.fifo));
+      expect(fifo.tryRecv(), isNull);
+    });
+
     test('tryRecv returns null when buffer is empty', () {
       final pullSub = session.declarePullSubscriber('demo/example/pull/empty');
       addTearDown(pullSub.close);
@@ -48,6 +63,54 @@ void main() {
       pullSub.close();
       expect(() => pullSub.tryRecv(), throwsA(isA<StateError>()));
     });
+
+    test('tryRecvBatch returns an empty list when buffer is empty', () {
+      final pullSub = session.declarePullSubscriber(
+        'demo/example/pull/batch-empty',
+      );
+      addTearDown(pullSub.close);
+
+      expect(pullSub.tryRecvBatch(), isEmpty);
+    });
+
+    test('tryRecvBatch on closed PullSubscriber throws StateError', () {
+      final pullSub = session.declarePullSubscriber(
+        'demo/example/pull/batch-closed',
+      );
+      pullSub.close();
+      expect(() => pullSub.tryRecvBatch(), throwsA(isA<StateError>()));
+    });
+
+    test('recv returns null after the timeout when buffer is empty', () {
+      final pullSub = session.declarePullSubscriber(
+        'demo/example/pull/recv-timeout',
+      );
+      addTearDown(pullSub.close);
+
+      final stopwatch = Stopwatch()..start();
+      final sample = pullSub.recv(timeout: const Duration(milliseconds: 200));
+      expect(sample, isNull);
+      expect(stopwatch.elapsedMilliseconds, greaterThanOrEqualTo(150));
+    });
+
+    test('recv and next on closed PullSubscriber throw StateError', () {
+      final pullSub = session.declarePullSubscriber(
+        'demo/example/pull/wait-closed',
+      );
+      pullSub.close();
+      expect(() => pullSub.recv(), throwsA(isA<StateError>()));
+      expect(pullSub.next, throwsA(isA<StateError>()));
+    });
+
+    test('pending next completes with null on close', () async {
+      final pullSub = session.declarePullSubscriber(
+        'demo/example/pull/next-close',
+      );
+      final pending = pullSub.next();
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+      pullSub.close();
+      expect(await pending.timeout(const Duration(seconds: 5)), isNull);
+    });
   });
 
   group('Ring buffer lossy behavior (TCP 17481)', () {
@@ -154,6 +217,111 @@ void main() {
     });
   });
 
+  group('FIFO buffer lossless behavior (TCP 17545)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17545"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17545"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('FIFO buffer keeps every sample beyond capacity, in order', () async {
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/fifo',
+        capacity: 3,
+        channel: PullChannel.fifo,
+      );
+      addTearDown(pullSub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      // Publish 10 messages rapidly: delivery stalls once 3 are buffered
+      for (var i = 0; i < 10; i++) {
+        session1.put('zenoh/dart/test/pull/fifo', 'msg-$i');
+      }
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      // Draining makes room, which lets the stalled samples through
+      final samples = <Sample>[];
+      while (samples.length < 10) {
+        final s = pullSub.recv(timeout: const Duration(seconds: 2));
+        if (s == null) break;
+        samples.add(s);
+      }
+
+      expect(
+        samples.map((s) => s.payload),
+        equals([for (var i = 0; i < 10; i++) 'msg-$i']),
+      );
+    });
+
+    test('tryRecvBatch drains a FIFO buffer', () async {
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/fifo-batch',
+        channel: PullChannel.fifo,
+      );
+      addTearDown(pullSub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 5; i++) {
+        session1.put('zenoh/dart/test/pull/fifo-batch', 'msg-$i');
+      }
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final samples = pullSub.tryRecvBatch();
+      expect(
+        samples.map((s) => s.payload),
+        equals([for (var i = 0; i < 5; i++) 'msg-$i']),
+      );
+    });
+
+    test('close releases a full FIFO buffer', () async {
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/fifo-full',
+        capacity: 1,
+        channel: PullChannel.fifo,
+      );
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 5; i++) {
+        session1.put('zenoh/dart/test/pull/fifo-full', 'msg-$i');
+      }
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      pullSub.close();
+
+      // Delivery resumes for other subscribers once the stall is released
+      final other = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/fifo-after',
+      );
+      addTearDown(other.close);
+      await Future<void>.delayed(const Duration(seconds: 1));
+      session1.put('zenoh/dart/test/pull/fifo-after', 'resumed');
+      final sample = other.recv(timeout: const Duration(seconds: 5));
+      expect(sample?.payload, equals('resumed'));
+    });
+  });
+
   group('Lifecycle and error handling (TCP 17482)', () {
     late Session session1;
     late Session session2;
@@ -326,6 +494,79 @@ void main() {
       expect(sample.encoding, isNotNull);
     });
 
+    test('binary payload and attachment are received intact', () async {
+      final publisher = session1.declarePublisher('zenoh/dart/test/pull/bin');
+      addTearDown(publisher.close);
+
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/bin',
+      );
+      addTearDown(pullSub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      // Not valid UTF-8, and large enough to span several buffers
+      final payload = Uint8List.fromList(
+        List.generate(200000, (i) => (i * 7 + 0x80) & 0xff),
+      );
+      publisher.putBytes(
+        ZBytes.fromUint8List(payload),
+        attachment: ZBytes.fromString('frame-meta'),
+      );
+
+      final sample = pullSub.recv(timeout: const Duration(seconds: 5));
+      expect(sample, isNotNull);
+      expect(sample!.payloadBytes, equals(payload));
+      expect(sample.attachment, equals('frame-meta'));
+    });
+
+    test('tryRecv tracks changing keys, encodings and payload sizes', () async {
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/reuse/*',
+      );
+      addTearDown(pullSub.close);
+
+      final pubA = session1.declarePublisher(
+        'zenoh/dart/test/pull/reuse/a',
+        encoding: Encoding.textPlain,
+      );
+      addTearDown(pubA.close);
+      final pubB = session1.declarePublisher(
+        'zenoh/dart/test/pull/reuse/b',
+        encoding: Encoding.applicationJson,
+      );
+      addTearDown(pubB.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final large = 'x' * 1000;
+      pubA.put('a1');
+      pubA.put('a2', attachment: ZBytes.fromString('att'));
+      pubB.put(large);
+      pubA.put('a3');
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final samples = <Sample>[];
+      for (var i = 0; i < 4; i++) {
+        final s = pullSub.tryRecv();
+        if (s == null) break;
+        samples.add(s);
+      }
+
+      expect(samples.map((s) => s.keyExpr), [
+        'zenoh/dart/test/pull/reuse/a',
+        'zenoh/dart/test/pull/reuse/a',
+        'zenoh/dart/test/pull/reuse/b',
+        'zenoh/dart/test/pull/reuse/a',
+      ]);
+      expect(samples.map((s) => s.payload), ['a1', 'a2', large, 'a3']);
+      expect(samples.map((s) => s.attachment), [null, 'att', null, null]);
+      expect(samples[0].encoding, equals(samples[1].encoding));
+      expect(samples[2].encoding, isNot(equals(samples[0].encoding)));
+      expect(samples[3].encoding, equals(samples[0].encoding));
+    });
+
     test('multiple tryRecv drains buffer', () async {
       final pullSub = session2.declarePullSubscriber(
         'zenoh/dart/test/pull/multi',
@@ -355,5 +596,90 @@ void main() {
       // 4th tryRecv should return null
       expect(pullSub.tryRecv(), isNull);
     });
+
+    test('tryRecvBatch drains up to maxSamples in order', () async {
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/batch',
+      );
+      addTearDown(pullSub.close);
+      final publisher = session1.declarePublisher(
+        'zenoh/dart/test/pull/batch',
+        encoding: Encoding.textPlain,
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 5; i++) {
+        publisher.put('msg$i', attachment: ZBytes.fromString('att$i'));
+      }
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final first = pullSub.tryRecvBatch(maxSamples: 3);
+      expect(first.map((s) => s.payload), equals(['msg0', 'msg1', 'msg2']));
+      expect(first[0].keyExpr, equals('zenoh/dart/test/pull/batch'));
+      expect(first[0].encoding, equals('text/plain'));
+      expect(first[0].attachment, equals('att0'));
+
+      final rest = pullSub.tryRecvBatch(maxSamples: 3);
+      expect(rest.map((s) => s.payload), equals(['msg3', 'msg4']));
+      expect(pullSub.tryRecvBatch(), isEmpty);
+    });
+
+    test('tryRecvBatch returns a sample larger than the arena', () async {
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/batch-big',
+      );
+      addTearDown(pullSub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final big = 'x' * 1000;
+      session1.put('zenoh/dart/test/pull/batch-big', 'small');
+      session1.put('zenoh/dart/test/pull/batch-big', big);
+      session1.put('zenoh/dart/test/pull/batch-big', 'after');
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final samples = <Sample>[];
+      for (var i = 0; i < 4; i++) {
+        final batch = pullSub.tryRecvBatch(arenaSize: 256);
+        if (batch.isEmpty) break;
+        samples.addAll(batch);
+      }
+      expect(samples.map((s) => s.payload), equals(['small', big, 'after']));
+    });
+
+    test('next completes when a sample arrives', () async {
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/next',
+      );
+      addTearDown(pullSub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final pending = pullSub.next();
+      await Future<void>.delayed(const Duration(milliseconds: 200));
+      session1.put('zenoh/dart/test/pull/next', 'woken');
+
+      final sample = await pending.timeout(const Duration(seconds: 5));
+      expect(sample, isNotNull);
+      expect(sample!.payload, equals('woken'));
+    });
+
+    test('recv blocks until a sample arrives', () async {
+      final pullSub = session2.declarePullSubscriber(
+        'zenoh/dart/test/pull/recv',
+      );
+      addTearDown(pullSub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.put('zenoh/dart/test/pull/recv', 'blocking');
+      final sample = pullSub.recv(timeout: const Duration(seconds: 5));
+      expect(sample, isNotNull);
+      expect(sample!.payload, equals('blocking'));
+    });
   });
 }
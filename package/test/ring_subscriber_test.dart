@@ -0,0 +1,142 @@
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:test/test.dart';
+import 'package:zenoh/zenoh.dart';
+
+void main() {
+  group('RingSubscriber lifecycle', () {
+    late Session session;
+
+    setUpAll(() {
+      session = Session.open();
+    });
+
+    tearDownAll(() {
+      session.close();
+    });
+
+    test('declareRingSubscriber returns a RingSubscriber', () {
+      final ringSub = session.declareRingSubscriber('demo/example/ring');
+      expect(ringSub, isA<RingSubscriber>());
+      expect(ringSub.droppedCount, equals(0));
+      ringSub.close();
+    });
+
+    test('RingSubscriber.close is idempotent', () {
+      final ringSub = session.declareRingSubscriber(
+        'demo/example/ring/idempotent',
+      );
+      ringSub.close();
+      expect(() => ringSub.close(), returnsNormally);
+    });
+
+    test('droppedCount on closed RingSubscriber throws StateError', () {
+      final ringSub = session.declareRingSubscriber(
+        'demo/example/ring/closed',
+      );
+      ringSub.close();
+      expect(() => ringSub.droppedCount, throwsA(isA<StateError>()));
+    });
+  });
+
+  group('Ring subscriber delivery (TCP 17536)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17536"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17536"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('delivers key, payload, kind, attachment and encoding', () async {
+      final ringSub = session2.declareRingSubscriber(
+        'zenoh/dart/test/ring-fields',
+      );
+      addTearDown(ringSub.close);
+      final publisher = session1.declarePublisher(
+        'zenoh/dart/test/ring-fields',
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      publisher.put(
+        'ring',
+        encoding: Encoding.textPlain,
+        attachment: ZBytes.fromString('meta'),
+      );
+
+      final sample = await ringSub.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+
+      expect(sample.keyExpr, equals('zenoh/dart/test/ring-fields'));
+      expect(sample.kind, equals(SampleKind.put));
+      expect(sample.payload, equals('ring'));
+      expect(sample.attachment, equals('meta'));
+      expect(sample.encoding, equals('text/plain'));
+    });
+
+    test('delivers a burst in order across ring wrap-around', () async {
+      // A 4 KiB ring wraps many times over 500 samples.
+      final ringSub = session2.declareRingSubscriber(
+        'zenoh/dart/test/ring-burst',
+        capacity: 4096,
+      );
+      addTearDown(ringSub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = ringSub.stream.take(500).toList();
+      for (var i = 0; i < 500; i++) {
+        session1.put('zenoh/dart/test/ring-burst', 'ring-$i');
+        if (i % 50 == 49) {
+          // Let the isolate drain so the small ring does not overflow.
+          await Future<void>.delayed(const Duration(milliseconds: 20));
+        }
+      }
+
+      final samples = await received.timeout(const Duration(seconds: 10));
+      expect(
+        samples.map((s) => s.payload),
+        equals(List<String>.generate(500, (i) => 'ring-$i')),
+      );
+    });
+
+    test('drops and counts samples that do not fit the ring', () async {
+      final ringSub = session2.declareRingSubscriber(
+        'zenoh/dart/test/ring-drop',
+        capacity: 256,
+      );
+      addTearDown(ringSub.close);
+      final publisher = session1.declarePublisher('zenoh/dart/test/ring-drop');
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      publisher.putBytes(ZBytes.fromUint8List(Uint8List(1024)));
+      publisher.put('fits');
+
+      final sample = await ringSub.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+      expect(sample.payload, equals('fits'));
+      expect(ringSub.droppedCount, equals(1));
+    });
+  });
+}
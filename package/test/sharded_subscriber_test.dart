@@ -0,0 +1,227 @@
+import 'dart:async';
+import 'dart:isolate';
+
+import 'package:test/test.dart';
+import 'package:zenoh/zenoh.dart';
+
+/// Returns a shard worker that forwards every sample it receives to
+/// [results] as `[shard id, keyExpr, payload]`, then `'done'` once its
+/// stream completes.
+ShardWorker _forwardTo(SendPort results) => (samples) {
+  final shard = identityHashCode(samples);
+  samples.listen(
+    (s) => results.send([shard, s.keyExpr, s.payload]),
+    onDone: () => results.send('done'),
+  );
+};
+
+void main() {
+  group('ShardedSubscriber lifecycle', () {
+    late Session session;
+
+    setUpAll(() {
+      session = Session.open();
+    });
+
+    tearDownAll(() {
+      session.close();
+    });
+
+    test('declareShardedSubscriber returns a ShardedSubscriber', () {
+      final (port, controller) = Subscriber.createSampleChannel();
+      final sub = session.declareShardedSubscriber(
+        'demo/example/sharded',
+        shardPorts: [port.sendPort],
+      );
+      expect(sub, isA<ShardedSubscriber>());
+      expect(sub.isolates, isEmpty);
+      sub.close();
+      expect(controller.done, completes);
+    });
+
+    test('ShardedSubscriber.close is idempotent', () {
+      final (port, _) = Subscriber.createSampleChannel();
+      final sub = session.declareShardedSubscriber(
+        'demo/example/sharded/idempotent',
+        shardPorts: [port.sendPort],
+      );
+      sub.close();
+      expect(() => sub.close(), returnsNormally);
+    });
+
+    test('empty shardPorts throws ArgumentError', () {
+      expect(
+        () => session.declareShardedSubscriber(
+          'demo/example/sharded/empty',
+          shardPorts: const [],
+        ),
+        throwsA(isA<ArgumentError>()),
+      );
+    });
+
+    test('rateLimitInterval with roundRobin throws ArgumentError', () {
+      final (port, controller) = Subscriber.createSampleChannel();
+      addTearDown(controller.close);
+      addTearDown(port.close);
+      expect(
+        () => session.declareShardedSubscriber(
+          'demo/example/sharded/rate',
+          shardPorts: [port.sendPort],
+          mode: ShardMode.roundRobin,
+          options: const SubscriberOptions(
+            rateLimitInterval: Duration(milliseconds: 100),
+          ),
+        ),
+        throwsA(isA<ArgumentError>()),
+      );
+    });
+  });
+
+  group('Sharded subscriber dispatch (TCP 17543)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17543"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17543"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    // Opens [count] in-isolate shard channels and records which shard
+    // received each (keyExpr, payload) pair.
+    (List<SendPort>, List<List<(String, String)>>) openShards(int count) {
+      final ports = <SendPort>[];
+      final received = <List<(String, String)>>[];
+      for (var i = 0; i < count; i++) {
+        final (port, controller) = Subscriber.createSampleChannel();
+        final shard = <(String, String)>[];
+        controller.stream.listen((s) => shard.add((s.keyExpr, s.payload)));
+        ports.add(port.sendPort);
+        received.add(shard);
+      }
+      return (ports, received);
+    }
+
+    test('byKey keeps every key on one shard, in order', () async {
+      final (ports, received) = openShards(3);
+      final sub = session2.declareShardedSubscriber(
+        'zenoh/dart/test/shard-key/**',
+        shardPorts: ports,
+      );
+      addTearDown(sub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 10; i++) {
+        for (var k = 0; k < 6; k++) {
+          session1.put('zenoh/dart/test/shard-key/k$k', 'v$i');
+        }
+      }
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      expect(received.expand((s) => s), hasLength(60));
+      for (var k = 0; k < 6; k++) {
+        final key = 'zenoh/dart/test/shard-key/k$k';
+        final holders = received.where((s) => s.any((e) => e.$1 == key));
+        expect(holders, hasLength(1), reason: key);
+        expect(
+          holders.single.where((e) => e.$1 == key).map((e) => e.$2),
+          equals([for (var i = 0; i < 10; i++) 'v$i']),
+        );
+      }
+    });
+
+    test('roundRobin spreads samples evenly across shards', () async {
+      final (ports, received) = openShards(4);
+      final sub = session2.declareShardedSubscriber(
+        'zenoh/dart/test/shard-rr',
+        shardPorts: ports,
+        mode: ShardMode.roundRobin,
+      );
+      addTearDown(sub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 20; i++) {
+        session1.put('zenoh/dart/test/shard-rr', 'v$i');
+      }
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      expect(received.map((s) => s.length), everyElement(equals(5)));
+    });
+
+    test('shards apply the subscriber options', () async {
+      final (ports, received) = openShards(2);
+      final sub = session2.declareShardedSubscriber(
+        'zenoh/dart/test/shard-filter/**',
+        shardPorts: ports,
+        options: const SubscriberOptions(
+          filter: SampleFilter(excludeKeyExprs: ['**/skip']),
+        ),
+      );
+      addTearDown(sub.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.put('zenoh/dart/test/shard-filter/keep', 'a');
+      session1.put('zenoh/dart/test/shard-filter/skip', 'b');
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      expect(
+        received.expand((s) => s),
+        equals([('zenoh/dart/test/shard-filter/keep', 'a')]),
+      );
+    });
+
+    test('spawnShardedSubscriber runs workers in separate isolates', () async {
+      final results = ReceivePort();
+      addTearDown(results.close);
+      final messages = <Object?>[];
+      final allDone = Completer<void>();
+      results.listen((m) {
+        messages.add(m);
+        if (messages.where((m) => m == 'done').length == 2) {
+          allDone.complete();
+        }
+      });
+
+      final sub = await session2.spawnShardedSubscriber(
+        'zenoh/dart/test/shard-spawn',
+        shards: 2,
+        worker: _forwardTo(results.sendPort),
+        mode: ShardMode.roundRobin,
+      );
+      expect(sub.isolates, hasLength(2));
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 4; i++) {
+        session1.put('zenoh/dart/test/shard-spawn', 'v$i');
+      }
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      sub.close();
+      await allDone.future.timeout(const Duration(seconds: 5));
+
+      final samples = messages.whereType<List>().toList();
+      expect(
+        samples.map((m) => m[2]),
+        unorderedEquals(['v0', 'v1', 'v2', 'v3']),
+      );
+      expect(samples.map((m) => m[0]).toSet(), hasLength(2));
+    });
+  });
+}
@@ -308,6 +308,88 @@ void main() {
       expect(sample.payload, equals('shm-data'));
       expect(sample.attachment, equals('meta'));
     });
+
+    test('Publisher with shmProvider routes by payload size', () async {
+      final subscriber = session2.declareSubscriber('zenoh/dart/test/shm-auto');
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher(
+        'zenoh/dart/test/shm-auto',
+        shmProvider: provider,
+        shmThreshold: 16,
+      );
+      addTearDown(publisher.close);
+      expect(publisher.shmProvider, same(provider));
+      expect(publisher.shmThreshold, equals(16));
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final large = Uint8List.fromList(List.generate(1000, (i) => i % 256));
+      final received = subscriber.stream.take(3).toList();
+      publisher.put('small');
+      publisher.putUint8List(large);
+      publisher.put('a string longer than the threshold');
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(samples[0].payload, equals('small'));
+      expect(samples[1].payloadBytes, equals(large));
+      expect(samples[2].payload, equals('a string longer than the threshold'));
+    });
+
+    test('Publisher with shmProvider keeps putBatch order', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/shm-batch',
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher(
+        'zenoh/dart/test/shm-batch',
+        shmProvider: provider,
+        shmThreshold: 16,
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final payloads = [
+        for (var i = 0; i < 6; i++)
+          utf8.encode(i.isEven ? 'msg-$i' : 'large-msg-$i'.padRight(64, '.')),
+      ];
+      final received = subscriber.stream.take(6).toList();
+      publisher.putBatch(
+        payloads,
+        attachments: [for (var i = 0; i < 6; i++) utf8.encode('att-$i')],
+      );
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(samples.map((s) => s.payloadBytes), equals(payloads));
+      expect(
+        samples.map((s) => s.attachment),
+        equals([for (var i = 0; i < 6; i++) 'att-$i']),
+      );
+    });
+
+    test('Publisher falls back to the heap when SHM is too small', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/shm-fallback',
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher(
+        'zenoh/dart/test/shm-fallback',
+        shmProvider: provider,
+        shmThreshold: 16,
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      // Larger than the whole 64 KB provider.
+      final data = Uint8List(100000)..fillRange(0, 100000, 7);
+      publisher.putUint8List(data);
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+      expect(sample.payloadBytes, equals(data));
+    });
   });
 
   group('SHM Clone Semantics', () {
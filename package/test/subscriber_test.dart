@@ -1,15 +1,35 @@
 import 'dart:async';
 import 'dart:convert';
+import 'dart:isolate';
 import 'dart:typed_data';
 
 import 'package:test/test.dart';
+import 'package:zenoh/src/advanced_publisher.dart';
 import 'package:zenoh/src/bytes.dart';
 import 'package:zenoh/src/config.dart';
+import 'package:zenoh/src/congestion_control.dart';
+import 'package:zenoh/src/encoding.dart';
 import 'package:zenoh/src/exceptions.dart';
+import 'package:zenoh/src/lazy_sample.dart';
+import 'package:zenoh/src/priority.dart';
 import 'package:zenoh/src/sample.dart';
 import 'package:zenoh/src/session.dart';
 import 'package:zenoh/src/subscriber.dart';
 
+/// Declares and closes subscribers in a fresh isolate, which can only exit
+/// once every receive port they opened has been closed.
+void _declareAndClose(Object? _) {
+  final session = Session.open();
+  session
+      .declareSubscriber(
+        'demo/example/exit',
+        options: const SubscriberOptions(lazy: true),
+      )
+      .close();
+  session.declareLivelinessSubscriber('demo/example/exit').close();
+  session.close();
+}
+
 void main() {
   group('SampleKind', () {
     test('has put and delete values that are distinct', () {
@@ -101,6 +121,168 @@ void main() {
     });
   });
 
+  group('Sample.fromWire', () {
+    Uint8List buildWire({
+      required int kind,
+      required String key,
+      required String encoding,
+      List<int>? attachment,
+      required List<int> payload,
+      Uint8List? metadata,
+    }) {
+      final body = 24 + (metadata?.length ?? 0);
+      final head =
+          body + key.length + encoding.length + (attachment?.length ?? 0);
+      final payloadOffset = (head + 7) & ~7;
+      final wire = Uint8List(payloadOffset + payload.length);
+      final header = ByteData.sublistView(wire);
+      header.setUint8(0, kind);
+      header.setUint8(
+        1,
+        (attachment != null ? 0x01 : 0) | (metadata != null ? 0x10 : 0),
+      );
+      header.setUint32(4, key.length, Endian.host);
+      header.setUint32(8, encoding.length, Endian.host);
+      header.setUint32(12, attachment?.length ?? 0, Endian.host);
+      header.setUint32(16, payloadOffset, Endian.host);
+      header.setUint32(20, payload.length, Endian.host);
+      if (metadata != null) wire.setAll(24, metadata);
+      wire.setAll(body, utf8.encode(key));
+      wire.setAll(body + key.length, utf8.encode(encoding));
+      if (attachment != null) {
+        wire.setAll(body + key.length + encoding.length, attachment);
+      }
+      wire.setAll(payloadOffset, payload);
+      return wire;
+    }
+
+    test('decodes all fields from a flat buffer', () {
+      final sample = Sample.fromWire(
+        buildWire(
+          kind: 0,
+          key: 'demo/wire',
+          encoding: 'text/plain',
+          attachment: utf8.encode('meta'),
+          payload: utf8.encode('hello'),
+        ),
+      );
+      expect(sample.keyExpr, equals('demo/wire'));
+      expect(sample.kind, equals(SampleKind.put));
+      expect(sample.encoding, equals('text/plain'));
+      expect(sample.attachment, equals('meta'));
+      expect(sample.payload, equals('hello'));
+      expect(sample.payloadBytes, equals(utf8.encode('hello')));
+    });
+
+    test('decodes metadata following the header', () {
+      final metadata = Uint8List(56);
+      final view = ByteData.sublistView(metadata);
+      // 1.5 s after the epoch in NTP64: seconds in the upper 32 bits.
+      view.setUint64(0, (1 << 32) + (1 << 31), Endian.host);
+      metadata.fillRange(8, 24, 0xAB);
+      metadata.fillRange(24, 40, 0xCD);
+      view.setUint32(40, 7, Endian.host);
+      view.setUint32(44, 42, Endian.host);
+      view.setUint8(48, 2);
+      view.setUint8(49, 1);
+      view.setUint8(50, 0x07);
+
+      final sample = Sample.fromWire(
+        buildWire(
+          kind: 0,
+          key: 'demo/wire/meta',
+          encoding: 'text/plain',
+          attachment: utf8.encode('att'),
+          payload: utf8.encode('hello'),
+          metadata: metadata,
+        ),
+      );
+      expect(sample.keyExpr, equals('demo/wire/meta'));
+      expect(sample.encoding, equals('text/plain'));
+      expect(sample.attachment, equals('att'));
+      expect(sample.payload, equals('hello'));
+
+      final meta = sample.metadata!;
+      expect(meta.time, equals(DateTime.utc(1970, 1, 1, 0, 0, 1, 500)));
+      expect(meta.timestampId!.bytes, everyElement(equals(0xAB)));
+      expect(meta.sourceId!.bytes, everyElement(equals(0xCD)));
+      expect(meta.sourceEntityId, equals(7));
+      expect(meta.sourceSequenceNumber, equals(42));
+      expect(meta.priority, equals(Priority.interactiveHigh));
+      expect(meta.congestionControl, equals(CongestionControl.drop));
+      expect(meta.isExpress, isTrue);
+    });
+
+    test('resolves an interned key id from the key table', () {
+      final wire = buildWire(
+        kind: 0,
+        key: '',
+        encoding: 'zenoh/bytes',
+        payload: utf8.encode('x'),
+      );
+      final header = ByteData.sublistView(wire);
+      header.setUint8(1, 0x02);
+      header.setUint32(4, 1, Endian.host);
+
+      final sample = Sample.fromWire(wire, keys: ['demo/a', 'demo/b']);
+      expect(sample.keyExpr, equals('demo/b'));
+      expect(sample.encoding, equals('zenoh/bytes'));
+      expect(sample.payload, equals('x'));
+    });
+
+    test('resolves a cached encoding id from the encoding table', () {
+      final wire = buildWire(
+        kind: 0,
+        key: 'demo/enc',
+        encoding: '',
+        payload: utf8.encode('x'),
+      );
+      final header = ByteData.sublistView(wire);
+      header.setUint8(1, 0x04);
+      header.setUint16(2, 1, Endian.host);
+
+      final sample = Sample.fromWire(
+        wire,
+        encodings: ['zenoh/bytes', 'application/json'],
+      );
+      expect(sample.keyExpr, equals('demo/enc'));
+      expect(sample.encoding, equals('application/json'));
+      expect(sample.payload, equals('x'));
+    });
+
+    test('reports payload length when the payload was left out', () {
+      final wire = buildWire(
+        kind: 0,
+        key: 'demo/meta',
+        encoding: '',
+        payload: const [],
+      );
+      final header = ByteData.sublistView(wire);
+      header.setUint8(1, 0x08);
+      header.setUint32(20, 4096, Endian.host);
+
+      final sample = Sample.fromWire(wire);
+      expect(sample.keyExpr, equals('demo/meta'));
+      expect(sample.payloadBytes, isEmpty);
+      expect(sample.payloadLength, equals(4096));
+      expect(sample.encoding, isNull);
+    });
+
+    test('reports delete kind and missing attachment', () {
+      final sample = Sample.fromWire(
+        buildWire(
+          kind: 1,
+          key: 'demo/wire',
+          encoding: 'zenoh/bytes',
+          payload: const [],
+        ),
+      );
+      expect(sample.kind, equals(SampleKind.delete));
+      expect(sample.attachment, isNull);
+      expect(sample.payloadBytes, hasLength(0));
+    });
+  });
+
   group('Subscriber lifecycle', () {
     late Session session;
 
@@ -129,6 +311,13 @@ void main() {
       expect(() => subscriber.close(), returnsNormally);
     });
 
+    test('Subscriber.close lets the isolate exit', () async {
+      final exited = ReceivePort();
+      addTearDown(exited.close);
+      await Isolate.spawn(_declareAndClose, null, onExit: exited.sendPort);
+      await exited.first.timeout(const Duration(seconds: 10));
+    });
+
     test('declareSubscriber on closed session throws StateError', () {
       final closedSession = Session.open();
       closedSession.close();
@@ -770,4 +959,1241 @@ void main() {
       });
     });
   });
+
+  group('Zero-copy subscriber (TCP 17530)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17530"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17530"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('delivers large binary payload intact', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/zc-large',
+        options: const SubscriberOptions(zeroCopy: true),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final data = Uint8List.fromList(
+        List<int>.generate(256 * 1024, (i) => i % 251),
+      );
+      session1.putBytes('zenoh/dart/test/zc-large', ZBytes.fromUint8List(data));
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+
+      expect(sample.kind, equals(SampleKind.put));
+      expect(sample.payloadBytes, equals(data));
+    });
+
+    test('delivers payload, attachment and encoding', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/zc-fields',
+        options: const SubscriberOptions(zeroCopy: true),
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher('zenoh/dart/test/zc-fields');
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      publisher.put(
+        'zero-copy',
+        encoding: Encoding.textPlain,
+        attachment: ZBytes.fromString('meta'),
+      );
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+
+      expect(sample.payload, equals('zero-copy'));
+      expect(sample.attachment, equals('meta'));
+      expect(sample.encoding, equals('text/plain'));
+    });
+
+    test('delivers empty payload for delete samples', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/zc-delete',
+        options: const SubscriberOptions(zeroCopy: true),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.deleteResource('zenoh/dart/test/zc-delete');
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+
+      expect(sample.kind, equals(SampleKind.delete));
+      expect(sample.payloadBytes, hasLength(0));
+    });
+
+    test('background subscriber accepts zero-copy options', () async {
+      final stream = session2.declareBackgroundSubscriber(
+        'zenoh/dart/test/zc-bg',
+        options: const SubscriberOptions(zeroCopy: true),
+      );
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.put('zenoh/dart/test/zc-bg', 'bg-zero-copy');
+
+      final sample = await stream.first.timeout(const Duration(seconds: 5));
+      expect(sample.payload, equals('bg-zero-copy'));
+    });
+  });
+
+  group('Batching subscriber (TCP 17531)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17531"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17531"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('delivers every sample in order across full batches', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/batch-order',
+        options: const SubscriberOptions(batchMaxSamples: 10),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(25).toList();
+      for (var i = 0; i < 25; i++) {
+        session1.put('zenoh/dart/test/batch-order', 'msg-$i');
+      }
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(
+        samples.map((s) => s.payload),
+        equals(List<String>.generate(25, (i) => 'msg-$i')),
+      );
+    });
+
+    test('flushes a partial batch after the deadline', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/batch-deadline',
+        options: const SubscriberOptions(
+          batchMaxSamples: 1000,
+          batchMaxDelay: Duration(milliseconds: 5),
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.put('zenoh/dart/test/batch-deadline', 'lonely');
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+      expect(sample.payload, equals('lonely'));
+    });
+
+    test('flushes when the byte limit is reached', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/batch-bytes',
+        options: const SubscriberOptions(
+          batchMaxSamples: 1000,
+          batchMaxBytes: 1024,
+          batchMaxDelay: Duration(seconds: 30),
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final data = Uint8List(2048);
+      session1.putBytes(
+        'zenoh/dart/test/batch-bytes',
+        ZBytes.fromUint8List(data),
+      );
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+      expect(sample.payloadBytes, hasLength(2048));
+    });
+
+    test('background subscriber flushes batches before completing', () async {
+      final config = Config();
+      config.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17531"]');
+      final session3 = Session.open(config: config);
+
+      final stream = session3.declareBackgroundSubscriber(
+        'zenoh/dart/test/batch-bg',
+        options: const SubscriberOptions(
+          batchMaxSamples: 1000,
+          batchMaxDelay: Duration(seconds: 30),
+        ),
+      );
+      final received = stream.toList();
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.put('zenoh/dart/test/batch-bg', 'pending');
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+      session3.close();
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(samples.map((s) => s.payload), equals(['pending']));
+    });
+  });
+
+  group('Flat wire format subscriber (TCP 17532)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17532"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17532"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('delivers payload, attachment and encoding', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/flat-fields',
+        options: const SubscriberOptions(flatWireFormat: true),
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher(
+        'zenoh/dart/test/flat-fields',
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      publisher.put(
+        'flat',
+        encoding: Encoding.textPlain,
+        attachment: ZBytes.fromString('meta'),
+      );
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+
+      expect(sample.keyExpr, equals('zenoh/dart/test/flat-fields'));
+      expect(sample.kind, equals(SampleKind.put));
+      expect(sample.payload, equals('flat'));
+      expect(sample.attachment, equals('meta'));
+      expect(sample.encoding, equals('text/plain'));
+    });
+
+    test('delivers delete samples without attachment', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/flat-delete',
+        options: const SubscriberOptions(flatWireFormat: true),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.deleteResource('zenoh/dart/test/flat-delete');
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+
+      expect(sample.kind, equals(SampleKind.delete));
+      expect(sample.attachment, isNull);
+      expect(sample.payloadBytes, hasLength(0));
+    });
+
+    test('combines with batching', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/flat-batch',
+        options: const SubscriberOptions(
+          flatWireFormat: true,
+          batchMaxSamples: 4,
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(10).toList();
+      for (var i = 0; i < 10; i++) {
+        session1.put('zenoh/dart/test/flat-batch', 'flat-$i');
+      }
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(
+        samples.map((s) => s.payload),
+        equals(List<String>.generate(10, (i) => 'flat-$i')),
+      );
+    });
+  });
+
+  group('Key interning subscriber (TCP 17533)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17533"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17533"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('resolves interned keys and shares one String per key', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/intern/*',
+        options: const SubscriberOptions(internMaxKeys: 16),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(6).toList();
+      for (var i = 0; i < 3; i++) {
+        session1.put('zenoh/dart/test/intern/a', 'a-$i');
+        session1.put('zenoh/dart/test/intern/b', 'b-$i');
+      }
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      final a = samples.where((s) => s.payload.startsWith('a-')).toList();
+      final b = samples.where((s) => s.payload.startsWith('b-')).toList();
+      expect(a.map((s) => s.keyExpr), everyElement('zenoh/dart/test/intern/a'));
+      expect(b.map((s) => s.keyExpr), everyElement('zenoh/dart/test/intern/b'));
+      expect(identical(a[0].keyExpr, a[2].keyExpr), isTrue);
+    });
+
+    test('falls back to strings once the table is full', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/intern-full/*',
+        options: const SubscriberOptions(internMaxKeys: 1),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(3).toList();
+      session1.put('zenoh/dart/test/intern-full/x', '1');
+      session1.put('zenoh/dart/test/intern-full/y', '2');
+      session1.put('zenoh/dart/test/intern-full/x', '3');
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(
+        samples.map((s) => '${s.keyExpr}=${s.payload}'),
+        equals([
+          'zenoh/dart/test/intern-full/x=1',
+          'zenoh/dart/test/intern-full/y=2',
+          'zenoh/dart/test/intern-full/x=3',
+        ]),
+      );
+    });
+
+    test('combines with the flat wire format and batching', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/intern-flat/*',
+        options: const SubscriberOptions(
+          internMaxKeys: 16,
+          flatWireFormat: true,
+          batchMaxSamples: 3,
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(4).toList();
+      session1.put('zenoh/dart/test/intern-flat/p', '1');
+      session1.put('zenoh/dart/test/intern-flat/q', '2');
+      session1.put('zenoh/dart/test/intern-flat/p', '3');
+      session1.put('zenoh/dart/test/intern-flat/q', '4');
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(
+        samples.map((s) => '${s.keyExpr}=${s.payload}'),
+        equals([
+          'zenoh/dart/test/intern-flat/p=1',
+          'zenoh/dart/test/intern-flat/q=2',
+          'zenoh/dart/test/intern-flat/p=3',
+          'zenoh/dart/test/intern-flat/q=4',
+        ]),
+      );
+    });
+  });
+  group('Encoding cache subscriber (TCP 17534)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17534"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17534"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    Future<List<Sample>> publishMixed(
+      String keyExpr,
+      SubscriberOptions options,
+    ) async {
+      final subscriber = session2.declareSubscriber(keyExpr, options: options);
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher(keyExpr);
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(4).toList();
+      publisher.put('1', encoding: Encoding.textPlain);
+      publisher.put('2', encoding: Encoding.applicationJson);
+      publisher.put('3', encoding: Encoding.textPlain);
+      publisher.put('4', encoding: Encoding.applicationJson);
+      return received.timeout(const Duration(seconds: 5));
+    }
+
+    test('resolves cached encodings and shares one String each', () async {
+      final samples = await publishMixed(
+        'zenoh/dart/test/enc-cache',
+        const SubscriberOptions(encodingCacheSize: 8),
+      );
+      expect(
+        samples.map((s) => s.encoding),
+        equals([
+          'text/plain',
+          'application/json',
+          'text/plain',
+          'application/json',
+        ]),
+      );
+      expect(identical(samples[0].encoding, samples[2].encoding), isTrue);
+    });
+
+    test('falls back to strings once the cache is full', () async {
+      final samples = await publishMixed(
+        'zenoh/dart/test/enc-cache-full',
+        const SubscriberOptions(encodingCacheSize: 1),
+      );
+      expect(
+        samples.map((s) => '${s.encoding}=${s.payload}'),
+        equals([
+          'text/plain=1',
+          'application/json=2',
+          'text/plain=3',
+          'application/json=4',
+        ]),
+      );
+    });
+
+    test('carries encoding ids in the flat wire format', () async {
+      final samples = await publishMixed(
+        'zenoh/dart/test/enc-cache-flat',
+        const SubscriberOptions(
+          flatWireFormat: true,
+          batchMaxSamples: 2,
+          encodingCacheSize: 8,
+        ),
+      );
+      expect(
+        samples.map((s) => '${s.encoding}=${s.payload}'),
+        equals([
+          'text/plain=1',
+          'application/json=2',
+          'text/plain=3',
+          'application/json=4',
+        ]),
+      );
+    });
+  });
+  group('Lazy subscriber (TCP 17535)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17535"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17535"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('delivers LazySample and reads fields on demand', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/lazy-fields',
+        options: const SubscriberOptions(lazy: true),
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher(
+        'zenoh/dart/test/lazy-fields',
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      publisher.put(
+        'lazy',
+        encoding: Encoding.textPlain,
+        attachment: ZBytes.fromString('meta'),
+      );
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+
+      expect(sample, isA<LazySample>());
+      expect(sample.keyExpr, equals('zenoh/dart/test/lazy-fields'));
+      expect(sample.kind, equals(SampleKind.put));
+      expect(sample.payload, equals('lazy'));
+      expect(sample.attachment, equals('meta'));
+      expect(sample.encoding, equals('text/plain'));
+      (sample as LazySample).dispose();
+    });
+
+    test('keeps read fields after dispose and rejects unread ones', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/lazy-dispose',
+        options: const SubscriberOptions(lazy: true),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.put('zenoh/dart/test/lazy-dispose', 'kept');
+
+      final sample =
+          await subscriber.stream.first.timeout(const Duration(seconds: 5))
+              as LazySample;
+
+      expect(sample.payloadBytes, equals(utf8.encode('kept')));
+      sample.dispose();
+      sample.dispose();
+      expect(sample.payload, equals('kept'));
+      expect(() => sample.encoding, throwsStateError);
+    });
+
+    test('combines with key interning and batching', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/lazy-batch/*',
+        options: const SubscriberOptions(
+          lazy: true,
+          internMaxKeys: 16,
+          batchMaxSamples: 2,
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final received = subscriber.stream.take(4).toList();
+      session1.put('zenoh/dart/test/lazy-batch/a', '1');
+      session1.put('zenoh/dart/test/lazy-batch/b', '2');
+      session1.put('zenoh/dart/test/lazy-batch/a', '3');
+      session1.deleteResource('zenoh/dart/test/lazy-batch/b');
+
+      final samples = await received.timeout(const Duration(seconds: 5));
+      expect(samples, everyElement(isA<LazySample>()));
+      expect(
+        samples.map((s) => '${s.keyExpr}=${s.kind.name}'),
+        equals([
+          'zenoh/dart/test/lazy-batch/a=put',
+          'zenoh/dart/test/lazy-batch/b=put',
+          'zenoh/dart/test/lazy-batch/a=put',
+          'zenoh/dart/test/lazy-batch/b=delete',
+        ]),
+      );
+      expect(samples[2].payload, equals('3'));
+    });
+
+    test('closes with lazy samples still queued', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/lazy-close',
+        options: const SubscriberOptions(lazy: true),
+      );
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final done = subscriber.stream.drain<void>();
+      for (var i = 0; i < 100; i++) {
+        session1.put('zenoh/dart/test/lazy-close', '$i');
+      }
+      subscriber.close();
+
+      await done.timeout(const Duration(seconds: 5));
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+    });
+  });
+  group('Field mask subscriber (TCP 17537)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17537"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17537"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    Future<Sample> publishOne(String keyExpr, SubscriberOptions options) async {
+      final subscriber = session2.declareSubscriber(keyExpr, options: options);
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher(keyExpr);
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      publisher.putBytes(
+        ZBytes.fromUint8List(Uint8List(4096)),
+        encoding: Encoding.applicationOctetStream,
+        attachment: ZBytes.fromString('meta'),
+      );
+      return subscriber.stream.first.timeout(const Duration(seconds: 5));
+    }
+
+    test('metadata-only delivers key, kind and payload length', () async {
+      final sample = await publishOne(
+        'zenoh/dart/test/fields-meta',
+        const SubscriberOptions(fields: {}),
+      );
+      expect(sample.keyExpr, equals('zenoh/dart/test/fields-meta'));
+      expect(sample.kind, equals(SampleKind.put));
+      expect(sample.payloadBytes, isEmpty);
+      expect(sample.payloadLength, equals(4096));
+      expect(sample.attachment, isNull);
+      expect(sample.encoding, isNull);
+    });
+
+    test('delivers only the requested fields', () async {
+      final sample = await publishOne(
+        'zenoh/dart/test/fields-enc',
+        const SubscriberOptions(fields: {SampleField.encoding}),
+      );
+      expect(sample.payloadLength, equals(4096));
+      expect(sample.attachment, isNull);
+      expect(sample.encoding, equals('application/octet-stream'));
+    });
+
+    test('applies the mask to the flat wire format', () async {
+      final sample = await publishOne(
+        'zenoh/dart/test/fields-flat',
+        const SubscriberOptions(
+          flatWireFormat: true,
+          fields: {SampleField.attachment},
+        ),
+      );
+      expect(sample.payloadBytes, isEmpty);
+      expect(sample.payloadLength, equals(4096));
+      expect(sample.attachment, equals('meta'));
+      expect(sample.encoding, isNull);
+    });
+  });
+
+  group('Native filter subscriber (TCP 17538)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17538"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17538"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('kind filter drops deletes natively', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/filter-kind',
+        options: const SubscriberOptions(
+          filter: SampleFilter(kind: SampleKind.put),
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.deleteResource('zenoh/dart/test/filter-kind');
+      session1.put('zenoh/dart/test/filter-kind', 'kept');
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+      expect(sample.kind, equals(SampleKind.put));
+      expect(sample.payload, equals('kept'));
+      expect(subscriber.filteredCount, equals(1));
+    });
+
+    test('payload length and prefix filters count rejects', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/filter-payload',
+        options: SubscriberOptions(
+          filter: SampleFilter(
+            minPayloadLength: 4,
+            maxPayloadLength: 64,
+            payloadPrefix: 'ok:'.codeUnits,
+          ),
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      const key = 'zenoh/dart/test/filter-payload';
+      session1.put(key, 'ok');
+      session1.putBytes(key, ZBytes.fromUint8List(Uint8List(128)));
+      session1.put(key, 'no:match');
+      session1.put(key, 'ok:match');
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+      expect(sample.payload, equals('ok:match'));
+      expect(subscriber.filteredCount, equals(3));
+    });
+
+    test('excluded key expressions are never delivered', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/filter-keys/**',
+        options: const SubscriberOptions(
+          filter: SampleFilter(
+            excludeKeyExprs: ['zenoh/dart/test/filter-keys/noisy/**'],
+          ),
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      session1.put('zenoh/dart/test/filter-keys/noisy/a', 'noise');
+      session1.put('zenoh/dart/test/filter-keys/quiet', 'signal');
+
+      final sample = await subscriber.stream.first.timeout(
+        const Duration(seconds: 5),
+      );
+      expect(sample.keyExpr, equals('zenoh/dart/test/filter-keys/quiet'));
+      expect(subscriber.filteredCount, equals(1));
+    });
+
+    test('filteredCount on closed subscriber throws StateError', () {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/filter-closed',
+      );
+      subscriber.close();
+      expect(() => subscriber.filteredCount, throwsA(isA<StateError>()));
+    });
+  });
+
+  group('Rate limited subscriber (TCP 17539)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17539"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17539"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    test('dropNewest delivers the first sample of each interval', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/rate-drop',
+        options: const SubscriberOptions(
+          rateLimitInterval: Duration(seconds: 10),
+        ),
+      );
+      addTearDown(subscriber.close);
+      final received = <Sample>[];
+      subscriber.stream.listen(received.add);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 20; i++) {
+        session1.put('zenoh/dart/test/rate-drop', 'v$i');
+      }
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      expect(received.map((s) => s.payload), equals(['v0']));
+      expect(subscriber.rateLimitedCount, equals(19));
+    });
+
+    test('keepLatest delivers the held sample after the interval', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/rate-latest',
+        options: const SubscriberOptions(
+          rateLimitInterval: Duration(milliseconds: 500),
+          rateLimitMode: RateLimitMode.keepLatest,
+        ),
+      );
+      addTearDown(subscriber.close);
+      final received = <Sample>[];
+      subscriber.stream.listen(received.add);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 20; i++) {
+        session1.put('zenoh/dart/test/rate-latest', 'v$i');
+      }
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      expect(received.map((s) => s.payload), equals(['v0', 'v19']));
+      expect(subscriber.rateLimitedCount, equals(18));
+    });
+
+    test('limits each key of a wildcard subscription separately', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/rate-keys/*',
+        options: const SubscriberOptions(
+          rateLimitInterval: Duration(seconds: 10),
+        ),
+      );
+      addTearDown(subscriber.close);
+      final received = <Sample>[];
+      subscriber.stream.listen(received.add);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 5; i++) {
+        session1.put('zenoh/dart/test/rate-keys/a', 'a$i');
+        session1.put('zenoh/dart/test/rate-keys/b', 'b$i');
+      }
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      expect(
+        received.map((s) => s.payload),
+        unorderedEquals(['a0', 'b0']),
+      );
+      expect(subscriber.rateLimitedCount, equals(8));
+    });
+
+    test('evicts idle keys beyond rateLimitMaxKeys', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/rate-cap/*',
+        options: const SubscriberOptions(
+          rateLimitInterval: Duration(seconds: 10),
+          rateLimitMaxKeys: 2,
+        ),
+      );
+      addTearDown(subscriber.close);
+      final received = <Sample>[];
+      subscriber.stream.listen(received.add);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      // c evicts a, then the second a evicts b: every sample is a new key.
+      session1.put('zenoh/dart/test/rate-cap/a', 'a0');
+      session1.put('zenoh/dart/test/rate-cap/b', 'b0');
+      session1.put('zenoh/dart/test/rate-cap/c', 'c0');
+      session1.put('zenoh/dart/test/rate-cap/a', 'a1');
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      expect(
+        received.map((s) => s.payload),
+        equals(['a0', 'b0', 'c0', 'a1']),
+      );
+      expect(subscriber.rateLimitedCount, equals(0));
+    });
+  });
+
+  group('Flow controlled subscriber (TCP 17541)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17541"]');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17541"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    // Publishes 20 samples to a paused listener, then resumes it and
+    // returns the payloads it receives.
+    Future<List<String>> publishWhilePaused(
+      Subscriber subscriber,
+      String keyExpr,
+    ) async {
+      final received = <String>[];
+      final subscription = subscriber.stream.listen(
+        (s) => received.add(s.payload),
+      );
+      subscription.pause();
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 20; i++) {
+        session1.put(keyExpr, 'v$i');
+      }
+      await Future<void>.delayed(const Duration(seconds: 1));
+      subscription.resume();
+      await Future<void>.delayed(const Duration(seconds: 1));
+      await subscription.cancel();
+      return received;
+    }
+
+    test('dropNewest drops samples beyond the in-flight limit', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/flow-newest',
+        options: const SubscriberOptions(maxInFlight: 4),
+      );
+      addTearDown(subscriber.close);
+
+      final received = await publishWhilePaused(
+        subscriber,
+        'zenoh/dart/test/flow-newest',
+      );
+
+      expect(received, equals(['v0', 'v1', 'v2', 'v3']));
+      expect(subscriber.overflowDroppedCount, equals(16));
+    });
+
+    test('dropOldest delivers the newest queued samples on ack', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/flow-oldest',
+        options: const SubscriberOptions(
+          maxInFlight: 4,
+          overflowPolicy: OverflowPolicy.dropOldest,
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      final received = await publishWhilePaused(
+        subscriber,
+        'zenoh/dart/test/flow-oldest',
+      );
+
+      expect(
+        received,
+        equals(['v0', 'v1', 'v2', 'v3', 'v16', 'v17', 'v18', 'v19']),
+      );
+      expect(subscriber.overflowDroppedCount, equals(12));
+    });
+
+    test('dropOldest keeps order with samples still batched', () async {
+      // v3 waits in a partial batch while v4..v19 are queued; acking the
+      // first batch must deliver v3 before the queued samples.
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/flow-oldest-batch',
+        options: const SubscriberOptions(
+          maxInFlight: 4,
+          overflowPolicy: OverflowPolicy.dropOldest,
+          batchMaxSamples: 3,
+          batchMaxDelay: Duration(seconds: 10),
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      final received = await publishWhilePaused(
+        subscriber,
+        'zenoh/dart/test/flow-oldest-batch',
+      );
+
+      expect(
+        received,
+        equals(['v0', 'v1', 'v2', 'v3', 'v16', 'v17', 'v18', 'v19']),
+      );
+      expect(subscriber.overflowDroppedCount, equals(12));
+    });
+
+    test('block delivers every sample once the listener resumes', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/flow-block',
+        options: const SubscriberOptions(
+          maxInFlight: 2,
+          overflowPolicy: OverflowPolicy.block,
+        ),
+      );
+      addTearDown(subscriber.close);
+
+      final received = await publishWhilePaused(
+        subscriber,
+        'zenoh/dart/test/flow-block',
+      );
+
+      expect(received, equals(List<String>.generate(20, (i) => 'v$i')));
+      expect(subscriber.overflowDroppedCount, equals(0));
+    });
+
+    test('close does not hang on a blocked callback', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/flow-close',
+        options: const SubscriberOptions(
+          maxInFlight: 1,
+          overflowPolicy: OverflowPolicy.block,
+        ),
+      );
+      subscriber.stream.listen((_) {}).pause();
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      for (var i = 0; i < 5; i++) {
+        session1.put('zenoh/dart/test/flow-close', 'v$i');
+      }
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      expect(subscriber.close, returnsNormally);
+    });
+  });
+
+  group('Sample metadata subscriber (TCP 17544)', () {
+    late Session session1;
+    late Session session2;
+
+    setUpAll(() async {
+      final config1 = Config();
+      config1.insertJson5('listen/endpoints', '["tcp/127.0.0.1:17544"]');
+      config1.insertJson5('timestamping/enabled', 'true');
+      session1 = Session.open(config: config1);
+
+      await Future<void>.delayed(const Duration(milliseconds: 500));
+
+      final config2 = Config();
+      config2.insertJson5('connect/endpoints', '["tcp/127.0.0.1:17544"]');
+      session2 = Session.open(config: config2);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+    });
+
+    tearDownAll(() {
+      session1.close();
+      session2.close();
+    });
+
+    Future<Sample> publishOne(String keyExpr, SubscriberOptions options) async {
+      final subscriber = session2.declareSubscriber(keyExpr, options: options);
+      addTearDown(subscriber.close);
+      final publisher = session1.declarePublisher(
+        keyExpr,
+        priority: Priority.interactiveHigh,
+        congestionControl: CongestionControl.drop,
+        isExpress: true,
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      publisher.put('meta');
+      return subscriber.stream.first.timeout(const Duration(seconds: 5));
+    }
+
+    const withMetadata = SubscriberOptions(
+      fields: {
+        SampleField.payload,
+        SampleField.attachment,
+        SampleField.encoding,
+        SampleField.metadata,
+      },
+    );
+
+    void expectMetadata(SampleMetadata? metadata, DateTime before) {
+      expect(metadata, isNotNull);
+      expect(metadata!.priority, equals(Priority.interactiveHigh));
+      expect(metadata.congestionControl, equals(CongestionControl.drop));
+      expect(metadata.isExpress, isTrue);
+      expect(metadata.timestamp, isNotNull);
+      expect(metadata.timestampId, isNotNull);
+      final time = metadata.time!;
+      expect(
+        time.isAfter(before.subtract(const Duration(seconds: 1))),
+        isTrue,
+      );
+      expect(
+        time.isBefore(DateTime.now().add(const Duration(seconds: 1))),
+        isTrue,
+      );
+    }
+
+    test('metadata is not delivered by default', () async {
+      final sample = await publishOne(
+        'zenoh/dart/test/meta-default',
+        const SubscriberOptions(),
+      );
+      expect(sample.payload, equals('meta'));
+      expect(sample.metadata, isNull);
+    });
+
+    test('delivers timestamp and QoS in the array layout', () async {
+      final before = DateTime.now();
+      final sample = await publishOne(
+        'zenoh/dart/test/meta-array',
+        withMetadata,
+      );
+      expect(sample.payload, equals('meta'));
+      expectMetadata(sample.metadata, before);
+    });
+
+    test('delivers timestamp and QoS in the flat wire format', () async {
+      final before = DateTime.now();
+      final sample = await publishOne(
+        'zenoh/dart/test/meta-flat',
+        const SubscriberOptions(
+          flatWireFormat: true,
+          fields: {SampleField.payload, SampleField.metadata},
+        ),
+      );
+      expect(sample.keyExpr, equals('zenoh/dart/test/meta-flat'));
+      expect(sample.payload, equals('meta'));
+      expectMetadata(sample.metadata, before);
+    });
+
+    test('LazySample reads metadata on demand', () async {
+      final before = DateTime.now();
+      final sample = await publishOne(
+        'zenoh/dart/test/meta-lazy',
+        const SubscriberOptions(lazy: true),
+      );
+      addTearDown((sample as LazySample).dispose);
+      expectMetadata(sample.metadata, before);
+    });
+
+    test('delivers source id and sequence numbers', () async {
+      final subscriber = session2.declareSubscriber(
+        'zenoh/dart/test/meta-source',
+        options: withMetadata,
+      );
+      addTearDown(subscriber.close);
+      final publisher = session1.declareAdvancedPublisher(
+        'zenoh/dart/test/meta-source',
+        options: AdvancedPublisherOptions(sampleMissDetection: true),
+      );
+      addTearDown(publisher.close);
+
+      await Future<void>.delayed(const Duration(seconds: 1));
+
+      final samples = subscriber.stream.take(3).toList();
+      for (var i = 0; i < 3; i++) {
+        publisher.put('v$i');
+      }
+      final received = await samples.timeout(const Duration(seconds: 5));
+
+      final metadata = received.map((s) => s.metadata!).toList();
+      expect(metadata.map((m) => m.sourceId).toSet(), hasLength(1));
+      expect(metadata.first.sourceId, isNotNull);
+      final sns = metadata.map((m) => m.sourceSequenceNumber!).toList();
+      expect(sns, equals([sns[0], sns[0] + 1, sns[0] + 2]));
+    });
+  });
 }
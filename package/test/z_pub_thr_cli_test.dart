@@ -103,5 +103,37 @@ void main() {
       // Verify it started successfully by checking stdout
       expect(stdoutBuf.toString(), contains('Press CTRL-C to quit'));
     }, timeout: Timeout(Duration(seconds: 60)));
+
+    test('--native flag reports the native publish rate', () async {
+      const endpoint = 'tcp/127.0.0.1:18603';
+
+      final process = await Process.start(_dartExe, [
+        'run',
+        'example/z_pub_thr.dart',
+        '--native',
+        '64',
+        '-l',
+        endpoint,
+      ], workingDirectory: packageRoot);
+
+      final stdoutBuf = StringBuffer();
+      final stderrBuf = StringBuffer();
+      process.stdout
+          .transform(const SystemEncoding().decoder)
+          .listen(stdoutBuf.write);
+      process.stderr
+          .transform(const SystemEncoding().decoder)
+          .listen(stderrBuf.write);
+
+      // Let it run for at least one 1-second round then kill
+      await Future<void>.delayed(const Duration(seconds: 4));
+      await forceKill(process);
+
+      expect(stdoutBuf.toString(), contains('Press CTRL-C to quit'));
+      expect(
+        stdoutBuf.toString(),
+        matches(RegExp(r'[\d.]+ msg/s \(\d+ bytes/s\)')),
+      );
+    }, timeout: Timeout(Duration(seconds: 60)));
   });
 }
@@ -1,8 +1,12 @@
 #include "zenoh_dart.h"
 #include "dart/dart_api_dl.h"
 
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 // ---------------------------------------------------------------------------
 // Dart API initialization
@@ -84,6 +88,21 @@ FFI_PLUGIN_EXPORT int zd_bytes_copy_from_buf(z_owned_bytes_t* bytes,
   return z_bytes_copy_from_buf(bytes, data, len);
 }
 
+static void _zd_bytes_free_deleter(void* data, void* context) {
+  (void)context;
+  free(data);
+}
+
+FFI_PLUGIN_EXPORT int zd_bytes_from_malloc(z_owned_bytes_t* bytes,
+                                           uint8_t* data, size_t len) {
+  if (data == NULL || len == 0) {
+    free(data);
+    z_bytes_empty(bytes);
+    return 0;
+  }
+  return z_bytes_from_buf(bytes, data, len, _zd_bytes_free_deleter, NULL);
+}
+
 FFI_PLUGIN_EXPORT int zd_bytes_to_string(const z_loaned_bytes_t* bytes,
                                          z_owned_string_t* out) {
   return z_bytes_to_string(bytes, out);
@@ -121,6 +140,121 @@ FFI_PLUGIN_EXPORT int8_t zd_bytes_clone(uint8_t* dst, const uint8_t* src) {
   return 0;
 }
 
+// ---------------------------------------------------------------------------
+// Bytes Buffer Pool
+// ---------------------------------------------------------------------------
+
+struct zd_buffer_pool_t {
+  pthread_mutex_t mutex;
+  uint8_t* slab;
+  size_t buffer_size;
+  int32_t count;
+  int32_t* free_list;  // stack of free buffer indices
+  int32_t free_count;
+  int32_t in_flight;  // buffers owned by zenoh bytes
+  bool closed;
+};
+
+static void _zd_buffer_pool_destroy(zd_buffer_pool_t* pool) {
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool->free_list);
+  free(pool->slab);
+  free(pool);
+}
+
+/// Pushes `data` back onto the free list. Caller holds the mutex.
+static void _zd_buffer_pool_push(zd_buffer_pool_t* pool, uint8_t* data) {
+  size_t index = (size_t)(data - pool->slab) / pool->buffer_size;
+  pool->free_list[pool->free_count++] = (int32_t)index;
+}
+
+/// z_bytes_from_buf() deleter: returns the buffer to its pool and frees the
+/// pool if it was closed and this was its last buffer in flight.
+static void _zd_buffer_pool_deleter(void* data, void* context) {
+  zd_buffer_pool_t* pool = (zd_buffer_pool_t*)context;
+  pthread_mutex_lock(&pool->mutex);
+  _zd_buffer_pool_push(pool, (uint8_t*)data);
+  bool destroy = --pool->in_flight == 0 && pool->closed;
+  pthread_mutex_unlock(&pool->mutex);
+  if (destroy) _zd_buffer_pool_destroy(pool);
+}
+
+FFI_PLUGIN_EXPORT zd_buffer_pool_t* zd_buffer_pool_new(size_t buffer_size,
+                                                       int32_t count) {
+  if (buffer_size == 0 || count <= 0 ||
+      buffer_size > SIZE_MAX / (size_t)count) {
+    return NULL;
+  }
+  zd_buffer_pool_t* pool = calloc(1, sizeof(zd_buffer_pool_t));
+  if (pool == NULL) return NULL;
+  pool->slab = malloc(buffer_size * (size_t)count);
+  pool->free_list = malloc(sizeof(int32_t) * (size_t)count);
+  if (pool->slab == NULL || pool->free_list == NULL) {
+    free(pool->slab);
+    free(pool->free_list);
+    free(pool);
+    return NULL;
+  }
+  pthread_mutex_init(&pool->mutex, NULL);
+  pool->buffer_size = buffer_size;
+  pool->count = count;
+  // Pushed in reverse so that buffers are handed out in slab order.
+  for (int32_t i = 0; i < count; i++) {
+    pool->free_list[i] = count - 1 - i;
+  }
+  pool->free_count = count;
+  return pool;
+}
+
+FFI_PLUGIN_EXPORT uint8_t* zd_buffer_pool_acquire(zd_buffer_pool_t* pool) {
+  uint8_t* data = NULL;
+  pthread_mutex_lock(&pool->mutex);
+  if (!pool->closed && pool->free_count > 0) {
+    int32_t index = pool->free_list[--pool->free_count];
+    data = pool->slab + (size_t)index * pool->buffer_size;
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return data;
+}
+
+FFI_PLUGIN_EXPORT void zd_buffer_pool_release(zd_buffer_pool_t* pool,
+                                              uint8_t* data) {
+  pthread_mutex_lock(&pool->mutex);
+  _zd_buffer_pool_push(pool, data);
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+FFI_PLUGIN_EXPORT int32_t zd_buffer_pool_available(zd_buffer_pool_t* pool) {
+  pthread_mutex_lock(&pool->mutex);
+  int32_t available = pool->free_count;
+  pthread_mutex_unlock(&pool->mutex);
+  return available;
+}
+
+FFI_PLUGIN_EXPORT int zd_bytes_from_pool_buffer(z_owned_bytes_t* bytes,
+                                                zd_buffer_pool_t* pool,
+                                                uint8_t* data, size_t len) {
+  if (len == 0 || len > pool->buffer_size) {
+    zd_buffer_pool_release(pool, data);
+    z_bytes_empty(bytes);
+    return len == 0 ? 0 : Z_EINVAL;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  pool->in_flight++;
+  pthread_mutex_unlock(&pool->mutex);
+  // z_bytes_from_buf() runs the deleter itself if it fails.
+  return z_bytes_from_buf(bytes, data, len, _zd_buffer_pool_deleter, pool);
+}
+
+FFI_PLUGIN_EXPORT void zd_buffer_pool_free(zd_buffer_pool_t* pool) {
+  if (pool == NULL) return;
+  pthread_mutex_lock(&pool->mutex);
+  pool->closed = true;
+  bool destroy = pool->in_flight == 0;
+  pthread_mutex_unlock(&pool->mutex);
+  if (destroy) _zd_buffer_pool_destroy(pool);
+}
+
 // ---------------------------------------------------------------------------
 // Owned String
 // ---------------------------------------------------------------------------
@@ -202,6 +336,39 @@ FFI_PLUGIN_EXPORT size_t zd_view_string_len(const z_view_string_t* str) {
   return z_string_len(loaned);
 }
 
+// ---------------------------------------------------------------------------
+// Encoding
+// ---------------------------------------------------------------------------
+
+FFI_PLUGIN_EXPORT size_t zd_encoding_sizeof(void) {
+  return sizeof(z_owned_encoding_t);
+}
+
+FFI_PLUGIN_EXPORT int zd_encoding_from_str(z_owned_encoding_t* encoding,
+                                           const char* mime_type) {
+  return z_encoding_from_str(encoding, mime_type);
+}
+
+FFI_PLUGIN_EXPORT void zd_encoding_drop(z_owned_encoding_t* encoding) {
+  z_encoding_drop(z_encoding_move(encoding));
+}
+
+/// Fills `storage` with a clone of `compiled` or, failing that, with
+/// `mime_type` parsed, and returns it moved for an options struct. Returns
+/// NULL when neither is given.
+static z_moved_encoding_t* _zd_encoding_option(
+    const z_owned_encoding_t* compiled, const char* mime_type,
+    z_owned_encoding_t* storage) {
+  if (compiled != NULL) {
+    z_encoding_clone(storage, z_encoding_loan(compiled));
+  } else if (mime_type != NULL) {
+    z_encoding_from_str(storage, mime_type);
+  } else {
+    return NULL;
+  }
+  return z_encoding_move(storage);
+}
+
 // ---------------------------------------------------------------------------
 // Put / Delete
 // ---------------------------------------------------------------------------
@@ -227,116 +394,1784 @@ FFI_PLUGIN_EXPORT int zd_delete(
 // Subscriber
 // ---------------------------------------------------------------------------
 
+// Key expression map: an insertion-ordered hash map from key expression
+// strings to per-key slots. Entries get dense ids in first-seen order and
+// are never moved, so callers may keep pointers to them.
+
+typedef struct {
+  /// Null-terminated copy of the key expression.
+  char* key;
+  size_t key_len;
+  uint64_t hash;
+  /// Insertion index, dense from 0.
+  uint32_t id;
+  /// Caller-owned per-key state.
+  void* value;
+} zd_keymap_entry_t;
+
+typedef struct {
+  /// Open-addressing table of entry pointers (power of two, NULL = empty).
+  zd_keymap_entry_t** slots;
+  size_t capacity;
+  /// Entries in insertion order, indexed by id.
+  zd_keymap_entry_t** entries;
+  size_t count;
+} zd_keymap_t;
+
+/// FNV-1a hash of a key expression.
+static uint64_t _zd_keymap_hash(const char* key, size_t len) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (uint8_t)key[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/// Returns the entry for `key`, or NULL if it has not been inserted.
+static zd_keymap_entry_t* _zd_keymap_find(const zd_keymap_t* map,
+                                          const char* key, size_t len) {
+  if (map->capacity == 0) return NULL;
+  uint64_t hash = _zd_keymap_hash(key, len);
+  size_t mask = map->capacity - 1;
+  for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+    zd_keymap_entry_t* entry = map->slots[i];
+    if (entry == NULL) return NULL;
+    if (entry->hash == hash && entry->key_len == len &&
+        memcmp(entry->key, key, len) == 0) {
+      return entry;
+    }
+  }
+}
+
+/// Rebuilds the slot table with the given power-of-two capacity.
+static bool _zd_keymap_rehash(zd_keymap_t* map, size_t capacity) {
+  zd_keymap_entry_t** slots =
+      (zd_keymap_entry_t**)calloc(capacity, sizeof(zd_keymap_entry_t*));
+  zd_keymap_entry_t** entries = (zd_keymap_entry_t**)realloc(
+      map->entries, capacity * sizeof(zd_keymap_entry_t*));
+  if (!slots || !entries) {
+    free(slots);
+    if (entries) map->entries = entries;
+    return false;
+  }
+  size_t mask = capacity - 1;
+  for (size_t n = 0; n < map->count; n++) {
+    size_t i = (size_t)entries[n]->hash & mask;
+    while (slots[i] != NULL) i = (i + 1) & mask;
+    slots[i] = entries[n];
+  }
+  free(map->slots);
+  map->slots = slots;
+  map->entries = entries;
+  map->capacity = capacity;
+  return true;
+}
+
+/// Inserts `key`, which must not already be present.
+///
+/// Returns the new entry (with a NULL value), or NULL on allocation failure.
+static zd_keymap_entry_t* _zd_keymap_insert(zd_keymap_t* map,
+                                            const char* key, size_t len) {
+  if ((map->count + 1) * 4 > map->capacity * 3 &&
+      !_zd_keymap_rehash(map, map->capacity ? map->capacity * 2 : 16)) {
+    return NULL;
+  }
+  zd_keymap_entry_t* entry =
+      (zd_keymap_entry_t*)calloc(1, sizeof(zd_keymap_entry_t));
+  if (!entry) return NULL;
+  entry->key = (char*)malloc(len + 1);
+  if (!entry->key) {
+    free(entry);
+    return NULL;
+  }
+  memcpy(entry->key, key, len);
+  entry->key[len] = '\0';
+  entry->key_len = len;
+  entry->hash = _zd_keymap_hash(key, len);
+  entry->id = (uint32_t)map->count;
+
+  size_t mask = map->capacity - 1;
+  size_t i = (size_t)entry->hash & mask;
+  while (map->slots[i] != NULL) i = (i + 1) & mask;
+  map->slots[i] = entry;
+  map->entries[map->count++] = entry;
+  return entry;
+}
+
+/// Removes `entry` and frees it, but not its value. The last entry takes
+/// over its id, so removing the most recent entry leaves every other id
+/// unchanged.
+static void _zd_keymap_remove(zd_keymap_t* map, zd_keymap_entry_t* entry) {
+  size_t mask = map->capacity - 1;
+  size_t i = (size_t)entry->hash & mask;
+  while (map->slots[i] != entry) i = (i + 1) & mask;
+  map->slots[i] = NULL;
+  // Re-place the rest of the probe cluster so lookups do not stop early.
+  for (i = (i + 1) & mask; map->slots[i] != NULL; i = (i + 1) & mask) {
+    zd_keymap_entry_t* moved = map->slots[i];
+    map->slots[i] = NULL;
+    size_t j = (size_t)moved->hash & mask;
+    while (map->slots[j] != NULL) j = (j + 1) & mask;
+    map->slots[j] = moved;
+  }
+
+  zd_keymap_entry_t* last = map->entries[--map->count];
+  map->entries[entry->id] = last;
+  last->id = entry->id;
+  free(entry->key);
+  free(entry);
+}
+
+/// Frees every entry, passing each non-NULL value to `free_value` (if
+/// given), and resets the map to empty.
+static void _zd_keymap_clear(zd_keymap_t* map, void (*free_value)(void*)) {
+  for (size_t n = 0; n < map->count; n++) {
+    if (free_value != NULL && map->entries[n]->value != NULL) {
+      free_value(map->entries[n]->value);
+    }
+    free(map->entries[n]->key);
+    free(map->entries[n]);
+  }
+  free(map->slots);
+  free(map->entries);
+  memset(map, 0, sizeof(*map));
+}
+
+/// Samples buffered for one batched post, see _zd_sample_batch_add().
+typedef struct zd_sample_batch_t zd_sample_batch_t;
+
+/// Per-key rate limit state, see _zd_rate_limiter_admit().
+typedef struct zd_rate_limiter_t zd_rate_limiter_t;
+
+/// Native sample filters, copied from zd_subscriber_options_t.
+typedef struct {
+  bool enabled;
+  size_t min_payload_len;
+  size_t max_payload_len;
+  int8_t kind;
+  uint8_t* payload_prefix;
+  size_t payload_prefix_len;
+  uint8_t* attachment_prefix;
+  size_t attachment_prefix_len;
+  z_owned_keyexpr_t* exclude;
+  size_t exclude_len;
+} zd_sample_filter_t;
+
+static void _zd_sample_filter_clear(zd_sample_filter_t* filter) {
+  free(filter->payload_prefix);
+  free(filter->attachment_prefix);
+  for (size_t i = 0; i < filter->exclude_len; i++) {
+    z_keyexpr_drop(z_keyexpr_move(&filter->exclude[i]));
+  }
+  free(filter->exclude);
+  memset(filter, 0, sizeof(*filter));
+}
+
+static uint8_t* _zd_memdup(const uint8_t* data, size_t len) {
+  uint8_t* buf = (uint8_t*)malloc(len > 0 ? len : 1);
+  if (buf != NULL && len > 0) memcpy(buf, data, len);
+  return buf;
+}
+
+/// Copies the filters out of `options`. Returns false on allocation
+/// failure or an invalid exclusion key expression.
+static bool _zd_sample_filter_init(zd_sample_filter_t* filter,
+                                   const zd_subscriber_options_t* options) {
+  memset(filter, 0, sizeof(*filter));
+  filter->min_payload_len = options->filter_min_payload_len;
+  filter->max_payload_len = options->filter_max_payload_len;
+  filter->kind = options->filter_kind;
+  filter->enabled = filter->min_payload_len > 0 ||
+                    filter->max_payload_len != SIZE_MAX ||
+                    filter->kind >= 0;
+  if (options->filter_payload_prefix != NULL) {
+    filter->payload_prefix_len = options->filter_payload_prefix_len;
+    filter->payload_prefix = _zd_memdup(options->filter_payload_prefix,
+                                        filter->payload_prefix_len);
+    if (!filter->payload_prefix) return false;
+    filter->enabled = true;
+  }
+  if (options->filter_attachment_prefix != NULL) {
+    filter->attachment_prefix_len = options->filter_attachment_prefix_len;
+    filter->attachment_prefix = _zd_memdup(options->filter_attachment_prefix,
+                                           filter->attachment_prefix_len);
+    if (!filter->attachment_prefix) return false;
+    filter->enabled = true;
+  }
+  if (options->filter_exclude_keyexprs_len > 0) {
+    filter->exclude = (z_owned_keyexpr_t*)malloc(
+        options->filter_exclude_keyexprs_len * sizeof(z_owned_keyexpr_t));
+    if (!filter->exclude) return false;
+    for (size_t i = 0; i < options->filter_exclude_keyexprs_len; i++) {
+      if (z_keyexpr_from_str(&filter->exclude[i],
+                             options->filter_exclude_keyexprs[i]) != 0) {
+        return false;
+      }
+      filter->exclude_len++;
+    }
+    filter->enabled = true;
+  }
+  return true;
+}
+
+/// Returns true if `bytes` starts with `prefix`, reading it in small
+/// chunks so fragmented payloads are neither flattened nor allocated.
+static bool _zd_bytes_has_prefix(const z_loaned_bytes_t* bytes,
+                                 const uint8_t* prefix, size_t prefix_len) {
+  if (z_bytes_len(bytes) < prefix_len) return false;
+  z_bytes_reader_t reader = z_bytes_get_reader(bytes);
+  uint8_t chunk[64];
+  size_t matched = 0;
+  while (matched < prefix_len) {
+    size_t want = prefix_len - matched;
+    if (want > sizeof(chunk)) want = sizeof(chunk);
+    size_t got = z_bytes_reader_read(&reader, chunk, want);
+    if (got == 0 || memcmp(chunk, prefix + matched, got) != 0) return false;
+    matched += got;
+  }
+  return true;
+}
+
+/// Evaluates the filters against `sample`, cheapest checks first.
+static bool _zd_sample_filter_accepts(const zd_sample_filter_t* filter,
+                                      const z_loaned_sample_t* sample) {
+  if (filter->kind >= 0 && (int8_t)z_sample_kind(sample) != filter->kind) {
+    return false;
+  }
+  const z_loaned_bytes_t* payload = z_sample_payload(sample);
+  size_t payload_len = z_bytes_len(payload);
+  if (payload_len < filter->min_payload_len ||
+      payload_len > filter->max_payload_len) {
+    return false;
+  }
+  if (filter->payload_prefix != NULL &&
+      !_zd_bytes_has_prefix(payload, filter->payload_prefix,
+                            filter->payload_prefix_len)) {
+    return false;
+  }
+  if (filter->attachment_prefix != NULL) {
+    const z_loaned_bytes_t* attachment = z_sample_attachment(sample);
+    if (attachment == NULL ||
+        !_zd_bytes_has_prefix(attachment, filter->attachment_prefix,
+                              filter->attachment_prefix_len)) {
+      return false;
+    }
+  }
+  const z_loaned_keyexpr_t* key = z_sample_keyexpr(sample);
+  for (size_t i = 0; i < filter->exclude_len; i++) {
+    if (z_keyexpr_intersects(z_keyexpr_loan(&filter->exclude[i]), key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Subscriber counters live in a reference-counted block shared by the
+// caller and every context counting into them. The public struct comes
+// first, so a zd_subscriber_stats_t* addresses the block.
+
+typedef struct {
+  zd_subscriber_stats_t stats;
+  atomic_int refs;
+} zd_stats_block_t;
+
+static void _zd_stats_retain(zd_subscriber_stats_t* stats) {
+  atomic_fetch_add_explicit(&((zd_stats_block_t*)stats)->refs, 1,
+                            memory_order_relaxed);
+}
+
+static void _zd_stats_release(zd_subscriber_stats_t* stats) {
+  zd_stats_block_t* block = (zd_stats_block_t*)stats;
+  if (atomic_fetch_sub_explicit(&block->refs, 1, memory_order_acq_rel) == 1) {
+    free(block);
+  }
+}
+
+/// Bumps one counter. The public struct keeps plain uint64_t fields so
+/// the header stays parseable by ffigen; updates go through atomics here.
+static void _zd_stats_count(uint64_t* counter) {
+  atomic_fetch_add_explicit((_Atomic uint64_t*)counter, 1,
+                            memory_order_relaxed);
+}
+
 /// Context struct passed to the closure callbacks.
 typedef struct {
   Dart_Port_DL dart_port;
+  bool zero_copy;
+  bool flat;
+  bool lazy;
+  /// ZD_SAMPLE_FIELD_* bits to extract.
+  uint32_t fields;
+  zd_sample_filter_t filter;
+  /// Counters the context holds a reference to, or NULL.
+  zd_subscriber_stats_t* stats;
+  /// Non-NULL when the subscriber batches samples.
+  zd_sample_batch_t* batch;
+  /// Non-NULL when the subscriber rate limits samples per key.
+  zd_rate_limiter_t* limiter;
+  /// In-flight limit the context holds a reference to, or NULL.
+  zd_flow_control_t* flow;
+  /// Interned key expressions (enabled when intern_max_keys > 0).
+  zd_keymap_t interned;
+  uint32_t intern_max_keys;
+  /// Cached encodings, indexed by id (enabled when encoding_cache_size > 0).
+  z_owned_encoding_t* encodings;
+  uint32_t encoding_count;
+  uint32_t encoding_cache_size;
+  /// Guards `interned` and `encodings`. Definition messages are posted
+  /// under it so they reach Dart before any sample using their id.
+  pthread_mutex_t def_mutex;
 } zd_subscriber_context_t;
 
-/// Sample callback: extracts fields and posts to Dart via native port.
-static void _zd_sample_callback(z_loaned_sample_t* sample, void* context) {
-  zd_subscriber_context_t* ctx = (zd_subscriber_context_t*)context;
+static bool _zd_sample_batch_start(zd_subscriber_context_t* ctx,
+                                   const zd_subscriber_options_t* options);
+static void _zd_sample_batch_stop(zd_subscriber_context_t* ctx);
+static bool _zd_rate_limiter_start(zd_subscriber_context_t* ctx,
+                                   const zd_subscriber_options_t* options);
+static void _zd_flow_control_bind(zd_flow_control_t* flow,
+                                  Dart_Port_DL dart_port,
+                                  zd_sample_batch_t* batch);
+static void _zd_flow_control_retain(zd_flow_control_t* flow);
+static void _zd_flow_control_unref(zd_flow_control_t* flow);
+
+/// Allocates a subscriber context for the given port.
+///
+/// A NULL `options` pointer selects the defaults from
+/// zd_subscriber_options_default(). Returns NULL on allocation failure.
+static zd_subscriber_context_t* _zd_subscriber_context_new(
+    int64_t dart_port, const zd_subscriber_options_t* options) {
+  zd_subscriber_options_t defaults;
+  if (options == NULL) {
+    zd_subscriber_options_default(&defaults);
+    options = &defaults;
+  }
+  zd_subscriber_context_t* ctx =
+      (zd_subscriber_context_t*)calloc(1, sizeof(zd_subscriber_context_t));
+  if (!ctx) return NULL;
+  ctx->dart_port = (Dart_Port_DL)dart_port;
+  ctx->zero_copy = options->zero_copy;
+  ctx->flat = options->flat;
+  ctx->lazy = options->lazy;
+  ctx->fields = options->fields;
+  ctx->stats = options->stats;
+  ctx->flow = options->flow_control;
+  ctx->intern_max_keys = options->intern_max_keys;
+  ctx->encoding_cache_size =
+      options->encoding_cache_size < ZD_ENCODING_CACHE_MAX
+          ? options->encoding_cache_size
+          : ZD_ENCODING_CACHE_MAX;
+  if (!_zd_sample_filter_init(&ctx->filter, options)) {
+    _zd_sample_filter_clear(&ctx->filter);
+    free(ctx);
+    return NULL;
+  }
+  if (ctx->encoding_cache_size > 0) {
+    ctx->encodings = (z_owned_encoding_t*)malloc(
+        ctx->encoding_cache_size * sizeof(z_owned_encoding_t));
+    if (!ctx->encodings) {
+      _zd_sample_filter_clear(&ctx->filter);
+      free(ctx);
+      return NULL;
+    }
+  }
+  pthread_mutex_init(&ctx->def_mutex, NULL);
+  if ((options->batch_max_samples > 1 &&
+       !_zd_sample_batch_start(ctx, options)) ||
+      (options->rate_limit_interval_us > 0 &&
+       !_zd_rate_limiter_start(ctx, options))) {
+    if (ctx->batch != NULL) _zd_sample_batch_stop(ctx);
+    pthread_mutex_destroy(&ctx->def_mutex);
+    free(ctx->encodings);
+    _zd_sample_filter_clear(&ctx->filter);
+    free(ctx);
+    return NULL;
+  }
+  if (ctx->flow != NULL) {
+    _zd_flow_control_bind(ctx->flow, ctx->dart_port, ctx->batch);
+    _zd_flow_control_retain(ctx->flow);
+  }
+  if (ctx->stats != NULL) _zd_stats_retain(ctx->stats);
+  return ctx;
+}
+
+/// Finalizer for external typed data backed by a cloned z_owned_bytes_t.
+///
+/// Runs on the Dart side once the Uint8List is garbage collected, releasing
+/// the reference the clone holds on the zenoh buffer.
+static void _zd_owned_bytes_finalizer(void* isolate_callback_data,
+                                      void* peer) {
+  (void)isolate_callback_data;
+  z_owned_bytes_t* bytes = (z_owned_bytes_t*)peer;
+  z_bytes_drop(z_bytes_move(bytes));
+  free(bytes);
+}
+
+/// Finalizer for external typed data backed by a malloc'd buffer.
+static void _zd_free_finalizer(void* isolate_callback_data, void* peer) {
+  (void)isolate_callback_data;
+  free(peer);
+}
+
+/// Describes `bytes` as a Dart_CObject without flattening it through
+/// z_bytes_to_string.
+///
+/// A contiguous payload is cloned (a reference count bump, no copy) and
+/// posted as unmodifiable external typed data pointing straight into the
+/// zenoh buffer; the finalizer drops the clone. A fragmented payload is
+/// read once into a malloc'd buffer that Dart adopts. Empty payloads are
+/// posted as an empty typed data.
+///
+/// Returns false on allocation failure. If the post that carries `out`
+/// fails, the caller must release it with _zd_external_bytes_release().
+static bool _zd_external_bytes(const z_loaned_bytes_t* bytes,
+                               Dart_CObject* out) {
+  size_t len = z_bytes_len(bytes);
+  if (len == 0) {
+    out->type = Dart_CObject_kTypedData;
+    out->value.as_typed_data.type = Dart_TypedData_kUint8;
+    out->value.as_typed_data.length = 0;
+    out->value.as_typed_data.values = NULL;
+    return true;
+  }
+
+  z_owned_bytes_t* clone = (z_owned_bytes_t*)malloc(sizeof(z_owned_bytes_t));
+  if (!clone) return false;
+  z_bytes_clone(clone, bytes);
+
+  z_bytes_slice_iterator_t iter =
+      z_bytes_get_slice_iterator(z_bytes_loan(clone));
+  z_view_slice_t first;
+  z_view_slice_t next;
+  if (z_bytes_slice_iterator_next(&iter, &first) &&
+      !z_bytes_slice_iterator_next(&iter, &next)) {
+    const z_loaned_slice_t* slice = z_view_slice_loan(&first);
+    out->type = Dart_CObject_kUnmodifiableExternalTypedData;
+    out->value.as_external_typed_data.type = Dart_TypedData_kUint8;
+    out->value.as_external_typed_data.length = (intptr_t)z_slice_len(slice);
+    out->value.as_external_typed_data.data = (uint8_t*)z_slice_data(slice);
+    out->value.as_external_typed_data.peer = clone;
+    out->value.as_external_typed_data.callback = _zd_owned_bytes_finalizer;
+    return true;
+  }
+  z_bytes_drop(z_bytes_move(clone));
+  free(clone);
+
+  uint8_t* buf = (uint8_t*)malloc(len);
+  if (!buf) return false;
+  z_bytes_reader_t reader = z_bytes_get_reader(bytes);
+  z_bytes_reader_read(&reader, buf, len);
+  out->type = Dart_CObject_kExternalTypedData;
+  out->value.as_external_typed_data.type = Dart_TypedData_kUint8;
+  out->value.as_external_typed_data.length = (intptr_t)len;
+  out->value.as_external_typed_data.data = buf;
+  out->value.as_external_typed_data.peer = buf;
+  out->value.as_external_typed_data.callback = _zd_free_finalizer;
+  return true;
+}
+
+/// Releases an object filled by _zd_external_bytes() whose post failed.
+///
+/// Dart only takes ownership of external typed data (and runs its
+/// finalizer) when Dart_PostCObject_DL succeeds.
+static void _zd_external_bytes_release(Dart_CObject* obj) {
+  if (obj->type == Dart_CObject_kExternalTypedData ||
+      obj->type == Dart_CObject_kUnmodifiableExternalTypedData) {
+    obj->value.as_external_typed_data.callback(
+        NULL, obj->value.as_external_typed_data.peer);
+  }
+}
+
+/// Packs the timestamp, source and QoS of `sample` into `out`.
+static void _zd_sample_metadata_fill(const z_loaned_sample_t* sample,
+                                     zd_sample_metadata_t* out) {
+  memset(out, 0, sizeof(*out));
+  const z_timestamp_t* ts = z_sample_timestamp(sample);
+  if (ts != NULL) {
+    out->flags |= ZD_SAMPLE_META_HAS_TIMESTAMP;
+    out->timestamp = z_timestamp_ntp64_time(ts);
+    z_id_t ts_id = z_timestamp_id(ts);
+    memcpy(out->timestamp_id, ts_id.id, sizeof(out->timestamp_id));
+  }
+#if defined(Z_FEATURE_UNSTABLE_API)
+  const z_loaned_source_info_t* info = z_sample_source_info(sample);
+  if (info != NULL) {
+    out->flags |= ZD_SAMPLE_META_HAS_SOURCE;
+    z_entity_global_id_t gid = z_source_info_id(info);
+    z_id_t zid = z_entity_global_id_zid(&gid);
+    memcpy(out->source_zid, zid.id, sizeof(out->source_zid));
+    out->source_eid = z_entity_global_id_eid(&gid);
+    out->source_sn = z_source_info_sn(info);
+  }
+#endif
+  out->priority = (uint8_t)z_sample_priority(sample);
+  out->congestion_control = (uint8_t)z_sample_congestion_control(sample);
+  if (z_sample_express(sample)) {
+    out->flags |= ZD_SAMPLE_META_EXPRESS;
+  }
+}
+
+/// One sample converted to the Dart_CObject layout posted to Dart:
+/// [keyexpr(string), payload(Uint8List), kind(int64),
+///  attachment(null or Uint8List), encoding(string)] plus
+/// metadata(Uint8List) when requested, to a single
+/// buffer in the flat wire format (see zd_sample_wire_header_t), or for
+/// lazy subscribers to [sample_ptr(int64), keyexpr(string), kind(int64)].
+///
+/// Owns the buffers the objects point into until it is released, so a
+/// message can be posted on its own or held in a batch.
+typedef struct {
+  Dart_CObject c_keyexpr;
+  Dart_CObject c_payload;
+  Dart_CObject c_kind;
+  Dart_CObject c_attachment;
+  Dart_CObject c_encoding;
+  Dart_CObject c_metadata;
+  zd_sample_metadata_t metadata;
+  /// Cloned sample handed to Dart by lazy subscribers.
+  Dart_CObject c_handle;
+  z_owned_sample_t* handle;
+  Dart_CObject* elements[6];
+  Dart_CObject c_array;
+  /// Single external typed data object used by the flat wire format.
+  Dart_CObject c_flat;
+  /// The object to post: &c_array, or &c_flat for flat subscribers.
+  Dart_CObject* root;
+  char* key_buf;
+  char* enc_buf;
+  z_owned_string_t payload_str;
+  bool has_payload_str;
+  z_owned_string_t attachment_str;
+  bool has_attachment_str;
+  /// Key, payload and attachment bytes, used for batch byte limits.
+  size_t byte_size;
+} zd_sample_message_t;
+
+/// Copies a non null-terminated string into a malloc'd C string.
+static char* _zd_strndup(const char* data, size_t len) {
+  char* buf = (char*)malloc(len + 1);
+  if (!buf) return NULL;
+  memcpy(buf, data, len);
+  buf[len] = '\0';
+  return buf;
+}
+
+/// Frees the buffers held by a message.
+///
+/// External typed data is owned by Dart once posted; if `posted` is false
+/// it is released here instead.
+static void _zd_sample_message_release(zd_sample_message_t* msg,
+                                       bool posted) {
+  if (!posted) {
+    _zd_external_bytes_release(&msg->c_payload);
+    _zd_external_bytes_release(&msg->c_attachment);
+    _zd_external_bytes_release(&msg->c_flat);
+    if (msg->handle != NULL) {
+      z_sample_drop(z_sample_move(msg->handle));
+      free(msg->handle);
+    }
+  }
+  free(msg->key_buf);
+  free(msg->enc_buf);
+  if (msg->has_payload_str) {
+    z_string_drop(z_string_move(&msg->payload_str));
+  }
+  if (msg->has_attachment_str) {
+    z_string_drop(z_string_move(&msg->attachment_str));
+  }
+}
+
+/// Fills `msg` with `bytes` as a Uint8List object, copying through
+/// z_bytes_to_string unless the subscriber is zero-copy.
+static bool _zd_sample_message_set_bytes(zd_subscriber_context_t* ctx,
+                                         const z_loaned_bytes_t* bytes,
+                                         Dart_CObject* out,
+                                         z_owned_string_t* str,
+                                         bool* has_str) {
+  if (ctx->zero_copy) {
+    return _zd_external_bytes(bytes, out);
+  }
+  z_bytes_to_string(bytes, str);
+  *has_str = true;
+  const z_loaned_string_t* loaned = z_string_loan(str);
+  out->type = Dart_CObject_kTypedData;
+  out->value.as_typed_data.type = Dart_TypedData_kUint8;
+  out->value.as_typed_data.length = (intptr_t)z_string_len(loaned);
+  out->value.as_typed_data.values = (uint8_t*)z_string_data(loaned);
+  return true;
+}
+
+/// Field sizes and sources of one sample in the flat wire format, computed
+/// before the buffer is allocated so it can be sized exactly.
+typedef struct {
+  zd_sample_wire_header_t header;
+  zd_sample_metadata_t metadata;
+  const char* key_data;
+  const char* enc_data;
+  z_owned_string_t encoding_str;
+  bool has_encoding_str;
+  const z_loaned_bytes_t* payload;
+  const z_loaned_bytes_t* attachment;
+  /// Offset of the end of the attachment (start of the payload padding).
+  size_t head;
+  /// Total serialized size, including the payload.
+  size_t total;
+} zd_sample_wire_layout_t;
+
+/// Computes the flat wire layout of `sample`. A non-negative `key_id` or
+/// `encoding_id` replaces the corresponding string; fields missing from
+/// `fields` (ZD_SAMPLE_FIELD_* bits) are left out.
+///
+/// Release with _zd_sample_wire_layout_release() once written.
+static void _zd_sample_wire_layout(const z_loaned_sample_t* sample,
+                                   int64_t key_id, int64_t encoding_id,
+                                   uint32_t fields,
+                                   zd_sample_wire_layout_t* layout) {
+  memset(layout, 0, sizeof(*layout));
+  zd_sample_wire_header_t* header = &layout->header;
 
-  // 1. Key expression as string
   z_view_string_t key_view;
   z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_view);
   const z_loaned_string_t* key_loaned = z_view_string_loan(&key_view);
-  size_t key_len = z_string_len(key_loaned);
-  const char* key_data = z_string_data(key_loaned);
+  layout->key_data = z_string_data(key_loaned);
+  size_t key_len = key_id >= 0 ? 0 : z_string_len(key_loaned);
+
+  size_t enc_len = 0;
+  if (encoding_id < 0 && (fields & ZD_SAMPLE_FIELD_ENCODING) != 0) {
+    z_encoding_to_string(z_sample_encoding(sample), &layout->encoding_str);
+    layout->has_encoding_str = true;
+    const z_loaned_string_t* enc_loaned =
+        z_string_loan(&layout->encoding_str);
+    layout->enc_data = z_string_data(enc_loaned);
+    enc_len = z_string_len(enc_loaned);
+  }
 
-  // 2. Payload as bytes
-  const z_loaned_bytes_t* payload_loaned = z_sample_payload(sample);
-  z_owned_string_t payload_str;
-  z_bytes_to_string(payload_loaned, &payload_str);
-  const z_loaned_string_t* payload_str_loaned = z_string_loan(&payload_str);
-  size_t payload_len = z_string_len(payload_str_loaned);
-  const char* payload_data = z_string_data(payload_str_loaned);
+  bool with_payload = (fields & ZD_SAMPLE_FIELD_PAYLOAD) != 0;
+  layout->payload = z_sample_payload(sample);
+  layout->attachment = (fields & ZD_SAMPLE_FIELD_ATTACHMENT) != 0
+                           ? z_sample_attachment(sample)
+                           : NULL;
+  size_t payload_len = z_bytes_len(layout->payload);
+  size_t att_len =
+      layout->attachment != NULL ? z_bytes_len(layout->attachment) : 0;
+
+  size_t meta_len = 0;
+  if ((fields & ZD_SAMPLE_FIELD_METADATA) != 0) {
+    _zd_sample_metadata_fill(sample, &layout->metadata);
+    meta_len = sizeof(zd_sample_metadata_t);
+  }
+
+  layout->head = sizeof(zd_sample_wire_header_t) + meta_len + key_len +
+                 enc_len + att_len;
+  size_t payload_offset = (layout->head + 7) & ~(size_t)7;
+  layout->total = payload_offset + (with_payload ? payload_len : 0);
+
+  header->kind = (uint8_t)z_sample_kind(sample);
+  header->flags =
+      layout->attachment != NULL ? ZD_SAMPLE_WIRE_HAS_ATTACHMENT : 0;
+  header->key_len = (uint32_t)key_len;
+  if (key_id >= 0) {
+    header->flags |= ZD_SAMPLE_WIRE_KEY_ID;
+    header->key_len = (uint32_t)key_id;
+  }
+  if (encoding_id >= 0) {
+    header->flags |= ZD_SAMPLE_WIRE_ENCODING_ID;
+    header->encoding_id = (uint16_t)encoding_id;
+  }
+  if (!with_payload) {
+    header->flags |= ZD_SAMPLE_WIRE_NO_PAYLOAD;
+  }
+  if (meta_len > 0) {
+    header->flags |= ZD_SAMPLE_WIRE_METADATA;
+  }
+  header->encoding_len = (uint32_t)enc_len;
+  header->attachment_len = (uint32_t)att_len;
+  header->payload_offset = (uint32_t)payload_offset;
+  header->payload_len = (uint32_t)payload_len;
+}
+
+/// Writes a sample laid out by _zd_sample_wire_layout() into `buf`, which
+/// must hold `layout->total` bytes.
+///
+/// Payload and attachment are read straight into the buffer, so each byte
+/// is copied once.
+static void _zd_sample_wire_write(const zd_sample_wire_layout_t* layout,
+                                  uint8_t* buf) {
+  const zd_sample_wire_header_t* header = &layout->header;
+  memcpy(buf, header, sizeof(*header));
+
+  uint8_t* cursor = buf + sizeof(*header);
+  if ((header->flags & ZD_SAMPLE_WIRE_METADATA) != 0) {
+    memcpy(cursor, &layout->metadata, sizeof(layout->metadata));
+    cursor += sizeof(layout->metadata);
+  }
+  if ((header->flags & ZD_SAMPLE_WIRE_KEY_ID) == 0) {
+    memcpy(cursor, layout->key_data, header->key_len);
+    cursor += header->key_len;
+  }
+  if (header->encoding_len > 0) {
+    memcpy(cursor, layout->enc_data, header->encoding_len);
+    cursor += header->encoding_len;
+  }
+  if (header->attachment_len > 0) {
+    z_bytes_reader_t reader = z_bytes_get_reader(layout->attachment);
+    z_bytes_reader_read(&reader, cursor, header->attachment_len);
+  }
+  memset(buf + layout->head, 0, header->payload_offset - layout->head);
+  if (header->payload_len > 0 &&
+      (header->flags & ZD_SAMPLE_WIRE_NO_PAYLOAD) == 0) {
+    z_bytes_reader_t reader = z_bytes_get_reader(layout->payload);
+    z_bytes_reader_read(&reader, buf + header->payload_offset,
+                        header->payload_len);
+  }
+}
+
+static void _zd_sample_wire_layout_release(zd_sample_wire_layout_t* layout) {
+  if (layout->has_encoding_str) {
+    z_string_drop(z_string_move(&layout->encoding_str));
+  }
+}
+
+// Framed samples: an 8-byte prefix whose first uint32 is the length of the
+// flat wire sample that follows, padded to 8 bytes. Used by the sample
+// ring, the conflating subscriber and batched pull receives.
+#define ZD_SAMPLE_FRAME_HEADER 8
+
+/// Returns the size of the frame holding a sample laid out as `layout`.
+static size_t _zd_sample_frame_size(const zd_sample_wire_layout_t* layout) {
+  return (ZD_SAMPLE_FRAME_HEADER + layout->total + 7) & ~(size_t)7;
+}
+
+/// Writes the frame of a sample laid out as `layout` at `dst`, which must
+/// hold _zd_sample_frame_size() bytes.
+static void _zd_sample_frame_write(const zd_sample_wire_layout_t* layout,
+                                   uint8_t* dst) {
+  uint32_t frame_len = (uint32_t)layout->total;
+  memcpy(dst, &frame_len, sizeof(frame_len));
+  _zd_sample_wire_write(layout, dst + ZD_SAMPLE_FRAME_HEADER);
+}
+
+/// Serializes `sample` into one malloc'd buffer in the flat wire format
+/// and describes it as external typed data adopted by Dart, so Dart
+/// receives a single Uint8List per sample.
+static bool _zd_sample_message_init_flat(zd_subscriber_context_t* ctx,
+                                         const z_loaned_sample_t* sample,
+                                         int64_t key_id, int64_t encoding_id,
+                                         zd_sample_message_t* msg) {
+  zd_sample_wire_layout_t layout;
+  _zd_sample_wire_layout(sample, key_id, encoding_id, ctx->fields, &layout);
+
+  uint8_t* buf = (uint8_t*)malloc(layout.total);
+  if (!buf) {
+    _zd_sample_wire_layout_release(&layout);
+    return false;
+  }
+  _zd_sample_wire_write(&layout, buf);
+  _zd_sample_wire_layout_release(&layout);
+
+  msg->c_flat.type = Dart_CObject_kExternalTypedData;
+  msg->c_flat.value.as_external_typed_data.type = Dart_TypedData_kUint8;
+  msg->c_flat.value.as_external_typed_data.length = (intptr_t)layout.total;
+  msg->c_flat.value.as_external_typed_data.data = buf;
+  msg->c_flat.value.as_external_typed_data.peer = buf;
+  msg->c_flat.value.as_external_typed_data.callback = _zd_free_finalizer;
+  msg->root = &msg->c_flat;
+  msg->byte_size = layout.total;
+  return true;
+}
+
+/// Fills the key expression slot of `msg`: the interned `key_id` when
+/// non-negative, otherwise a copy of the key string.
+static bool _zd_sample_message_set_key(const z_loaned_sample_t* sample,
+                                       int64_t key_id,
+                                       zd_sample_message_t* msg) {
+  if (key_id >= 0) {
+    msg->c_keyexpr.type = Dart_CObject_kInt64;
+    msg->c_keyexpr.value.as_int64 = key_id;
+    return true;
+  }
+  z_view_string_t key_view;
+  z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_view);
+  const z_loaned_string_t* key_loaned = z_view_string_loan(&key_view);
+  size_t key_len = z_string_len(key_loaned);
+  // z_string_data may not be null-terminated, so copy to a buffer
+  msg->key_buf = _zd_strndup(z_string_data(key_loaned), key_len);
+  msg->c_keyexpr.type = Dart_CObject_kString;
+  msg->c_keyexpr.value.as_string = msg->key_buf;
+  msg->byte_size += key_len;
+  return msg->key_buf != NULL;
+}
+
+/// Clones `sample` to the heap and describes it as a
+/// [sample_ptr, keyexpr, kind] message. Payload, attachment, encoding and
+/// timestamp are left in the clone and read on demand through the
+/// zd_sample_* accessors.
+static bool _zd_sample_message_init_lazy(const z_loaned_sample_t* sample,
+                                         int64_t key_id,
+                                         zd_sample_message_t* msg) {
+  if (!_zd_sample_message_set_key(sample, key_id, msg)) {
+    free(msg->key_buf);
+    return false;
+  }
+  msg->handle = (z_owned_sample_t*)malloc(sizeof(z_owned_sample_t));
+  if (!msg->handle) {
+    free(msg->key_buf);
+    return false;
+  }
+  z_sample_clone(msg->handle, sample);
+
+  msg->c_handle.type = Dart_CObject_kInt64;
+  msg->c_handle.value.as_int64 = (int64_t)(intptr_t)msg->handle;
+  msg->c_kind.type = Dart_CObject_kInt64;
+  msg->c_kind.value.as_int64 = (int64_t)z_sample_kind(sample);
+
+  msg->elements[0] = &msg->c_handle;
+  msg->elements[1] = &msg->c_keyexpr;
+  msg->elements[2] = &msg->c_kind;
+  msg->c_array.type = Dart_CObject_kArray;
+  msg->c_array.value.as_array.length = 3;
+  msg->c_array.value.as_array.values = msg->elements;
+  msg->root = &msg->c_array;
+  return true;
+}
+
+/// Extracts the fields of `sample` into `msg`.
+///
+/// A non-negative `key_id` (see _zd_sample_intern_key()) or `encoding_id`
+/// (see _zd_sample_cache_encoding()) is sent in place of the string.
+///
+/// Returns false on allocation failure, in which case nothing needs to be
+/// released.
+static bool _zd_sample_message_init(zd_subscriber_context_t* ctx,
+                                    const z_loaned_sample_t* sample,
+                                    int64_t key_id, int64_t encoding_id,
+                                    zd_sample_message_t* msg) {
+  memset(msg, 0, sizeof(*msg));
+  if (ctx->lazy) {
+    return _zd_sample_message_init_lazy(sample, key_id, msg);
+  }
+  if (ctx->flat) {
+    return _zd_sample_message_init_flat(ctx, sample, key_id, encoding_id,
+                                        msg);
+  }
+  msg->c_payload.type = Dart_CObject_kNull;
+  msg->c_attachment.type = Dart_CObject_kNull;
+
+  // 1. Key expression as string, or its interned id
+  bool ok = _zd_sample_message_set_key(sample, key_id, msg);
+
+  // 2. Payload as bytes, or only its length if not requested
+  const z_loaned_bytes_t* payload = z_sample_payload(sample);
+  bool with_payload = (ctx->fields & ZD_SAMPLE_FIELD_PAYLOAD) != 0;
+  if (!with_payload) {
+    msg->c_payload.type = Dart_CObject_kInt64;
+    msg->c_payload.value.as_int64 = (int64_t)z_bytes_len(payload);
+  } else {
+    ok = ok && _zd_sample_message_set_bytes(ctx, payload, &msg->c_payload,
+                                            &msg->payload_str,
+                                            &msg->has_payload_str);
+  }
 
   // 3. Kind as int
-  z_sample_kind_t kind = z_sample_kind(sample);
+  msg->c_kind.type = Dart_CObject_kInt64;
+  msg->c_kind.value.as_int64 = (int64_t)z_sample_kind(sample);
 
   // 4. Attachment (nullable)
-  const z_loaned_bytes_t* attachment = z_sample_attachment(sample);
+  const z_loaned_bytes_t* attachment =
+      (ctx->fields & ZD_SAMPLE_FIELD_ATTACHMENT) != 0
+          ? z_sample_attachment(sample)
+          : NULL;
+  if (ok && attachment != NULL) {
+    ok = _zd_sample_message_set_bytes(ctx, attachment, &msg->c_attachment,
+                                      &msg->attachment_str,
+                                      &msg->has_attachment_str);
+  }
 
-  // 5. Encoding as string
-  const z_loaned_encoding_t* encoding = z_sample_encoding(sample);
-  z_owned_string_t encoding_str;
-  z_encoding_to_string(encoding, &encoding_str);
-  const z_loaned_string_t* enc_loaned = z_string_loan(&encoding_str);
-  size_t enc_len = z_string_len(enc_loaned);
-  const char* enc_data = z_string_data(enc_loaned);
+  // 5. Encoding as string, its cached id, or null if not requested
+  msg->c_encoding.type = Dart_CObject_kNull;
+  if (ok && encoding_id >= 0) {
+    msg->c_encoding.type = Dart_CObject_kInt64;
+    msg->c_encoding.value.as_int64 = encoding_id;
+  } else if (ok && (ctx->fields & ZD_SAMPLE_FIELD_ENCODING) != 0) {
+    z_owned_string_t encoding_str;
+    z_encoding_to_string(z_sample_encoding(sample), &encoding_str);
+    const z_loaned_string_t* enc_loaned = z_string_loan(&encoding_str);
+    msg->enc_buf =
+        _zd_strndup(z_string_data(enc_loaned), z_string_len(enc_loaned));
+    z_string_drop(z_string_move(&encoding_str));
+    msg->c_encoding.type = Dart_CObject_kString;
+    msg->c_encoding.value.as_string = msg->enc_buf;
+    ok = msg->enc_buf != NULL;
+  }
 
-  // Build Dart_CObject array: [keyexpr, payload, kind, attachment, encoding]
-  Dart_CObject c_keyexpr;
-  c_keyexpr.type = Dart_CObject_kString;
-  // z_string_data may not be null-terminated, so copy to a buffer
-  char* key_buf = (char*)malloc(key_len + 1);
-  memcpy(key_buf, key_data, key_len);
-  key_buf[key_len] = '\0';
-  c_keyexpr.value.as_string = key_buf;
+  if (!ok) {
+    _zd_sample_message_release(msg, false);
+    return false;
+  }
 
-  Dart_CObject c_payload;
-  c_payload.type = Dart_CObject_kTypedData;
-  c_payload.value.as_typed_data.type = Dart_TypedData_kUint8;
-  c_payload.value.as_typed_data.length = (intptr_t)payload_len;
-  c_payload.value.as_typed_data.values = (uint8_t*)payload_data;
+  // 6. Metadata as packed bytes, if requested
+  size_t length = 5;
+  if ((ctx->fields & ZD_SAMPLE_FIELD_METADATA) != 0) {
+    _zd_sample_metadata_fill(sample, &msg->metadata);
+    msg->c_metadata.type = Dart_CObject_kTypedData;
+    msg->c_metadata.value.as_typed_data.type = Dart_TypedData_kUint8;
+    msg->c_metadata.value.as_typed_data.length =
+        (intptr_t)sizeof(msg->metadata);
+    msg->c_metadata.value.as_typed_data.values = (uint8_t*)&msg->metadata;
+    msg->elements[5] = &msg->c_metadata;
+    length = 6;
+  }
+
+  msg->elements[0] = &msg->c_keyexpr;
+  msg->elements[1] = &msg->c_payload;
+  msg->elements[2] = &msg->c_kind;
+  msg->elements[3] = &msg->c_attachment;
+  msg->elements[4] = &msg->c_encoding;
+  msg->c_array.type = Dart_CObject_kArray;
+  msg->c_array.value.as_array.length = (intptr_t)length;
+  msg->c_array.value.as_array.values = msg->elements;
+  msg->root = &msg->c_array;
+
+  if (with_payload) {
+    msg->byte_size += z_bytes_len(payload);
+  }
+  if (attachment != NULL) {
+    msg->byte_size += z_bytes_len(attachment);
+  }
+  return true;
+}
+
+// Batching: samples are buffered natively and posted to Dart as one
+// Dart_CObject array of sample arrays when the count limit, the byte limit
+// or the deadline (measured from the first buffered sample) is reached. A
+// flusher thread enforces the deadline when no further samples arrive.
+
+struct zd_sample_batch_t {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t flusher;
+  bool stopping;
+  zd_sample_message_t** messages;
+  size_t count;
+  size_t bytes;
+  uint32_t max_samples;
+  size_t max_bytes;
+  uint32_t max_delay_us;
+  /// Flush deadline of the oldest buffered sample (CLOCK_MONOTONIC).
+  struct timespec deadline;
+};
+
+/// Returns the current CLOCK_MONOTONIC time advanced by `us` microseconds.
+static struct timespec _zd_monotonic_after_us(uint64_t us) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  ts.tv_sec += (time_t)(us / 1000000u);
+  ts.tv_nsec += (long)(us % 1000000u) * 1000L;
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec += 1;
+    ts.tv_nsec -= 1000000000L;
+  }
+  return ts;
+}
+
+/// Returns true if `deadline` is at or before the current monotonic time.
+static bool _zd_deadline_passed(const struct timespec* deadline) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec > deadline->tv_sec ||
+         (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+/// Posts all buffered samples as one message. Caller holds batch->mutex.
+///
+/// Posting under the lock keeps batches in order when the callback thread
+/// and the flusher thread race.
+static void _zd_sample_batch_flush_locked(zd_sample_batch_t* batch,
+                                          Dart_Port_DL dart_port) {
+  if (batch->count == 0) return;
+
+  Dart_CObject** items =
+      (Dart_CObject**)malloc(batch->count * sizeof(Dart_CObject*));
+  bool posted = false;
+  if (items) {
+    for (size_t i = 0; i < batch->count; i++) {
+      items[i] = batch->messages[i]->root;
+    }
+    Dart_CObject c_batch;
+    c_batch.type = Dart_CObject_kArray;
+    c_batch.value.as_array.length = (intptr_t)batch->count;
+    c_batch.value.as_array.values = items;
+    posted = Dart_PostCObject_DL(dart_port, &c_batch);
+    free(items);
+  }
+
+  for (size_t i = 0; i < batch->count; i++) {
+    _zd_sample_message_release(batch->messages[i], posted);
+    free(batch->messages[i]);
+  }
+  batch->count = 0;
+  batch->bytes = 0;
+}
+
+/// Flusher thread: posts a partial batch once its deadline has passed.
+static void* _zd_sample_batch_flusher(void* arg) {
+  zd_subscriber_context_t* ctx = (zd_subscriber_context_t*)arg;
+  zd_sample_batch_t* batch = ctx->batch;
+
+  pthread_mutex_lock(&batch->mutex);
+  while (!batch->stopping) {
+    if (batch->count == 0) {
+      pthread_cond_wait(&batch->cond, &batch->mutex);
+      continue;
+    }
+    struct timespec deadline = batch->deadline;
+    pthread_cond_timedwait(&batch->cond, &batch->mutex, &deadline);
+    if (batch->count > 0 && _zd_deadline_passed(&batch->deadline)) {
+      _zd_sample_batch_flush_locked(batch, ctx->dart_port);
+    }
+  }
+  pthread_mutex_unlock(&batch->mutex);
+  return NULL;
+}
+
+/// Creates the batch state for `ctx` and starts its flusher thread.
+static bool _zd_sample_batch_start(zd_subscriber_context_t* ctx,
+                                   const zd_subscriber_options_t* options) {
+  zd_sample_batch_t* batch =
+      (zd_sample_batch_t*)calloc(1, sizeof(zd_sample_batch_t));
+  if (!batch) return false;
+  batch->max_samples = options->batch_max_samples;
+  batch->max_bytes = options->batch_max_bytes;
+  batch->max_delay_us = options->batch_max_delay_us;
+  batch->messages = (zd_sample_message_t**)malloc(
+      batch->max_samples * sizeof(zd_sample_message_t*));
+  if (!batch->messages) {
+    free(batch);
+    return false;
+  }
+
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&batch->cond, &attr);
+  pthread_condattr_destroy(&attr);
+  pthread_mutex_init(&batch->mutex, NULL);
+
+  ctx->batch = batch;
+  if (pthread_create(&batch->flusher, NULL, _zd_sample_batch_flusher, ctx) !=
+      0) {
+    ctx->batch = NULL;
+    pthread_cond_destroy(&batch->cond);
+    pthread_mutex_destroy(&batch->mutex);
+    free(batch->messages);
+    free(batch);
+    return false;
+  }
+  return true;
+}
+
+/// Stops the flusher thread, posts any buffered samples and frees the
+/// batch state.
+static void _zd_sample_batch_stop(zd_subscriber_context_t* ctx) {
+  zd_sample_batch_t* batch = ctx->batch;
+  pthread_mutex_lock(&batch->mutex);
+  batch->stopping = true;
+  pthread_cond_signal(&batch->cond);
+  pthread_mutex_unlock(&batch->mutex);
+  pthread_join(batch->flusher, NULL);
+
+  _zd_sample_batch_flush_locked(batch, ctx->dart_port);
+  pthread_cond_destroy(&batch->cond);
+  pthread_mutex_destroy(&batch->mutex);
+  free(batch->messages);
+  free(batch);
+  ctx->batch = NULL;
+}
+
+/// Appends a message to the batch, flushing when a limit is reached.
+static void _zd_sample_batch_add(zd_subscriber_context_t* ctx,
+                                 zd_sample_message_t* msg) {
+  zd_sample_batch_t* batch = ctx->batch;
+  pthread_mutex_lock(&batch->mutex);
+  batch->messages[batch->count++] = msg;
+  batch->bytes += msg->byte_size;
+  if (batch->count >= batch->max_samples ||
+      (batch->max_bytes > 0 && batch->bytes >= batch->max_bytes)) {
+    _zd_sample_batch_flush_locked(batch, ctx->dart_port);
+  } else if (batch->count == 1) {
+    batch->deadline = _zd_monotonic_after_us(batch->max_delay_us);
+    pthread_cond_signal(&batch->cond);
+  }
+  pthread_mutex_unlock(&batch->mutex);
+}
+
+// Flow control: counts samples handed to Dart (posted or batched) until
+// Dart acknowledges them, and applies the overflow policy once
+// `max_in_flight` is reached. Drop-oldest keeps converted messages in a
+// ring of `max_in_flight` slots and posts them from zd_flow_control_ack().
+
+struct zd_flow_control_t {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  Dart_Port_DL dart_port;
+  uint32_t max_in_flight;
+  uint8_t policy;
+  bool closed;
+  uint32_t in_flight;
+  /// Drop-oldest overflow queue.
+  zd_sample_message_t** queue;
+  size_t queue_head;
+  size_t queue_count;
+  /// Batch of the bound subscriber (NULL = not batching).
+  zd_sample_batch_t* batch;
+  _Atomic uint64_t dropped;
+  /// Held by the caller and by the bound subscriber context.
+  int refs;
+};
+
+static void _zd_flow_control_bind(zd_flow_control_t* flow,
+                                  Dart_Port_DL dart_port,
+                                  zd_sample_batch_t* batch) {
+  pthread_mutex_lock(&flow->mutex);
+  flow->dart_port = dart_port;
+  flow->batch = batch;
+  pthread_mutex_unlock(&flow->mutex);
+}
+
+static void _zd_flow_control_retain(zd_flow_control_t* flow) {
+  pthread_mutex_lock(&flow->mutex);
+  flow->refs++;
+  pthread_mutex_unlock(&flow->mutex);
+}
+
+/// Drops a reference; the last one frees the flow. Queued samples were
+/// already released by zd_flow_control_close().
+static void _zd_flow_control_unref(zd_flow_control_t* flow) {
+  pthread_mutex_lock(&flow->mutex);
+  bool last = --flow->refs == 0;
+  pthread_mutex_unlock(&flow->mutex);
+  if (!last) return;
+  pthread_cond_destroy(&flow->cond);
+  pthread_mutex_destroy(&flow->mutex);
+  free(flow->queue);
+  free(flow);
+}
+
+static void _zd_flow_control_discard(zd_sample_message_t* msg) {
+  _zd_sample_message_release(msg, false);
+  free(msg);
+}
+
+/// Claims an in-flight slot for a sample under the drop-newest or block
+/// policy. Returns false if the sample must be dropped.
+static bool _zd_flow_control_acquire(zd_flow_control_t* flow) {
+  pthread_mutex_lock(&flow->mutex);
+  if (flow->policy == ZD_OVERFLOW_BLOCK) {
+    while (!flow->closed && flow->in_flight >= flow->max_in_flight) {
+      pthread_cond_wait(&flow->cond, &flow->mutex);
+    }
+  }
+  bool acquired = !flow->closed && flow->in_flight < flow->max_in_flight;
+  if (acquired) {
+    flow->in_flight++;
+  } else if (!flow->closed) {
+    atomic_fetch_add_explicit(&flow->dropped, 1, memory_order_relaxed);
+  }
+  pthread_mutex_unlock(&flow->mutex);
+  return acquired;
+}
+
+/// Claims an in-flight slot for `msg` under the drop-oldest policy.
+///
+/// Returns true if the caller should hand the message on now. Otherwise
+/// the message was queued behind earlier ones (evicting the oldest when
+/// the queue is full) or discarded because the flow is closed.
+static bool _zd_flow_control_admit(zd_flow_control_t* flow,
+                                   zd_sample_message_t* msg) {
+  pthread_mutex_lock(&flow->mutex);
+  if (flow->closed) {
+    pthread_mutex_unlock(&flow->mutex);
+    _zd_flow_control_discard(msg);
+    return false;
+  }
+  // Samples already queued go first, so only bypass an empty queue.
+  if (flow->queue_count == 0 && flow->in_flight < flow->max_in_flight) {
+    flow->in_flight++;
+    pthread_mutex_unlock(&flow->mutex);
+    return true;
+  }
+  zd_sample_message_t* evicted = NULL;
+  if (flow->queue_count == flow->max_in_flight) {
+    evicted = flow->queue[flow->queue_head];
+    flow->queue_head = (flow->queue_head + 1) % flow->max_in_flight;
+    flow->queue_count--;
+    atomic_fetch_add_explicit(&flow->dropped, 1, memory_order_relaxed);
+  }
+  flow->queue[(flow->queue_head + flow->queue_count) % flow->max_in_flight] =
+      msg;
+  flow->queue_count++;
+  pthread_mutex_unlock(&flow->mutex);
+  if (evicted != NULL) _zd_flow_control_discard(evicted);
+  return false;
+}
+
+/// Returns `count` in-flight slots, posting queued messages into the room
+/// this makes and waking blocked callbacks.
+static void _zd_flow_control_release(zd_flow_control_t* flow,
+                                     uint32_t count) {
+  pthread_mutex_lock(&flow->mutex);
+  flow->in_flight = count < flow->in_flight ? flow->in_flight - count : 0;
+  // Posting under the lock keeps queued samples in order with samples
+  // admitted concurrently by the callback. Samples admitted before them
+  // may still sit in the batch, so flush it first.
+  if (flow->batch != NULL && flow->queue_count > 0 &&
+      flow->in_flight < flow->max_in_flight) {
+    pthread_mutex_lock(&flow->batch->mutex);
+    _zd_sample_batch_flush_locked(flow->batch, flow->dart_port);
+    pthread_mutex_unlock(&flow->batch->mutex);
+  }
+  while (flow->queue_count > 0 && flow->in_flight < flow->max_in_flight) {
+    zd_sample_message_t* msg = flow->queue[flow->queue_head];
+    flow->queue_head = (flow->queue_head + 1) % flow->max_in_flight;
+    flow->queue_count--;
+    bool posted = Dart_PostCObject_DL(flow->dart_port, msg->root);
+    _zd_sample_message_release(msg, posted);
+    free(msg);
+    if (posted) flow->in_flight++;
+  }
+  pthread_cond_broadcast(&flow->cond);
+  pthread_mutex_unlock(&flow->mutex);
+}
 
+/// Definition message kinds, see _zd_post_definition().
+#define ZD_DEFINITION_KEYEXPR 0
+#define ZD_DEFINITION_ENCODING 1
+
+/// Posts a [kind(int64), id(int64), value(string)] definition binding an
+/// interned id to its string for the subscriber's Dart channel.
+///
+/// Returns false if the post failed; the id must then not be used.
+static bool _zd_post_definition(Dart_Port_DL dart_port, int64_t kind,
+                                int64_t id, const char* value) {
   Dart_CObject c_kind;
   c_kind.type = Dart_CObject_kInt64;
-  c_kind.value.as_int64 = (int64_t)kind;
+  c_kind.value.as_int64 = kind;
+  Dart_CObject c_id;
+  c_id.type = Dart_CObject_kInt64;
+  c_id.value.as_int64 = id;
+  Dart_CObject c_value;
+  c_value.type = Dart_CObject_kString;
+  c_value.value.as_string = (char*)value;
+  Dart_CObject* elements[3] = {&c_kind, &c_id, &c_value};
+  Dart_CObject c_def;
+  c_def.type = Dart_CObject_kArray;
+  c_def.value.as_array.length = 3;
+  c_def.value.as_array.values = elements;
+  return Dart_PostCObject_DL(dart_port, &c_def);
+}
+
+/// Returns the interned id of the sample's key expression, or -1 if the
+/// key is sent as a string (interning disabled or the table is full).
+///
+/// On first sight of a key, a [0, id(int64), keyexpr(string)] definition
+/// is posted before returning. Posting it under `def_mutex` guarantees it
+/// reaches Dart before any sample that carries the id. If the post fails,
+/// the key is not interned and is sent as a string.
+static int64_t _zd_sample_intern_key(zd_subscriber_context_t* ctx,
+                                     const z_loaned_sample_t* sample) {
+  if (ctx->intern_max_keys == 0) return -1;
 
-  Dart_CObject c_attachment;
-  z_owned_string_t attachment_str;
-  bool has_attachment = (attachment != NULL);
-  if (has_attachment) {
-    z_bytes_to_string(attachment, &attachment_str);
-    const z_loaned_string_t* att_loaned = z_string_loan(&attachment_str);
-    c_attachment.type = Dart_CObject_kTypedData;
-    c_attachment.value.as_typed_data.type = Dart_TypedData_kUint8;
-    c_attachment.value.as_typed_data.length = (intptr_t)z_string_len(att_loaned);
-    c_attachment.value.as_typed_data.values = (uint8_t*)z_string_data(att_loaned);
-  } else {
-    c_attachment.type = Dart_CObject_kNull;
+  z_view_string_t key_view;
+  z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_view);
+  const z_loaned_string_t* key_loaned = z_view_string_loan(&key_view);
+  const char* key_data = z_string_data(key_loaned);
+  size_t key_len = z_string_len(key_loaned);
+
+  int64_t id = -1;
+  pthread_mutex_lock(&ctx->def_mutex);
+  zd_keymap_entry_t* entry = _zd_keymap_find(&ctx->interned, key_data, key_len);
+  if (entry != NULL) {
+    id = entry->id;
+  } else if (ctx->interned.count < ctx->intern_max_keys) {
+    entry = _zd_keymap_insert(&ctx->interned, key_data, key_len);
+    if (entry != NULL) {
+      if (_zd_post_definition(ctx->dart_port, ZD_DEFINITION_KEYEXPR,
+                              entry->id, entry->key)) {
+        id = entry->id;
+      } else {
+        _zd_keymap_remove(&ctx->interned, entry);
+      }
+    }
+  }
+  pthread_mutex_unlock(&ctx->def_mutex);
+  return id;
+}
+
+/// Returns the cached id of `encoding`, or -1 if it is sent as a string
+/// (caching disabled or the cache is full).
+///
+/// Encodings are compared with z_encoding_equals, which is far cheaper
+/// than formatting them with z_encoding_to_string. On a miss the encoding
+/// is cloned into the cache and a [1, id(int64), encoding(string)]
+/// definition is posted under `def_mutex`; the entry is kept only if the
+/// post succeeds.
+static int64_t _zd_sample_cache_encoding(zd_subscriber_context_t* ctx,
+                                         const z_loaned_encoding_t* encoding) {
+  if (ctx->encoding_cache_size == 0) return -1;
+
+  int64_t id = -1;
+  pthread_mutex_lock(&ctx->def_mutex);
+  for (uint32_t i = 0; i < ctx->encoding_count; i++) {
+    if (z_encoding_equals(z_encoding_loan(&ctx->encodings[i]), encoding)) {
+      id = i;
+      break;
+    }
+  }
+  if (id < 0 && ctx->encoding_count < ctx->encoding_cache_size) {
+    z_owned_string_t encoding_str;
+    z_encoding_to_string(encoding, &encoding_str);
+    const z_loaned_string_t* enc_loaned = z_string_loan(&encoding_str);
+    char* enc_buf =
+        _zd_strndup(z_string_data(enc_loaned), z_string_len(enc_loaned));
+    z_string_drop(z_string_move(&encoding_str));
+    if (enc_buf != NULL) {
+      if (_zd_post_definition(ctx->dart_port, ZD_DEFINITION_ENCODING,
+                              ctx->encoding_count, enc_buf)) {
+        id = ctx->encoding_count;
+        z_encoding_clone(&ctx->encodings[ctx->encoding_count++], encoding);
+      }
+      free(enc_buf);
+    }
+  }
+  pthread_mutex_unlock(&ctx->def_mutex);
+  return id;
+}
+
+/// Converts an accepted sample and posts it to Dart, or adds it to the
+/// pending batch.
+static void _zd_sample_deliver(zd_subscriber_context_t* ctx,
+                               const z_loaned_sample_t* sample) {
+  int64_t key_id = _zd_sample_intern_key(ctx, sample);
+  // Lazy samples leave the encoding in the cloned sample.
+  int64_t encoding_id =
+      ctx->lazy || (ctx->fields & ZD_SAMPLE_FIELD_ENCODING) == 0
+          ? -1
+          : _zd_sample_cache_encoding(ctx, z_sample_encoding(sample));
+
+  zd_flow_control_t* flow = ctx->flow;
+  bool queueing = flow != NULL && flow->policy == ZD_OVERFLOW_DROP_OLDEST;
+  // Drop-newest and block decide before the sample is converted.
+  if (flow != NULL && !queueing && !_zd_flow_control_acquire(flow)) return;
+
+  if (ctx->batch != NULL || queueing) {
+    zd_sample_message_t* msg =
+        (zd_sample_message_t*)malloc(sizeof(zd_sample_message_t));
+    if (!msg || !_zd_sample_message_init(ctx, sample, key_id, encoding_id,
+                                         msg)) {
+      free(msg);
+      if (flow != NULL && !queueing) _zd_flow_control_release(flow, 1);
+      return;
+    }
+    if (queueing && !_zd_flow_control_admit(flow, msg)) return;
+    if (ctx->batch != NULL) {
+      _zd_sample_batch_add(ctx, msg);
+      return;
+    }
+    bool posted = Dart_PostCObject_DL(ctx->dart_port, msg->root);
+    _zd_sample_message_release(msg, posted);
+    free(msg);
+    if (!posted) _zd_flow_control_release(flow, 1);
+    return;
   }
 
-  Dart_CObject c_encoding;
-  char* enc_buf = (char*)malloc(enc_len + 1);
-  memcpy(enc_buf, enc_data, enc_len);
-  enc_buf[enc_len] = '\0';
-  c_encoding.type = Dart_CObject_kString;
-  c_encoding.value.as_string = enc_buf;
+  zd_sample_message_t msg;
+  if (!_zd_sample_message_init(ctx, sample, key_id, encoding_id, &msg)) {
+    if (flow != NULL) _zd_flow_control_release(flow, 1);
+    return;
+  }
+  bool posted = Dart_PostCObject_DL(ctx->dart_port, msg.root);
+  _zd_sample_message_release(&msg, posted);
+  if (!posted && flow != NULL) _zd_flow_control_release(flow, 1);
+}
 
-  Dart_CObject* elements[5] = {&c_keyexpr, &c_payload, &c_kind, &c_attachment, &c_encoding};
-  Dart_CObject c_array;
-  c_array.type = Dart_CObject_kArray;
-  c_array.value.as_array.length = 5;
-  c_array.value.as_array.values = elements;
+// Rate limiting: each key expression gets a slot in a zd_keymap_t holding
+// the earliest time its next sample may be delivered. In keep-latest mode
+// a sample arriving before that time is cloned into the slot, replacing
+// any sample already held there, and a releaser thread delivers it once
+// the slot opens. Once `max_keys` slots exist, idle slots are forgotten to
+// make room for new keys.
 
-  Dart_PostCObject_DL(ctx->dart_port, &c_array);
+typedef struct {
+  /// Earliest CLOCK_MONOTONIC time (ns) of the next delivery on this key.
+  uint64_t next_ns;
+  /// Held sample (keep-latest mode only).
+  z_owned_sample_t pending;
+  bool has_pending;
+} zd_rate_slot_t;
+
+struct zd_rate_limiter_t {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t releaser;
+  bool stopping;
+  uint64_t interval_ns;
+  uint8_t mode;
+  /// Maximum number of slots (0 = unbounded).
+  uint32_t max_keys;
+  zd_keymap_t slots;
+  /// Number of slots holding a sample.
+  size_t pending_count;
+};
+
+static uint64_t _zd_monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void _zd_rate_slot_free(void* value) {
+  zd_rate_slot_t* slot = (zd_rate_slot_t*)value;
+  if (slot->has_pending) z_sample_drop(z_sample_move(&slot->pending));
+  free(slot);
+}
+
+static void _zd_rate_limiter_count_drop(zd_subscriber_context_t* ctx) {
+  if (ctx->stats != NULL) _zd_stats_count(&ctx->stats->rate_limited);
+}
+
+/// Makes room for a new slot. Forgets every slot that holds no sample and
+/// whose interval has elapsed; if there is none, forgets the idle slot
+/// that opens soonest, whose key may then deliver early. Returns false if
+/// every slot holds a sample.
+static bool _zd_rate_limiter_evict(zd_rate_limiter_t* limiter, uint64_t now) {
+  size_t before = limiter->slots.count;
+  zd_keymap_entry_t* soonest = NULL;
+  // Walk backwards: a removal moves the last entry into the freed id.
+  for (size_t i = limiter->slots.count; i-- > 0;) {
+    zd_keymap_entry_t* entry = limiter->slots.entries[i];
+    zd_rate_slot_t* slot = (zd_rate_slot_t*)entry->value;
+    if (slot->has_pending) continue;
+    if (now >= slot->next_ns) {
+      _zd_rate_slot_free(slot);
+      _zd_keymap_remove(&limiter->slots, entry);
+    } else if (soonest == NULL ||
+               slot->next_ns < ((zd_rate_slot_t*)soonest->value)->next_ns) {
+      soonest = entry;
+    }
+  }
+  if (limiter->slots.count < before) return true;
+  if (soonest == NULL) return false;
+  _zd_rate_slot_free(soonest->value);
+  _zd_keymap_remove(&limiter->slots, soonest);
+  return true;
+}
+
+/// Returns true if `sample` may be delivered now. Otherwise the sample is
+/// dropped or, in keep-latest mode, held for the releaser thread.
+static bool _zd_rate_limiter_admit(zd_subscriber_context_t* ctx,
+                                   const z_loaned_sample_t* sample) {
+  zd_rate_limiter_t* limiter = ctx->limiter;
+  z_view_string_t key_view;
+  z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_view);
+  const z_loaned_string_t* key_loaned = z_view_string_loan(&key_view);
+  const char* key_data = z_string_data(key_loaned);
+  size_t key_len = z_string_len(key_loaned);
+  uint64_t now = _zd_monotonic_ns();
+
+  pthread_mutex_lock(&limiter->mutex);
+  zd_keymap_entry_t* entry =
+      _zd_keymap_find(&limiter->slots, key_data, key_len);
+  if (entry == NULL) {
+    if (limiter->max_keys > 0 && limiter->slots.count >= limiter->max_keys &&
+        !_zd_rate_limiter_evict(limiter, now)) {
+      // Every slot holds a sample: deliver this key unlimited.
+      pthread_mutex_unlock(&limiter->mutex);
+      return true;
+    }
+    zd_rate_slot_t* slot = (zd_rate_slot_t*)calloc(1, sizeof(zd_rate_slot_t));
+    entry = slot ? _zd_keymap_insert(&limiter->slots, key_data, key_len)
+                 : NULL;
+    if (entry == NULL) {
+      // Out of memory: deliver unlimited rather than losing the sample.
+      free(slot);
+      pthread_mutex_unlock(&limiter->mutex);
+      return true;
+    }
+    entry->value = slot;
+  }
+  zd_rate_slot_t* slot = (zd_rate_slot_t*)entry->value;
+
+  bool admit = false;
+  if (now >= slot->next_ns && !slot->has_pending) {
+    slot->next_ns = now + limiter->interval_ns;
+    admit = true;
+  } else if (limiter->mode == ZD_RATE_LIMIT_KEEP_LATEST) {
+    if (slot->has_pending) {
+      z_sample_drop(z_sample_move(&slot->pending));
+      _zd_rate_limiter_count_drop(ctx);
+    } else {
+      slot->has_pending = true;
+      if (limiter->pending_count++ == 0) pthread_cond_signal(&limiter->cond);
+    }
+    z_sample_clone(&slot->pending, sample);
+  } else {
+    _zd_rate_limiter_count_drop(ctx);
+  }
+  pthread_mutex_unlock(&limiter->mutex);
+  return admit;
+}
+
+/// Releaser thread: delivers held samples whose slot has opened, then
+/// sleeps until the earliest remaining one is due.
+static void* _zd_rate_limiter_releaser(void* arg) {
+  zd_subscriber_context_t* ctx = (zd_subscriber_context_t*)arg;
+  zd_rate_limiter_t* limiter = ctx->limiter;
+  z_owned_sample_t* ready = NULL;
+  size_t ready_capacity = 0;
+
+  pthread_mutex_lock(&limiter->mutex);
+  while (!limiter->stopping) {
+    if (limiter->pending_count == 0) {
+      pthread_cond_wait(&limiter->cond, &limiter->mutex);
+      continue;
+    }
+    if (ready_capacity < limiter->pending_count) {
+      z_owned_sample_t* grown = (z_owned_sample_t*)realloc(
+          ready, limiter->pending_count * sizeof(z_owned_sample_t));
+      if (grown != NULL) {
+        ready = grown;
+        ready_capacity = limiter->pending_count;
+      }
+    }
 
-  // Cleanup
-  free(key_buf);
-  free(enc_buf);
-  z_string_drop(z_string_move(&payload_str));
-  z_string_drop(z_string_move(&encoding_str));
-  if (has_attachment) {
-    z_string_drop(z_string_move(&attachment_str));
+    uint64_t now = _zd_monotonic_ns();
+    uint64_t wake_ns = UINT64_MAX;
+    size_t ready_count = 0;
+    for (size_t i = 0; i < limiter->slots.count; i++) {
+      zd_rate_slot_t* slot = (zd_rate_slot_t*)limiter->slots.entries[i]->value;
+      if (!slot->has_pending) continue;
+      if (now >= slot->next_ns && ready_count < ready_capacity) {
+        ready[ready_count++] = slot->pending;
+        slot->has_pending = false;
+        slot->next_ns = now + limiter->interval_ns;
+        limiter->pending_count--;
+      } else if (slot->next_ns < wake_ns) {
+        wake_ns = slot->next_ns;
+      }
+    }
+
+    if (ready_count > 0) {
+      // Deliver without the lock so zenoh threads are not held up. A new
+      // sample on a released key arrives within its fresh interval and is
+      // held, so it cannot overtake the one being delivered here.
+      pthread_mutex_unlock(&limiter->mutex);
+      for (size_t i = 0; i < ready_count; i++) {
+        _zd_sample_deliver(ctx, z_sample_loan(&ready[i]));
+        z_sample_drop(z_sample_move(&ready[i]));
+      }
+      pthread_mutex_lock(&limiter->mutex);
+      continue;
+    }
+    // A due sample left behind because `ready` could not grow: retry
+    // shortly instead of spinning.
+    if (wake_ns <= now) wake_ns = now + 1000000ull;
+    if (wake_ns != UINT64_MAX) {
+      struct timespec deadline;
+      deadline.tv_sec = (time_t)(wake_ns / 1000000000ull);
+      deadline.tv_nsec = (long)(wake_ns % 1000000000ull);
+      pthread_cond_timedwait(&limiter->cond, &limiter->mutex, &deadline);
+    }
+  }
+  pthread_mutex_unlock(&limiter->mutex);
+  free(ready);
+  return NULL;
+}
+
+/// Creates the rate limit state for `ctx`, starting the releaser thread in
+/// keep-latest mode.
+static bool _zd_rate_limiter_start(zd_subscriber_context_t* ctx,
+                                   const zd_subscriber_options_t* options) {
+  zd_rate_limiter_t* limiter =
+      (zd_rate_limiter_t*)calloc(1, sizeof(zd_rate_limiter_t));
+  if (!limiter) return false;
+  limiter->interval_ns = (uint64_t)options->rate_limit_interval_us * 1000ull;
+  limiter->mode = options->rate_limit_mode;
+  limiter->max_keys = options->rate_limit_max_keys;
+
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&limiter->cond, &attr);
+  pthread_condattr_destroy(&attr);
+  pthread_mutex_init(&limiter->mutex, NULL);
+
+  ctx->limiter = limiter;
+  if (limiter->mode == ZD_RATE_LIMIT_KEEP_LATEST &&
+      pthread_create(&limiter->releaser, NULL, _zd_rate_limiter_releaser,
+                     ctx) != 0) {
+    ctx->limiter = NULL;
+    pthread_cond_destroy(&limiter->cond);
+    pthread_mutex_destroy(&limiter->mutex);
+    free(limiter);
+    return false;
   }
+  return true;
+}
+
+/// Stops the releaser thread and frees the rate limit state, dropping any
+/// held samples.
+static void _zd_rate_limiter_stop(zd_subscriber_context_t* ctx) {
+  zd_rate_limiter_t* limiter = ctx->limiter;
+  if (limiter->mode == ZD_RATE_LIMIT_KEEP_LATEST) {
+    pthread_mutex_lock(&limiter->mutex);
+    limiter->stopping = true;
+    pthread_cond_signal(&limiter->cond);
+    pthread_mutex_unlock(&limiter->mutex);
+    pthread_join(limiter->releaser, NULL);
+  }
+  _zd_keymap_clear(&limiter->slots, _zd_rate_slot_free);
+  pthread_cond_destroy(&limiter->cond);
+  pthread_mutex_destroy(&limiter->mutex);
+  free(limiter);
+  ctx->limiter = NULL;
 }
 
-/// Drop callback: frees the context struct.
-static void _zd_sample_drop(void* context) {
-  free(context);
+/// Sample callback: applies the filters and rate limit, then delivers.
+static void _zd_sample_callback(z_loaned_sample_t* sample, void* context) {
+  zd_subscriber_context_t* ctx = (zd_subscriber_context_t*)context;
+  if (ctx->filter.enabled &&
+      !_zd_sample_filter_accepts(&ctx->filter, sample)) {
+    if (ctx->stats != NULL) _zd_stats_count(&ctx->stats->filtered);
+    return;
+  }
+  if (ctx->limiter != NULL && !_zd_rate_limiter_admit(ctx, sample)) return;
+  _zd_sample_deliver(ctx, sample);
 }
 
-/// Drop callback that posts a null sentinel before freeing.
-/// Used by background subscribers to signal stream completion when the
-/// session closes and the background subscriber is dropped by zenoh-c.
-static void _zd_sample_drop_with_sentinel(void* context) {
+/// Frees a subscriber context, first posting any batched samples.
+static void _zd_subscriber_context_free(zd_subscriber_context_t* ctx) {
+  if (ctx->limiter != NULL) {
+    _zd_rate_limiter_stop(ctx);
+  }
+  if (ctx->batch != NULL) {
+    if (ctx->flow != NULL) {
+      _zd_flow_control_bind(ctx->flow, ctx->dart_port, NULL);
+    }
+    _zd_sample_batch_stop(ctx);
+  }
+  _zd_keymap_clear(&ctx->interned, NULL);
+  for (uint32_t i = 0; i < ctx->encoding_count; i++) {
+    z_encoding_drop(z_encoding_move(&ctx->encodings[i]));
+  }
+  free(ctx->encodings);
+  _zd_sample_filter_clear(&ctx->filter);
+  pthread_mutex_destroy(&ctx->def_mutex);
+  if (ctx->stats != NULL) _zd_stats_release(ctx->stats);
+  if (ctx->flow != NULL) _zd_flow_control_unref(ctx->flow);
+  free(ctx);
+}
+
+/// Drop callback: frees the context struct, then posts a null sentinel.
+///
+/// zenoh-c runs it once the last callback has returned, so the sentinel is
+/// the final message on the port: Dart closes the port when it arrives,
+/// after draining queued samples.
+static void _zd_sample_drop(void* context) {
   zd_subscriber_context_t* ctx = (zd_subscriber_context_t*)context;
+  Dart_Port_DL dart_port = ctx->dart_port;
+  _zd_subscriber_context_free(ctx);
   Dart_CObject null_obj;
   null_obj.type = Dart_CObject_kNull;
-  Dart_PostCObject_DL(ctx->dart_port, &null_obj);
-  free(context);
+  Dart_PostCObject_DL(dart_port, &null_obj);
+}
+
+FFI_PLUGIN_EXPORT void zd_subscriber_options_default(
+    zd_subscriber_options_t* options) {
+  options->zero_copy = false;
+  options->flat = false;
+  options->lazy = false;
+  options->fields = ZD_SAMPLE_FIELDS_ALL;
+  options->intern_max_keys = 0;
+  options->encoding_cache_size = 0;
+  options->batch_max_samples = 0;
+  options->batch_max_bytes = 0;
+  options->batch_max_delay_us = 1000;
+  options->filter_min_payload_len = 0;
+  options->filter_max_payload_len = SIZE_MAX;
+  options->filter_kind = -1;
+  options->filter_payload_prefix = NULL;
+  options->filter_payload_prefix_len = 0;
+  options->filter_attachment_prefix = NULL;
+  options->filter_attachment_prefix_len = 0;
+  options->filter_exclude_keyexprs = NULL;
+  options->filter_exclude_keyexprs_len = 0;
+  options->rate_limit_interval_us = 0;
+  options->rate_limit_mode = ZD_RATE_LIMIT_DROP_NEWEST;
+  options->rate_limit_max_keys = 4096;
+  options->stats = NULL;
+  options->flow_control = NULL;
+}
+
+FFI_PLUGIN_EXPORT zd_subscriber_stats_t* zd_subscriber_stats_new(void) {
+  zd_stats_block_t* block =
+      (zd_stats_block_t*)calloc(1, sizeof(zd_stats_block_t));
+  if (!block) return NULL;
+  atomic_init(&block->refs, 1);
+  return &block->stats;
+}
+
+FFI_PLUGIN_EXPORT void zd_subscriber_stats_free(zd_subscriber_stats_t* stats) {
+  _zd_stats_release(stats);
+}
+
+FFI_PLUGIN_EXPORT zd_flow_control_t* zd_flow_control_new(
+    uint32_t max_in_flight, uint8_t policy) {
+  if (max_in_flight == 0) max_in_flight = 1;
+  zd_flow_control_t* flow =
+      (zd_flow_control_t*)calloc(1, sizeof(zd_flow_control_t));
+  if (!flow) return NULL;
+  if (policy == ZD_OVERFLOW_DROP_OLDEST) {
+    flow->queue = (zd_sample_message_t**)malloc(
+        max_in_flight * sizeof(zd_sample_message_t*));
+    if (!flow->queue) {
+      free(flow);
+      return NULL;
+    }
+  }
+  flow->max_in_flight = max_in_flight;
+  flow->policy = policy;
+  flow->refs = 1;
+  atomic_init(&flow->dropped, 0);
+  pthread_mutex_init(&flow->mutex, NULL);
+  pthread_cond_init(&flow->cond, NULL);
+  return flow;
+}
+
+FFI_PLUGIN_EXPORT void zd_flow_control_ack(zd_flow_control_t* flow,
+                                           uint32_t count) {
+  _zd_flow_control_release(flow, count);
+}
+
+FFI_PLUGIN_EXPORT uint64_t zd_flow_control_dropped(zd_flow_control_t* flow) {
+  return atomic_load_explicit(&flow->dropped, memory_order_relaxed);
+}
+
+FFI_PLUGIN_EXPORT void zd_flow_control_close(zd_flow_control_t* flow) {
+  pthread_mutex_lock(&flow->mutex);
+  flow->closed = true;
+  while (flow->queue_count > 0) {
+    _zd_flow_control_discard(flow->queue[flow->queue_head]);
+    flow->queue_head = (flow->queue_head + 1) % flow->max_in_flight;
+    flow->queue_count--;
+  }
+  pthread_cond_broadcast(&flow->cond);
+  pthread_mutex_unlock(&flow->mutex);
+}
+
+FFI_PLUGIN_EXPORT void zd_flow_control_free(zd_flow_control_t* flow) {
+  if (flow == NULL) return;
+  zd_flow_control_close(flow);
+  _zd_flow_control_unref(flow);
 }
 
 FFI_PLUGIN_EXPORT size_t zd_subscriber_sizeof(void) {
@@ -347,11 +2182,10 @@ FFI_PLUGIN_EXPORT int zd_declare_subscriber(
     const z_loaned_session_t* session,
     z_owned_subscriber_t* subscriber,
     const z_loaned_keyexpr_t* keyexpr,
-    int64_t dart_port) {
-  zd_subscriber_context_t* ctx =
-      (zd_subscriber_context_t*)malloc(sizeof(zd_subscriber_context_t));
+    int64_t dart_port,
+    const zd_subscriber_options_t* options) {
+  zd_subscriber_context_t* ctx = _zd_subscriber_context_new(dart_port, options);
   if (!ctx) return -1;
-  ctx->dart_port = (Dart_Port_DL)dart_port;
 
   z_owned_closure_sample_t callback;
   z_closure_sample(&callback, _zd_sample_callback, _zd_sample_drop, ctx);
@@ -375,21 +2209,19 @@ FFI_PLUGIN_EXPORT void zd_subscriber_drop(z_owned_subscriber_t* subscriber) {
 FFI_PLUGIN_EXPORT int8_t zd_declare_background_subscriber(
     const z_loaned_session_t* session,
     const char* key_expr,
-    int64_t dart_port) {
+    int64_t dart_port,
+    const zd_subscriber_options_t* options) {
   // Validate key expression
   z_view_keyexpr_t ke;
   if (z_view_keyexpr_from_str(&ke, key_expr) != 0) {
     return -1;
   }
 
-  zd_subscriber_context_t* ctx =
-      (zd_subscriber_context_t*)malloc(sizeof(zd_subscriber_context_t));
+  zd_subscriber_context_t* ctx = _zd_subscriber_context_new(dart_port, options);
   if (!ctx) return -1;
-  ctx->dart_port = (Dart_Port_DL)dart_port;
 
   z_owned_closure_sample_t callback;
-  z_closure_sample(&callback, _zd_sample_callback,
-                   _zd_sample_drop_with_sentinel, ctx);
+  z_closure_sample(&callback, _zd_sample_callback, _zd_sample_drop, ctx);
 
   int rc = z_declare_background_subscriber(
       session, z_view_keyexpr_loan(&ke),
@@ -402,6 +2234,168 @@ FFI_PLUGIN_EXPORT int8_t zd_declare_background_subscriber(
   return rc;
 }
 
+// Sharded subscribers: one zenoh subscriber whose callback routes each
+// sample to one of several complete subscriber contexts.
+
+typedef struct {
+  zd_subscriber_context_t** shards;
+  size_t shard_count;
+  uint8_t mode;
+  _Atomic size_t next;
+} zd_shard_router_t;
+
+static void _zd_shard_router_free(zd_shard_router_t* router) {
+  for (size_t i = 0; i < router->shard_count; i++) {
+    if (router->shards[i] == NULL) continue;
+    Dart_Port_DL dart_port = router->shards[i]->dart_port;
+    _zd_subscriber_context_free(router->shards[i]);
+    Dart_CObject null_obj;
+    null_obj.type = Dart_CObject_kNull;
+    Dart_PostCObject_DL(dart_port, &null_obj);
+  }
+  free(router->shards);
+  free(router);
+}
+
+/// Sample callback: picks a shard and runs the regular callback on it.
+static void _zd_sharded_sample_callback(z_loaned_sample_t* sample,
+                                        void* context) {
+  zd_shard_router_t* router = (zd_shard_router_t*)context;
+  size_t shard;
+  if (router->mode == ZD_SHARD_BY_KEY) {
+    z_view_string_t key_view;
+    z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_view);
+    const z_loaned_string_t* key_loaned = z_view_string_loan(&key_view);
+    uint64_t hash = _zd_keymap_hash(z_string_data(key_loaned),
+                                    z_string_len(key_loaned));
+    shard = (size_t)(hash % router->shard_count);
+  } else {
+    shard = atomic_fetch_add_explicit(&router->next, 1,
+                                      memory_order_relaxed) %
+            router->shard_count;
+  }
+  _zd_sample_callback(sample, router->shards[shard]);
+}
+
+/// Drop callback: frees every shard, posting a null sentinel to each port
+/// so worker streams complete.
+static void _zd_sharded_sample_drop(void* context) {
+  _zd_shard_router_free((zd_shard_router_t*)context);
+}
+
+FFI_PLUGIN_EXPORT int zd_declare_sharded_subscriber(
+    const z_loaned_session_t* session,
+    z_owned_subscriber_t* subscriber,
+    const z_loaned_keyexpr_t* keyexpr,
+    const int64_t* dart_ports,
+    size_t shard_count,
+    uint8_t mode,
+    const zd_subscriber_options_t* options) {
+  // A flow control is bound to a single port, and rate limit state is per
+  // shard, so round-robin would multiply the rate of every key.
+  if (shard_count == 0 ||
+      (options != NULL &&
+       (options->flow_control != NULL ||
+        (mode == ZD_SHARD_ROUND_ROBIN &&
+         options->rate_limit_interval_us > 0)))) {
+    return -1;
+  }
+
+  zd_shard_router_t* router =
+      (zd_shard_router_t*)calloc(1, sizeof(zd_shard_router_t));
+  if (!router) return -1;
+  router->shards = (zd_subscriber_context_t**)calloc(
+      shard_count, sizeof(zd_subscriber_context_t*));
+  if (!router->shards) {
+    free(router);
+    return -1;
+  }
+  router->shard_count = shard_count;
+  router->mode = mode;
+  atomic_init(&router->next, 0);
+  for (size_t i = 0; i < shard_count; i++) {
+    router->shards[i] = _zd_subscriber_context_new(dart_ports[i], options);
+    if (router->shards[i] == NULL) {
+      _zd_shard_router_free(router);
+      return -1;
+    }
+  }
+
+  z_owned_closure_sample_t callback;
+  z_closure_sample(&callback, _zd_sharded_sample_callback,
+                   _zd_sharded_sample_drop, router);
+
+  int rc = z_declare_subscriber(session, subscriber, keyexpr,
+                                z_closure_sample_move(&callback), NULL);
+  if (rc != 0) {
+    z_closure_sample_drop(z_closure_sample_move(&callback));
+  }
+  return rc;
+}
+
+// ---------------------------------------------------------------------------
+// Lazy sample accessors
+// ---------------------------------------------------------------------------
+
+/// Copies `bytes` into `out` through a reader, which handles fragmented
+/// buffers without flattening them first. Returns the full length.
+static int64_t _zd_bytes_copy(const z_loaned_bytes_t* bytes, uint8_t* out,
+                              size_t max_len) {
+  size_t len = z_bytes_len(bytes);
+  size_t copy_len = len < max_len ? len : max_len;
+  if (out != NULL && copy_len > 0) {
+    z_bytes_reader_t reader = z_bytes_get_reader(bytes);
+    z_bytes_reader_read(&reader, out, copy_len);
+  }
+  return (int64_t)len;
+}
+
+FFI_PLUGIN_EXPORT int64_t zd_sample_payload(const uint8_t* sample,
+                                            uint8_t* payload_out,
+                                            size_t max_len) {
+  const z_loaned_sample_t* s = z_sample_loan((const z_owned_sample_t*)sample);
+  return _zd_bytes_copy(z_sample_payload(s), payload_out, max_len);
+}
+
+FFI_PLUGIN_EXPORT int64_t zd_sample_attachment(const uint8_t* sample,
+                                               uint8_t* attachment_out,
+                                               size_t max_len) {
+  const z_loaned_sample_t* s = z_sample_loan((const z_owned_sample_t*)sample);
+  const z_loaned_bytes_t* attachment = z_sample_attachment(s);
+  if (attachment == NULL) return -1;
+  return _zd_bytes_copy(attachment, attachment_out, max_len);
+}
+
+FFI_PLUGIN_EXPORT char* zd_sample_encoding(const uint8_t* sample) {
+  const z_loaned_sample_t* s = z_sample_loan((const z_owned_sample_t*)sample);
+  z_owned_string_t enc_str;
+  z_encoding_to_string(z_sample_encoding(s), &enc_str);
+  const z_loaned_string_t* enc_loaned = z_string_loan(&enc_str);
+  char* buf = _zd_strndup(z_string_data(enc_loaned), z_string_len(enc_loaned));
+  z_string_drop(z_string_move(&enc_str));
+  return buf;
+}
+
+FFI_PLUGIN_EXPORT bool zd_sample_timestamp(const uint8_t* sample,
+                                           uint64_t* ntp64_out) {
+  const z_loaned_sample_t* s = z_sample_loan((const z_owned_sample_t*)sample);
+  const z_timestamp_t* ts = z_sample_timestamp(s);
+  if (ts == NULL) return false;
+  *ntp64_out = z_timestamp_ntp64_time(ts);
+  return true;
+}
+
+FFI_PLUGIN_EXPORT void zd_sample_metadata(
+    const uint8_t* sample, zd_sample_metadata_t* metadata_out) {
+  const z_loaned_sample_t* s = z_sample_loan((const z_owned_sample_t*)sample);
+  _zd_sample_metadata_fill(s, metadata_out);
+}
+
+FFI_PLUGIN_EXPORT void zd_sample_drop(uint8_t* sample) {
+  z_sample_drop(z_sample_move((z_owned_sample_t*)sample));
+  free(sample);
+}
+
 // ---------------------------------------------------------------------------
 // Publisher
 // ---------------------------------------------------------------------------
@@ -452,15 +2446,14 @@ FFI_PLUGIN_EXPORT int zd_publisher_put(
     const z_loaned_publisher_t* publisher,
     z_owned_bytes_t* payload,
     const char* encoding,
+    const z_owned_encoding_t* compiled_encoding,
     z_owned_bytes_t* attachment) {
   z_publisher_put_options_t opts;
   z_publisher_put_options_default(&opts);
 
   z_owned_encoding_t owned_encoding;
-  if (encoding != NULL) {
-    z_encoding_from_str(&owned_encoding, encoding);
-    opts.encoding = z_encoding_move(&owned_encoding);
-  }
+  opts.encoding =
+      _zd_encoding_option(compiled_encoding, encoding, &owned_encoding);
   if (attachment != NULL) {
     opts.attachment = z_bytes_move(attachment);
   }
@@ -468,6 +2461,151 @@ FFI_PLUGIN_EXPORT int zd_publisher_put(
   return z_publisher_put(publisher, z_bytes_move(payload), &opts);
 }
 
+FFI_PLUGIN_EXPORT int zd_publisher_put_batch(
+    const z_loaned_publisher_t* publisher,
+    const uint8_t* const* payloads,
+    const size_t* payload_lens,
+    const uint8_t* const* attachments,
+    const size_t* attachment_lens,
+    int32_t count,
+    const char* encoding,
+    const z_owned_encoding_t* compiled_encoding,
+    int32_t* published_out) {
+  *published_out = 0;
+
+  // Parse the encoding once, unless it comes pre-parsed; each put
+  // consumes a clone of it.
+  z_owned_encoding_t batch_encoding;
+  bool parsed = compiled_encoding == NULL && encoding != NULL;
+  if (parsed) {
+    z_result_t rc = z_encoding_from_str(&batch_encoding, encoding);
+    if (rc != Z_OK) return rc;
+    compiled_encoding = &batch_encoding;
+  }
+
+  int rc = Z_OK;
+  for (int32_t i = 0; i < count; i++) {
+    z_publisher_put_options_t opts;
+    z_publisher_put_options_default(&opts);
+
+    z_owned_encoding_t owned_encoding;
+    opts.encoding =
+        _zd_encoding_option(compiled_encoding, NULL, &owned_encoding);
+    z_owned_bytes_t owned_attachment;
+    if (attachments != NULL && attachments[i] != NULL) {
+      z_bytes_copy_from_buf(&owned_attachment, attachments[i],
+                            attachment_lens[i]);
+      opts.attachment = z_bytes_move(&owned_attachment);
+    }
+
+    z_owned_bytes_t payload;
+    rc = z_bytes_copy_from_buf(&payload, payloads[i], payload_lens[i]);
+    if (rc != Z_OK) {
+      // Release what the options would have consumed.
+      if (opts.encoding != NULL) z_encoding_drop(opts.encoding);
+      if (opts.attachment != NULL) z_bytes_drop(opts.attachment);
+      break;
+    }
+    rc = z_publisher_put(publisher, z_bytes_move(&payload), &opts);
+    if (rc != Z_OK) break;
+    (*published_out)++;
+  }
+
+  if (parsed) {
+    z_encoding_drop(z_encoding_move(&batch_encoding));
+  }
+  return rc;
+}
+
+typedef struct {
+  const z_loaned_publisher_t* publisher;
+  size_t payload_size;
+  uint64_t count;
+  uint64_t duration_us;
+  Dart_Port_DL dart_port;
+} zd_publisher_benchmark_t;
+
+static void* _zd_publisher_benchmark_run(void* arg) {
+  zd_publisher_benchmark_t* bench = (zd_publisher_benchmark_t*)arg;
+  uint64_t messages = 0;
+  int64_t rc = Z_EINVAL;
+
+  // Same payload pattern as z_pub_thr.
+  z_owned_bytes_t payload;
+  uint8_t* data = malloc(bench->payload_size > 0 ? bench->payload_size : 1);
+  if (data != NULL) {
+    for (size_t i = 0; i < bench->payload_size; i++) data[i] = i % 10;
+    rc = z_bytes_copy_from_buf(&payload, data, bench->payload_size);
+    free(data);
+  }
+
+  uint64_t start_ns = _zd_monotonic_ns();
+  if (rc == Z_OK) {
+    uint64_t deadline_ns =
+        bench->duration_us > 0 ? start_ns + bench->duration_us * 1000u : 0;
+    while (bench->count == 0 || messages < bench->count) {
+      // Reading the clock every message would show up at small payloads.
+      if (deadline_ns != 0 && (messages & 0xff) == 0 &&
+          _zd_monotonic_ns() >= deadline_ns) {
+        break;
+      }
+      z_owned_bytes_t clone;
+      z_bytes_clone(&clone, z_bytes_loan(&payload));
+      rc = z_publisher_put(bench->publisher, z_bytes_move(&clone), NULL);
+      if (rc != Z_OK) break;
+      messages++;
+    }
+    z_bytes_drop(z_bytes_move(&payload));
+  }
+  uint64_t elapsed_ns = _zd_monotonic_ns() - start_ns;
+
+  Dart_CObject c_messages;
+  c_messages.type = Dart_CObject_kInt64;
+  c_messages.value.as_int64 = (int64_t)messages;
+  Dart_CObject c_bytes;
+  c_bytes.type = Dart_CObject_kInt64;
+  c_bytes.value.as_int64 = (int64_t)(messages * bench->payload_size);
+  Dart_CObject c_elapsed;
+  c_elapsed.type = Dart_CObject_kInt64;
+  c_elapsed.value.as_int64 = (int64_t)elapsed_ns;
+  Dart_CObject c_rc;
+  c_rc.type = Dart_CObject_kInt64;
+  c_rc.value.as_int64 = rc;
+  Dart_CObject* elements[4] = {&c_messages, &c_bytes, &c_elapsed, &c_rc};
+  Dart_CObject c_result;
+  c_result.type = Dart_CObject_kArray;
+  c_result.value.as_array.length = 4;
+  c_result.value.as_array.values = elements;
+  Dart_PostCObject_DL(bench->dart_port, &c_result);
+
+  free(bench);
+  return NULL;
+}
+
+FFI_PLUGIN_EXPORT int zd_publisher_benchmark(
+    const z_loaned_publisher_t* publisher,
+    size_t payload_size,
+    uint64_t count,
+    uint64_t duration_us,
+    int64_t dart_port) {
+  if (count == 0 && duration_us == 0) return Z_EINVAL;
+  zd_publisher_benchmark_t* bench = malloc(sizeof(zd_publisher_benchmark_t));
+  if (bench == NULL) return Z_EINVAL;
+  bench->publisher = publisher;
+  bench->payload_size = payload_size;
+  bench->count = count;
+  bench->duration_us = duration_us;
+  bench->dart_port = (Dart_Port_DL)dart_port;
+
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, _zd_publisher_benchmark_run, bench) != 0) {
+    free(bench);
+    return Z_EINVAL;
+  }
+  pthread_detach(thread);
+  return 0;
+}
+
 FFI_PLUGIN_EXPORT int zd_publisher_delete(
     const z_loaned_publisher_t* publisher) {
   z_publisher_delete_options_t opts;
@@ -1097,7 +3235,8 @@ FFI_PLUGIN_EXPORT int8_t zd_query_reply(
     const uint8_t* query,
     const char* key_expr,
     uint8_t* payload,
-    const char* encoding) {
+    const char* encoding,
+    const uint8_t* compiled_encoding) {
   // Loan the cloned query
   const z_loaned_query_t* loaned = z_query_loan((z_owned_query_t*)query);
 
@@ -1112,10 +3251,8 @@ FFI_PLUGIN_EXPORT int8_t zd_query_reply(
   z_query_reply_options_default(&opts);
 
   z_owned_encoding_t owned_encoding;
-  if (encoding != NULL) {
-    z_encoding_from_str(&owned_encoding, encoding);
-    opts.encoding = z_encoding_move(&owned_encoding);
-  }
+  opts.encoding = _zd_encoding_option(
+      (const z_owned_encoding_t*)compiled_encoding, encoding, &owned_encoding);
 
   int rc = z_query_reply(
       loaned,
@@ -1262,31 +3399,161 @@ FFI_PLUGIN_EXPORT int8_t zd_bytes_is_shm(const uint8_t* bytes) {
 #endif // Z_FEATURE_SHARED_MEMORY && Z_FEATURE_UNSTABLE_API
 
 // ---------------------------------------------------------------------------
-// Pull Subscriber (ring channel)
+// Pull Subscriber (ring or FIFO channel)
 // ---------------------------------------------------------------------------
 
 FFI_PLUGIN_EXPORT int32_t zd_ring_handler_sample_sizeof(void) {
   return (int32_t)sizeof(z_owned_ring_handler_sample_t);
 }
 
+FFI_PLUGIN_EXPORT int32_t zd_fifo_handler_sample_sizeof(void) {
+  return (int32_t)sizeof(z_owned_fifo_handler_sample_t);
+}
+
+// The channel closure is wrapped so that every sample pushed into the
+// channel also bumps the waiter's arrival count, waking blocked receivers
+// and ringing an armed doorbell. The waiter is shared by the closure and
+// Dart and freed when both have released it.
+
+struct zd_pull_waiter_t {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  uint64_t arrivals;
+  bool closed;
+  bool armed;
+  Dart_Port_DL dart_port;
+  int refs;
+};
+
+typedef struct {
+  z_owned_closure_sample_t channel;
+  zd_pull_waiter_t* waiter;
+} zd_pull_context_t;
+
+static void _zd_pull_waiter_release(zd_pull_waiter_t* waiter) {
+  pthread_mutex_lock(&waiter->mutex);
+  bool last = --waiter->refs == 0;
+  pthread_mutex_unlock(&waiter->mutex);
+  if (!last) return;
+  pthread_mutex_destroy(&waiter->mutex);
+  pthread_cond_destroy(&waiter->cond);
+  free(waiter);
+}
+
+/// Records an arrival (or the end of the channel when `closing`), wakes
+/// blocked receivers and rings the doorbell if Dart armed it.
+static void _zd_pull_waiter_notify(zd_pull_waiter_t* waiter, bool closing) {
+  pthread_mutex_lock(&waiter->mutex);
+  if (closing) {
+    waiter->closed = true;
+  } else {
+    waiter->arrivals++;
+  }
+  bool wake = waiter->armed;
+  waiter->armed = false;
+  Dart_Port_DL dart_port = waiter->dart_port;
+  pthread_cond_broadcast(&waiter->cond);
+  pthread_mutex_unlock(&waiter->mutex);
+
+  if (wake) {
+    Dart_CObject c_doorbell;
+    c_doorbell.type = Dart_CObject_kNull;
+    Dart_PostCObject_DL(dart_port, &c_doorbell);
+  }
+}
+
+static void _zd_pull_sample_callback(z_loaned_sample_t* sample,
+                                     void* context) {
+  zd_pull_context_t* ctx = (zd_pull_context_t*)context;
+  // A full FIFO channel blocks here until Dart receives, which is the
+  // backpressure the FIFO variant exists for.
+  z_closure_sample_call(z_closure_sample_loan(&ctx->channel), sample);
+  _zd_pull_waiter_notify(ctx->waiter, false);
+}
+
+static void _zd_pull_sample_drop(void* context) {
+  zd_pull_context_t* ctx = (zd_pull_context_t*)context;
+  // Dropping the channel closure disconnects the channel; the handler
+  // still drains what is buffered.
+  z_closure_sample_drop(z_closure_sample_move(&ctx->channel));
+  _zd_pull_waiter_notify(ctx->waiter, true);
+  _zd_pull_waiter_release(ctx->waiter);
+  free(ctx);
+}
+
+static z_result_t _zd_pull_handler_try_recv(const uint8_t* handler,
+                                            int8_t channel,
+                                            z_owned_sample_t* sample) {
+  if (channel == ZD_PULL_CHANNEL_FIFO) {
+    return z_fifo_handler_sample_try_recv(
+        z_fifo_handler_sample_loan(
+            (const z_owned_fifo_handler_sample_t*)handler),
+        sample);
+  }
+  return z_ring_handler_sample_try_recv(
+      z_ring_handler_sample_loan((const z_owned_ring_handler_sample_t*)handler),
+      sample);
+}
+
+static void _zd_pull_handler_drop(uint8_t* handler, int8_t channel) {
+  if (channel == ZD_PULL_CHANNEL_FIFO) {
+    z_fifo_handler_sample_drop(
+        z_fifo_handler_sample_move((z_owned_fifo_handler_sample_t*)handler));
+  } else {
+    z_ring_handler_sample_drop(
+        z_ring_handler_sample_move((z_owned_ring_handler_sample_t*)handler));
+  }
+}
+
 FFI_PLUGIN_EXPORT int8_t zd_declare_pull_subscriber(
     uint8_t* subscriber_out, uint8_t* handler_out,
     const uint8_t* session, const char* key_expr,
-    int32_t capacity) {
+    int32_t capacity, int8_t channel, zd_pull_waiter_t** waiter_out) {
+  if (channel != ZD_PULL_CHANNEL_RING && channel != ZD_PULL_CHANNEL_FIFO) {
+    return -1;
+  }
   // Validate key expression
   z_view_keyexpr_t ke;
   if (z_view_keyexpr_from_str(&ke, key_expr) != 0) {
     return -1;
   }
 
-  // Create ring channel
-  z_owned_closure_sample_t closure;
-  z_ring_channel_sample_new(
-      &closure,
-      (z_owned_ring_handler_sample_t*)handler_out,
-      (size_t)capacity);
+  zd_pull_context_t* ctx =
+      (zd_pull_context_t*)calloc(1, sizeof(zd_pull_context_t));
+  zd_pull_waiter_t* waiter =
+      (zd_pull_waiter_t*)calloc(1, sizeof(zd_pull_waiter_t));
+  if (!ctx || !waiter) {
+    free(ctx);
+    free(waiter);
+    return -1;
+  }
+  pthread_mutex_init(&waiter->mutex, NULL);
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&waiter->cond, &attr);
+  pthread_condattr_destroy(&attr);
+  // One reference for the closure, one for the caller.
+  waiter->refs = 2;
+  ctx->waiter = waiter;
+
+  // Create the channel
+  if (channel == ZD_PULL_CHANNEL_FIFO) {
+    z_fifo_channel_sample_new(
+        &ctx->channel,
+        (z_owned_fifo_handler_sample_t*)handler_out,
+        (size_t)capacity);
+  } else {
+    z_ring_channel_sample_new(
+        &ctx->channel,
+        (z_owned_ring_handler_sample_t*)handler_out,
+        (size_t)capacity);
+  }
 
-  // Declare subscriber with ring closure
+  // Declare subscriber with the wrapping closure
+  z_owned_closure_sample_t closure;
+  z_closure_sample(&closure, _zd_pull_sample_callback, _zd_pull_sample_drop,
+                   ctx);
   int rc = z_declare_subscriber(
       (const z_loaned_session_t*)session,
       (z_owned_subscriber_t*)subscriber_out,
@@ -1295,24 +3562,83 @@ FFI_PLUGIN_EXPORT int8_t zd_declare_pull_subscriber(
       NULL);
 
   if (rc != 0) {
-    // On failure, drop the ring handler (closure was not consumed)
-    z_ring_handler_sample_drop(
-        z_ring_handler_sample_move((z_owned_ring_handler_sample_t*)handler_out));
+    // On failure, drop the closure (releasing the channel closure and the
+    // closure's waiter reference), then the handler and the caller's
+    // waiter reference.
+    z_closure_sample_drop(z_closure_sample_move(&closure));
+    _zd_pull_handler_drop(handler_out, channel);
+    _zd_pull_waiter_release(waiter);
+    return (int8_t)rc;
   }
 
-  return (int8_t)rc;
+  *waiter_out = waiter;
+  return 0;
+}
+
+FFI_PLUGIN_EXPORT uint64_t zd_pull_waiter_arrivals(zd_pull_waiter_t* waiter) {
+  pthread_mutex_lock(&waiter->mutex);
+  uint64_t arrivals = waiter->arrivals;
+  pthread_mutex_unlock(&waiter->mutex);
+  return arrivals;
+}
+
+FFI_PLUGIN_EXPORT int8_t zd_pull_waiter_wait(zd_pull_waiter_t* waiter,
+                                             uint64_t seen,
+                                             int64_t timeout_us) {
+  struct timespec deadline;
+  if (timeout_us >= 0) {
+    deadline = _zd_monotonic_after_us((uint64_t)timeout_us);
+  }
+  int8_t result = 1;
+  pthread_mutex_lock(&waiter->mutex);
+  for (;;) {
+    if (waiter->arrivals != seen) {
+      result = 0;
+      break;
+    }
+    if (waiter->closed) {
+      result = -1;
+      break;
+    }
+    if (timeout_us < 0) {
+      pthread_cond_wait(&waiter->cond, &waiter->mutex);
+    } else if (pthread_cond_timedwait(&waiter->cond, &waiter->mutex,
+                                      &deadline) == ETIMEDOUT) {
+      break;
+    }
+  }
+  pthread_mutex_unlock(&waiter->mutex);
+  return result;
+}
+
+FFI_PLUGIN_EXPORT int8_t zd_pull_waiter_arm(zd_pull_waiter_t* waiter,
+                                            int64_t dart_port,
+                                            uint64_t seen) {
+  int8_t result = 0;
+  pthread_mutex_lock(&waiter->mutex);
+  if (waiter->arrivals != seen) {
+    result = 1;
+  } else if (waiter->closed) {
+    result = -1;
+  } else {
+    waiter->armed = true;
+    waiter->dart_port = (Dart_Port_DL)dart_port;
+  }
+  pthread_mutex_unlock(&waiter->mutex);
+  return result;
+}
+
+FFI_PLUGIN_EXPORT void zd_pull_waiter_free(zd_pull_waiter_t* waiter) {
+  _zd_pull_waiter_release(waiter);
 }
 
 FFI_PLUGIN_EXPORT int8_t zd_pull_subscriber_try_recv(
-    const uint8_t* handler,
+    const uint8_t* handler, int8_t channel,
     char** out_keyexpr, uint8_t** out_payload, int32_t* out_payload_len,
     int8_t* out_kind, char** out_encoding,
     uint8_t** out_attachment, int32_t* out_attachment_len) {
-  const z_loaned_ring_handler_sample_t* h =
-      z_ring_handler_sample_loan((const z_owned_ring_handler_sample_t*)handler);
-
   z_owned_sample_t sample;
-  z_result_t res = z_ring_handler_sample_try_recv(h, &sample);
+  z_result_t res = _zd_pull_handler_try_recv(handler, channel, &sample);
 
   if (res == Z_CHANNEL_DISCONNECTED) {
     return 1;  // channel disconnected
@@ -1334,21 +3660,16 @@ FFI_PLUGIN_EXPORT int8_t zd_pull_subscriber_try_recv(
   memcpy(*out_keyexpr, key_data, key_len);
   (*out_keyexpr)[key_len] = '\0';
 
-  // 2. Payload as bytes (via string conversion, matching existing pattern)
+  // 2. Payload, read straight into a buffer of z_bytes_len() bytes: one
+  // copy, with no intermediate flattened string
   const z_loaned_bytes_t* payload_loaned = z_sample_payload(s);
   size_t payload_byte_len = z_bytes_len(payload_loaned);
-  if (payload_byte_len > 0) {
-    z_owned_string_t payload_str;
-    z_bytes_to_string(payload_loaned, &payload_str);
-    const z_loaned_string_t* pl_loaned = z_string_loan(&payload_str);
-    size_t pl_len = z_string_len(pl_loaned);
-    const char* pl_data = z_string_data(pl_loaned);
-    *out_payload = (uint8_t*)malloc(pl_len);
-    memcpy(*out_payload, pl_data, pl_len);
-    *out_payload_len = (int32_t)pl_len;
-    z_string_drop(z_string_move(&payload_str));
+  *out_payload = payload_byte_len > 0 ? (uint8_t*)malloc(payload_byte_len)
+                                      : NULL;
+  if (*out_payload != NULL) {
+    _zd_bytes_copy(payload_loaned, *out_payload, payload_byte_len);
+    *out_payload_len = (int32_t)payload_byte_len;
   } else {
-    *out_payload = NULL;
     *out_payload_len = 0;
   }
 
@@ -1373,18 +3694,12 @@ FFI_PLUGIN_EXPORT int8_t zd_pull_subscriber_try_recv(
 
   // 5. Attachment (nullable)
   const z_loaned_bytes_t* attachment = z_sample_attachment(s);
-  if (attachment != NULL) {
-    z_owned_string_t att_str;
-    z_bytes_to_string(attachment, &att_str);
-    const z_loaned_string_t* att_loaned = z_string_loan(&att_str);
-    size_t att_len = z_string_len(att_loaned);
-    const char* att_data = z_string_data(att_loaned);
-    *out_attachment = (uint8_t*)malloc(att_len);
-    memcpy(*out_attachment, att_data, att_len);
+  size_t att_len = attachment != NULL ? z_bytes_len(attachment) : 0;
+  *out_attachment = att_len > 0 ? (uint8_t*)malloc(att_len) : NULL;
+  if (*out_attachment != NULL) {
+    _zd_bytes_copy(attachment, *out_attachment, att_len);
     *out_attachment_len = (int32_t)att_len;
-    z_string_drop(z_string_move(&att_str));
   } else {
-    *out_attachment = NULL;
     *out_attachment_len = 0;
   }
 
@@ -1394,11 +3709,880 @@ FFI_PLUGIN_EXPORT int8_t zd_pull_subscriber_try_recv(
   return 0;  // success
 }
 
+/// Returns `buf` grown to hold at least `need` bytes, or NULL (leaving
+/// `buf` intact) if it cannot be grown. The result is never NULL on
+/// success, even for zero bytes.
+static void* _zd_pull_recv_reserve(void* buf, size_t* cap, size_t need) {
+  if (need == 0) need = 1;
+  if (need <= *cap) return buf;
+  size_t grown_cap = *cap * 2 > need ? *cap * 2 : need;
+  void* grown = realloc(buf, grown_cap);
+  if (grown != NULL) *cap = grown_cap;
+  return grown;
+}
+
+/// Fills `recv` from `s`. Every buffer is reserved before any field is
+/// written, so on failure `recv` still describes the previous sample and
+/// the changed flags stay valid for the next call.
+static bool _zd_pull_recv_fill(const z_loaned_sample_t* s,
+                               zd_pull_recv_t* recv) {
+  // 1. Key expression, copied only when it changed
+  z_view_string_t key_view;
+  z_keyexpr_as_view_string(z_sample_keyexpr(s), &key_view);
+  const z_loaned_string_t* key_loaned = z_view_string_loan(&key_view);
+  size_t key_len = z_string_len(key_loaned);
+  const char* key_data = z_string_data(key_loaned);
+  bool keyexpr_changed =
+      key_len != recv->keyexpr_len ||
+      (key_len > 0 && memcmp(recv->keyexpr, key_data, key_len) != 0);
+  if (keyexpr_changed) {
+    char* buf = (char*)_zd_pull_recv_reserve(recv->keyexpr,
+                                             &recv->keyexpr_cap, key_len);
+    if (buf == NULL) return false;
+    recv->keyexpr = buf;
+  }
+
+  // 2. Encoding, formatted only when it differs from the last one
+  const z_loaned_encoding_t* encoding = z_sample_encoding(s);
+  z_owned_encoding_t* last = (z_owned_encoding_t*)recv->last_encoding;
+  bool encoding_changed =
+      last == NULL || !z_encoding_equals(z_encoding_loan(last), encoding);
+  z_owned_string_t enc_str;
+  size_t enc_len = 0;
+  z_owned_encoding_t* new_last = NULL;
+  if (encoding_changed) {
+    z_encoding_to_string(encoding, &enc_str);
+    enc_len = z_string_len(z_string_loan(&enc_str));
+    char* buf = (char*)_zd_pull_recv_reserve(recv->encoding,
+                                             &recv->encoding_cap, enc_len);
+    if (buf != NULL) recv->encoding = buf;
+    if (buf != NULL && last == NULL) {
+      new_last = (z_owned_encoding_t*)malloc(sizeof(z_owned_encoding_t));
+    }
+    if (buf == NULL || (last == NULL && new_last == NULL)) {
+      z_string_drop(z_string_move(&enc_str));
+      return false;
+    }
+  }
+
+  // 3. Attachment (nullable)
+  const z_loaned_bytes_t* attachment = z_sample_attachment(s);
+  size_t att_len = attachment != NULL ? z_bytes_len(attachment) : 0;
+  uint8_t* att_buf = NULL;
+  if (attachment != NULL) {
+    att_buf = (uint8_t*)_zd_pull_recv_reserve(
+        recv->attachment, &recv->attachment_cap, att_len);
+    if (att_buf != NULL) recv->attachment = att_buf;
+  }
+
+  // 4. Payload: inline when small, otherwise a buffer handed to the caller
+  const z_loaned_bytes_t* payload = z_sample_payload(s);
+  size_t payload_len = z_bytes_len(payload);
+  bool payload_owned = payload_len > ZD_PULL_RECV_INLINE_SIZE;
+  uint8_t* payload_buf = NULL;
+  if (attachment == NULL || att_buf != NULL) {
+    payload_buf = payload_owned ? (uint8_t*)malloc(payload_len)
+                                : recv->inline_payload;
+  }
+  if (payload_buf == NULL) {
+    if (encoding_changed) z_string_drop(z_string_move(&enc_str));
+    free(new_last);
+    return false;
+  }
+
+  // 5. Everything is allocated: write the sample into `recv`
+  recv->keyexpr_changed = keyexpr_changed;
+  if (keyexpr_changed) {
+    memcpy(recv->keyexpr, key_data, key_len);
+    recv->keyexpr_len = key_len;
+  }
+  recv->kind = (int8_t)z_sample_kind(s);
+  recv->encoding_changed = encoding_changed;
+  if (encoding_changed) {
+    memcpy(recv->encoding, z_string_data(z_string_loan(&enc_str)), enc_len);
+    recv->encoding_len = enc_len;
+    z_string_drop(z_string_move(&enc_str));
+    if (new_last != NULL) {
+      last = new_last;
+      recv->last_encoding = last;
+    } else {
+      z_encoding_drop(z_encoding_move(last));
+    }
+    z_encoding_clone(last, encoding);
+  }
+  recv->has_attachment = attachment != NULL;
+  recv->attachment_len = 0;
+  if (attachment != NULL) {
+    _zd_bytes_copy(attachment, recv->attachment, att_len);
+    recv->attachment_len = att_len;
+  }
+  recv->payload = payload_buf;
+  recv->payload_owned = payload_owned;
+  _zd_bytes_copy(payload, recv->payload, payload_len);
+  recv->payload_len = payload_len;
+  return true;
+}
+
+FFI_PLUGIN_EXPORT int8_t zd_pull_subscriber_try_recv_into(
+    const uint8_t* handler, int8_t channel, zd_pull_recv_t* recv) {
+  z_owned_sample_t sample;
+  z_result_t res = _zd_pull_handler_try_recv(handler, channel, &sample);
+  if (res == Z_CHANNEL_DISCONNECTED) {
+    return 1;
+  }
+  if (res == Z_CHANNEL_NODATA) {
+    return 2;
+  }
+
+  int8_t rc = _zd_pull_recv_fill(z_sample_loan(&sample), recv) ? 0 : -1;
+  z_sample_drop(z_sample_move(&sample));
+  return rc;
+}
+
+FFI_PLUGIN_EXPORT void zd_pull_recv_release(zd_pull_recv_t* recv) {
+  free(recv->keyexpr);
+  free(recv->encoding);
+  free(recv->attachment);
+  z_owned_encoding_t* last = (z_owned_encoding_t*)recv->last_encoding;
+  if (last != NULL) {
+    z_encoding_drop(z_encoding_move(last));
+    free(last);
+  }
+  memset(recv, 0, sizeof(zd_pull_recv_t));
+}
+
+FFI_PLUGIN_EXPORT int32_t zd_pull_subscriber_try_recv_batch(
+    const uint8_t* handler, int8_t channel, uint8_t* arena, size_t arena_len,
+    int32_t max_samples, size_t* arena_used_out, uint8_t** overflow_out) {
+  *arena_used_out = 0;
+  *overflow_out = NULL;
+
+  int32_t count = 0;
+  size_t used = 0;
+  bool lost = false;
+  while (count < max_samples) {
+    z_owned_sample_t sample;
+    z_result_t res = _zd_pull_handler_try_recv(handler, channel, &sample);
+    if (res == Z_CHANNEL_DISCONNECTED && count == 0) {
+      return -1;
+    }
+    if (res != Z_OK) {
+      break;
+    }
+
+    zd_sample_wire_layout_t layout;
+    _zd_sample_wire_layout(z_sample_loan(&sample), -1, -1,
+                           ZD_SAMPLE_FIELDS_ALL, &layout);
+    size_t frame = _zd_sample_frame_size(&layout);
+    // The sample has left the channel, so one that does not fit the arena is
+    // framed on its own instead of being lost, and ends the batch.
+    bool fits = frame <= arena_len - used;
+    uint8_t* dst = fits ? arena + used : (uint8_t*)malloc(frame);
+    if (dst != NULL) {
+      _zd_sample_frame_write(&layout, dst);
+    }
+    _zd_sample_wire_layout_release(&layout);
+    z_sample_drop(z_sample_move(&sample));
+    if (!fits) {
+      *overflow_out = dst;
+      lost = dst == NULL;
+      break;
+    }
+    used += frame;
+    count++;
+  }
+  *arena_used_out = used;
+  return lost ? -2 : count;
+}
+
 FFI_PLUGIN_EXPORT void zd_ring_handler_sample_drop(uint8_t* handler) {
   z_owned_ring_handler_sample_t* h = (z_owned_ring_handler_sample_t*)handler;
   z_ring_handler_sample_drop(z_ring_handler_sample_move(h));
 }
 
+FFI_PLUGIN_EXPORT void zd_fifo_handler_sample_drop(uint8_t* handler) {
+  z_owned_fifo_handler_sample_t* h = (z_owned_fifo_handler_sample_t*)handler;
+  z_fifo_handler_sample_drop(z_fifo_handler_sample_move(h));
+}
+
+// ---------------------------------------------------------------------------
+// Ring Subscriber (shared sample ring)
+// ---------------------------------------------------------------------------
+
+// Single-producer/single-consumer byte ring shared with a Dart isolate.
+// The zenoh callback frames each sample in the flat wire format and
+// publishes it by advancing `head`; Dart reads frames straight out of
+// `data` and hands back consumed space by advancing `tail`. Positions
+// increase monotonically and are masked by `capacity - 1`.
+//
+// Dart is woken only when it has armed the doorbell, i.e. after it found
+// the ring empty, so a busy ring costs no port messages at all.
+
+struct zd_sample_ring_t {
+  _Atomic uint64_t head;
+  _Atomic uint64_t tail;
+  _Atomic bool armed;
+  _Atomic uint64_t dropped;
+  /// Serializes producers: zenoh may run a subscriber's callback on more
+  /// than one runtime thread.
+  pthread_mutex_t producer_mutex;
+  Dart_Port_DL dart_port;
+  size_t capacity;
+  uint8_t* data;
+};
+
+static void _zd_sample_ring_free(zd_sample_ring_t* ring) {
+  pthread_mutex_destroy(&ring->producer_mutex);
+  free(ring->data);
+  free(ring);
+}
+
+/// Frames `sample` into the ring, or counts it as dropped when it does not
+/// fit. Never blocks on the consumer.
+static void _zd_sample_ring_callback(z_loaned_sample_t* sample,
+                                     void* context) {
+  zd_sample_ring_t* ring = (zd_sample_ring_t*)context;
+
+  zd_sample_wire_layout_t layout;
+  _zd_sample_wire_layout(sample, -1, -1, ZD_SAMPLE_FIELDS_ALL, &layout);
+  size_t frame = _zd_sample_frame_size(&layout);
+
+  pthread_mutex_lock(&ring->producer_mutex);
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  size_t offset = (size_t)(head & (ring->capacity - 1));
+  // Frames never wrap: a frame that does not fit before the end of the
+  // buffer is preceded by a zero-length marker that skips to the start.
+  size_t skip = ring->capacity - offset < frame ? ring->capacity - offset : 0;
+  if (frame + skip > ring->capacity - (size_t)(head - tail)) {
+    pthread_mutex_unlock(&ring->producer_mutex);
+    _zd_sample_wire_layout_release(&layout);
+    atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+    return;
+  }
+  if (skip > 0) {
+    memset(ring->data + offset, 0, sizeof(uint32_t));
+    head += skip;
+    offset = 0;
+  }
+  _zd_sample_frame_write(&layout, ring->data + offset);
+  // Sequentially consistent with the armed flag; pairs with
+  // zd_sample_ring_release() so a doorbell is never lost.
+  atomic_store(&ring->head, head + frame);
+  bool wake =
+      atomic_load(&ring->armed) && atomic_exchange(&ring->armed, false);
+  pthread_mutex_unlock(&ring->producer_mutex);
+  _zd_sample_wire_layout_release(&layout);
+
+  if (wake) {
+    Dart_CObject c_doorbell;
+    c_doorbell.type = Dart_CObject_kInt64;
+    c_doorbell.value.as_int64 = (int64_t)(head + frame);
+    Dart_PostCObject_DL(ring->dart_port, &c_doorbell);
+  }
+}
+
+/// Drop callback: frees the ring once zenoh has released the closure.
+static void _zd_sample_ring_drop(void* context) {
+  _zd_sample_ring_free((zd_sample_ring_t*)context);
+}
+
+FFI_PLUGIN_EXPORT int zd_declare_ring_subscriber(
+    const z_loaned_session_t* session,
+    z_owned_subscriber_t* subscriber,
+    const z_loaned_keyexpr_t* keyexpr,
+    int64_t dart_port,
+    size_t capacity,
+    zd_sample_ring_t** ring_out) {
+  // Round up to a power of two so positions can be masked.
+  size_t rounded = 64;
+  while (rounded < capacity) rounded <<= 1;
+
+  zd_sample_ring_t* ring = (zd_sample_ring_t*)calloc(1, sizeof(*ring));
+  if (!ring) return -1;
+  ring->data = (uint8_t*)malloc(rounded);
+  if (!ring->data) {
+    free(ring);
+    return -1;
+  }
+  ring->capacity = rounded;
+  ring->dart_port = (Dart_Port_DL)dart_port;
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  atomic_init(&ring->armed, true);
+  atomic_init(&ring->dropped, 0);
+  pthread_mutex_init(&ring->producer_mutex, NULL);
+
+  z_owned_closure_sample_t callback;
+  z_closure_sample(&callback, _zd_sample_ring_callback, _zd_sample_ring_drop,
+                   ring);
+
+  int rc = z_declare_subscriber(session, subscriber, keyexpr,
+                                z_closure_sample_move(&callback), NULL);
+  if (rc != 0) {
+    z_closure_sample_drop(z_closure_sample_move(&callback));
+    return rc;
+  }
+  *ring_out = ring;
+  return 0;
+}
+
+FFI_PLUGIN_EXPORT uint8_t* zd_sample_ring_data(const zd_sample_ring_t* ring) {
+  return ring->data;
+}
+
+FFI_PLUGIN_EXPORT size_t zd_sample_ring_capacity(
+    const zd_sample_ring_t* ring) {
+  return ring->capacity;
+}
+
+FFI_PLUGIN_EXPORT uint64_t zd_sample_ring_acquire(zd_sample_ring_t* ring) {
+  return atomic_load_explicit(&ring->head, memory_order_acquire);
+}
+
+FFI_PLUGIN_EXPORT bool zd_sample_ring_release(zd_sample_ring_t* ring,
+                                              uint64_t tail) {
+  atomic_store_explicit(&ring->tail, tail, memory_order_release);
+  atomic_store(&ring->armed, true);
+  if (atomic_load(&ring->head) == tail) return false;
+  // A sample landed after the last acquire. If the producer has not
+  // claimed the doorbell yet, take it back and let the caller keep
+  // draining; otherwise a doorbell is already on its way.
+  return atomic_exchange(&ring->armed, false);
+}
+
+FFI_PLUGIN_EXPORT uint64_t zd_sample_ring_dropped(zd_sample_ring_t* ring) {
+  return atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Conflating Subscriber (latest value per key)
+// ---------------------------------------------------------------------------
+
+// Each key expression gets a zd_keymap_t slot holding its newest sample.
+// Slots with a sample not yet taken by Dart are listed in `dirty` by id,
+// in first-update order, so a take visits only updated keys.
+
+typedef struct {
+  z_owned_sample_t sample;
+  bool dirty;
+} zd_conflation_slot_t;
+
+struct zd_conflation_t {
+  pthread_mutex_t mutex;
+  Dart_Port_DL dart_port;
+  zd_keymap_t latest;
+  uint32_t* dirty;
+  size_t dirty_count;
+  size_t dirty_capacity;
+  /// A doorbell was posted and Dart has not taken the samples yet.
+  bool notified;
+  _Atomic uint64_t conflated;
+};
+
+static void _zd_conflation_slot_free(void* value) {
+  zd_conflation_slot_t* slot = (zd_conflation_slot_t*)value;
+  if (slot->dirty) z_sample_drop(z_sample_move(&slot->sample));
+  free(slot);
+}
+
+/// Stores `sample` as the newest for its key, replacing any sample Dart
+/// has not taken yet.
+static void _zd_conflation_callback(z_loaned_sample_t* sample,
+                                    void* context) {
+  zd_conflation_t* conflation = (zd_conflation_t*)context;
+  z_view_string_t key_view;
+  z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_view);
+  const z_loaned_string_t* key_loaned = z_view_string_loan(&key_view);
+  const char* key_data = z_string_data(key_loaned);
+  size_t key_len = z_string_len(key_loaned);
+
+  pthread_mutex_lock(&conflation->mutex);
+  zd_keymap_entry_t* entry =
+      _zd_keymap_find(&conflation->latest, key_data, key_len);
+  if (entry == NULL) {
+    zd_conflation_slot_t* slot =
+        (zd_conflation_slot_t*)calloc(1, sizeof(zd_conflation_slot_t));
+    entry = slot ? _zd_keymap_insert(&conflation->latest, key_data, key_len)
+                 : NULL;
+    if (entry == NULL) {
+      free(slot);
+      pthread_mutex_unlock(&conflation->mutex);
+      return;
+    }
+    entry->value = slot;
+  }
+  zd_conflation_slot_t* slot = (zd_conflation_slot_t*)entry->value;
+
+  if (slot->dirty) {
+    z_sample_drop(z_sample_move(&slot->sample));
+    atomic_fetch_add_explicit(&conflation->conflated, 1,
+                              memory_order_relaxed);
+  } else {
+    if (conflation->dirty_count == conflation->dirty_capacity) {
+      size_t capacity =
+          conflation->dirty_capacity ? conflation->dirty_capacity * 2 : 16;
+      uint32_t* grown = (uint32_t*)realloc(conflation->dirty,
+                                           capacity * sizeof(uint32_t));
+      if (!grown) {
+        pthread_mutex_unlock(&conflation->mutex);
+        return;
+      }
+      conflation->dirty = grown;
+      conflation->dirty_capacity = capacity;
+    }
+    conflation->dirty[conflation->dirty_count++] = entry->id;
+    slot->dirty = true;
+  }
+  z_sample_clone(&slot->sample, sample);
+  bool wake = !conflation->notified;
+  conflation->notified = true;
+  pthread_mutex_unlock(&conflation->mutex);
+
+  if (wake) {
+    Dart_CObject c_doorbell;
+    c_doorbell.type = Dart_CObject_kInt64;
+    c_doorbell.value.as_int64 = 0;
+    Dart_PostCObject_DL(conflation->dart_port, &c_doorbell);
+  }
+}
+
+/// Drop callback: frees the map once zenoh has released the closure.
+static void _zd_conflation_drop(void* context) {
+  zd_conflation_t* conflation = (zd_conflation_t*)context;
+  _zd_keymap_clear(&conflation->latest, _zd_conflation_slot_free);
+  free(conflation->dirty);
+  pthread_mutex_destroy(&conflation->mutex);
+  free(conflation);
+}
+
+FFI_PLUGIN_EXPORT int zd_declare_conflating_subscriber(
+    const z_loaned_session_t* session,
+    z_owned_subscriber_t* subscriber,
+    const z_loaned_keyexpr_t* keyexpr,
+    int64_t dart_port,
+    zd_conflation_t** conflation_out) {
+  zd_conflation_t* conflation =
+      (zd_conflation_t*)calloc(1, sizeof(*conflation));
+  if (!conflation) return -1;
+  conflation->dart_port = (Dart_Port_DL)dart_port;
+  atomic_init(&conflation->conflated, 0);
+  pthread_mutex_init(&conflation->mutex, NULL);
+
+  z_owned_closure_sample_t callback;
+  z_closure_sample(&callback, _zd_conflation_callback, _zd_conflation_drop,
+                   conflation);
+
+  int rc = z_declare_subscriber(session, subscriber, keyexpr,
+                                z_closure_sample_move(&callback), NULL);
+  if (rc != 0) {
+    z_closure_sample_drop(z_closure_sample_move(&callback));
+    return rc;
+  }
+  *conflation_out = conflation;
+  return 0;
+}
+
+FFI_PLUGIN_EXPORT uint8_t* zd_conflation_take(zd_conflation_t* conflation,
+                                              size_t* len_out) {
+  *len_out = 0;
+  pthread_mutex_lock(&conflation->mutex);
+  size_t count = conflation->dirty_count;
+  z_owned_sample_t* samples =
+      count > 0 ? (z_owned_sample_t*)malloc(count * sizeof(z_owned_sample_t))
+                : NULL;
+  if (samples != NULL) {
+    // Move the samples out so the frames are built without the lock.
+    zd_keymap_entry_t** entries = conflation->latest.entries;
+    for (size_t i = 0; i < count; i++) {
+      zd_conflation_slot_t* slot =
+          (zd_conflation_slot_t*)entries[conflation->dirty[i]]->value;
+      samples[i] = slot->sample;
+      slot->dirty = false;
+    }
+    conflation->dirty_count = 0;
+  }
+  // Re-arm even on failure so the next update rings again.
+  conflation->notified = false;
+  pthread_mutex_unlock(&conflation->mutex);
+  if (samples == NULL) return NULL;
+
+  zd_sample_wire_layout_t* layouts = (zd_sample_wire_layout_t*)malloc(
+      count * sizeof(zd_sample_wire_layout_t));
+  size_t total = 0;
+  if (layouts != NULL) {
+    for (size_t i = 0; i < count; i++) {
+      _zd_sample_wire_layout(z_sample_loan(&samples[i]), -1, -1,
+                             ZD_SAMPLE_FIELDS_ALL, &layouts[i]);
+      total += _zd_sample_frame_size(&layouts[i]);
+    }
+  }
+  uint8_t* frames = layouts != NULL ? (uint8_t*)malloc(total) : NULL;
+  size_t offset = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (frames != NULL) {
+      _zd_sample_frame_write(&layouts[i], frames + offset);
+      offset += _zd_sample_frame_size(&layouts[i]);
+    }
+    if (layouts != NULL) _zd_sample_wire_layout_release(&layouts[i]);
+    z_sample_drop(z_sample_move(&samples[i]));
+  }
+  free(layouts);
+  free(samples);
+  if (frames != NULL) *len_out = total;
+  return frames;
+}
+
+FFI_PLUGIN_EXPORT uint64_t zd_conflation_conflated(
+    zd_conflation_t* conflation) {
+  return atomic_load_explicit(&conflation->conflated, memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Aggregating Subscriber (windowed numeric aggregates)
+// ---------------------------------------------------------------------------
+
+// A window of `window_us` is split into `pane_count` panes of `step_us`.
+// Each key gets a zd_keymap_t slot with one accumulator per pane; the
+// callback folds samples into the current pane, and the closer thread
+// combines all panes at every step boundary, posts the records, then
+// moves to the next pane and clears it. Tumbling windows have one pane.
+
+typedef struct {
+  uint64_t count;
+  double sum;
+  /// Extremes, as doubles or int64s according to the value type.
+  union {
+    double f;
+    int64_t i;
+  } min, max;
+} zd_aggregate_pane_t;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t closer;
+  bool stopping;
+  Dart_Port_DL dart_port;
+  uint8_t value_type;
+  bool serialized;
+  uint64_t step_us;
+  size_t pane_count;
+  /// Index of the pane samples are currently folded into.
+  size_t pane;
+  /// Per-key arrays of `pane_count` panes.
+  zd_keymap_t keys;
+  /// Counters the aggregator holds a reference to, or NULL.
+  zd_subscriber_stats_t* stats;
+} zd_aggregator_t;
+
+/// Decodes a numeric payload. Returns false if it is not a single value
+/// of the configured type.
+static bool _zd_aggregate_decode(const zd_aggregator_t* agg,
+                                 const z_loaned_bytes_t* payload,
+                                 double* as_double, int64_t* as_int) {
+  if (agg->serialized) {
+    ze_deserializer_t deserializer = ze_deserializer_from_bytes(payload);
+    bool ok;
+    if (agg->value_type == ZD_AGGREGATE_INT64) {
+      ok = ze_deserializer_deserialize_int64(&deserializer, as_int) == 0;
+      *as_double = (double)*as_int;
+    } else {
+      ok = ze_deserializer_deserialize_double(&deserializer, as_double) == 0;
+    }
+    return ok && ze_deserializer_is_done(&deserializer);
+  }
+
+  if (z_bytes_len(payload) != 8) return false;
+  uint8_t raw[8];
+  z_bytes_reader_t reader = z_bytes_get_reader(payload);
+  if (z_bytes_reader_read(&reader, raw, sizeof(raw)) != sizeof(raw)) {
+    return false;
+  }
+  uint64_t bits = 0;
+  for (int i = 7; i >= 0; i--) bits = (bits << 8) | raw[i];
+  if (agg->value_type == ZD_AGGREGATE_INT64) {
+    *as_int = (int64_t)bits;
+    *as_double = (double)*as_int;
+  } else {
+    memcpy(as_double, &bits, sizeof(bits));
+  }
+  return true;
+}
+
+/// Folds one decoded value into `pane`.
+static void _zd_aggregate_pane_add(zd_aggregate_pane_t* pane,
+                                   uint8_t value_type, double as_double,
+                                   int64_t as_int) {
+  if (value_type == ZD_AGGREGATE_INT64) {
+    if (pane->count == 0 || as_int < pane->min.i) pane->min.i = as_int;
+    if (pane->count == 0 || as_int > pane->max.i) pane->max.i = as_int;
+  } else {
+    if (pane->count == 0 || as_double < pane->min.f) pane->min.f = as_double;
+    if (pane->count == 0 || as_double > pane->max.f) pane->max.f = as_double;
+  }
+  pane->sum += as_double;
+  pane->count++;
+}
+
+/// Folds `src` into `dst`.
+static void _zd_aggregate_pane_merge(zd_aggregate_pane_t* dst,
+                                     const zd_aggregate_pane_t* src,
+                                     uint8_t value_type) {
+  if (src->count == 0) return;
+  if (dst->count == 0) {
+    *dst = *src;
+    return;
+  }
+  if (value_type == ZD_AGGREGATE_INT64) {
+    if (src->min.i < dst->min.i) dst->min.i = src->min.i;
+    if (src->max.i > dst->max.i) dst->max.i = src->max.i;
+  } else {
+    if (src->min.f < dst->min.f) dst->min.f = src->min.f;
+    if (src->max.f > dst->max.f) dst->max.f = src->max.f;
+  }
+  dst->count += src->count;
+  dst->sum += src->sum;
+}
+
+static void _zd_aggregator_count_undecodable(zd_aggregator_t* agg) {
+  if (agg->stats != NULL) {
+    _zd_stats_count(&agg->stats->undecodable);
+  }
+}
+
+/// Decodes the sample's payload and folds it into its key's current pane.
+static void _zd_aggregator_callback(z_loaned_sample_t* sample,
+                                    void* context) {
+  zd_aggregator_t* agg = (zd_aggregator_t*)context;
+  if (z_sample_kind(sample) != Z_SAMPLE_KIND_PUT) return;
+  double as_double = 0;
+  int64_t as_int = 0;
+  if (!_zd_aggregate_decode(agg, z_sample_payload(sample), &as_double,
+                            &as_int)) {
+    _zd_aggregator_count_undecodable(agg);
+    return;
+  }
+
+  z_view_string_t key_view;
+  z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_view);
+  const z_loaned_string_t* key_loaned = z_view_string_loan(&key_view);
+  const char* key_data = z_string_data(key_loaned);
+  size_t key_len = z_string_len(key_loaned);
+
+  pthread_mutex_lock(&agg->mutex);
+  zd_keymap_entry_t* entry = _zd_keymap_find(&agg->keys, key_data, key_len);
+  if (entry == NULL) {
+    zd_aggregate_pane_t* panes = (zd_aggregate_pane_t*)calloc(
+        agg->pane_count, sizeof(zd_aggregate_pane_t));
+    entry = panes ? _zd_keymap_insert(&agg->keys, key_data, key_len) : NULL;
+    if (entry == NULL) {
+      free(panes);
+      pthread_mutex_unlock(&agg->mutex);
+      return;
+    }
+    entry->value = panes;
+  }
+  zd_aggregate_pane_t* panes = (zd_aggregate_pane_t*)entry->value;
+  _zd_aggregate_pane_add(&panes[agg->pane], agg->value_type, as_double,
+                         as_int);
+  pthread_mutex_unlock(&agg->mutex);
+}
+
+/// Sets `obj` to the extreme `value` as a double or an int64.
+static void _zd_aggregate_set_extreme(Dart_CObject* obj, uint8_t value_type,
+                                      double as_double, int64_t as_int) {
+  if (value_type == ZD_AGGREGATE_INT64) {
+    obj->type = Dart_CObject_kInt64;
+    obj->value.as_int64 = as_int;
+  } else {
+    obj->type = Dart_CObject_kDouble;
+    obj->value.as_double = as_double;
+  }
+}
+
+/// Closes the window ending now: posts a record for every key with
+/// samples in it, then advances to the next pane. Caller holds the lock.
+static void _zd_aggregator_close_window_locked(zd_aggregator_t* agg) {
+  size_t key_count = agg->keys.count;
+  zd_aggregate_pane_t* totals = (zd_aggregate_pane_t*)calloc(
+      key_count > 0 ? key_count : 1, sizeof(zd_aggregate_pane_t));
+  size_t record_count = 0;
+  if (totals != NULL) {
+    for (size_t k = 0; k < key_count; k++) {
+      zd_aggregate_pane_t* panes =
+          (zd_aggregate_pane_t*)agg->keys.entries[k]->value;
+      for (size_t p = 0; p < agg->pane_count; p++) {
+        _zd_aggregate_pane_merge(&totals[k], &panes[p], agg->value_type);
+      }
+      if (totals[k].count > 0) record_count++;
+    }
+  }
+
+  if (record_count > 0) {
+    // One allocation for the records, their fields and pointer arrays.
+    size_t fields = 5;
+    size_t size = record_count * (sizeof(Dart_CObject) * (1 + fields) +
+                                  sizeof(Dart_CObject*) * (1 + fields));
+    uint8_t* block = (uint8_t*)malloc(size);
+    if (block != NULL) {
+      Dart_CObject* records = (Dart_CObject*)block;
+      Dart_CObject* values = records + record_count;
+      Dart_CObject** record_ptrs =
+          (Dart_CObject**)(values + record_count * fields);
+      Dart_CObject** value_ptrs = record_ptrs + record_count;
+      size_t r = 0;
+      for (size_t k = 0; k < key_count; k++) {
+        const zd_aggregate_pane_t* total = &totals[k];
+        if (total->count == 0) continue;
+        Dart_CObject* v = &values[r * fields];
+        v[0].type = Dart_CObject_kString;
+        v[0].value.as_string = agg->keys.entries[k]->key;
+        v[1].type = Dart_CObject_kInt64;
+        v[1].value.as_int64 = (int64_t)total->count;
+        _zd_aggregate_set_extreme(&v[2], agg->value_type, total->min.f,
+                                  total->min.i);
+        _zd_aggregate_set_extreme(&v[3], agg->value_type, total->max.f,
+                                  total->max.i);
+        v[4].type = Dart_CObject_kDouble;
+        v[4].value.as_double = total->sum / (double)total->count;
+        for (size_t f = 0; f < fields; f++) {
+          value_ptrs[r * fields + f] = &v[f];
+        }
+        records[r].type = Dart_CObject_kArray;
+        records[r].value.as_array.length = (intptr_t)fields;
+        records[r].value.as_array.values = &value_ptrs[r * fields];
+        record_ptrs[r] = &records[r];
+        r++;
+      }
+
+      struct timespec now;
+      clock_gettime(CLOCK_REALTIME, &now);
+      Dart_CObject c_end;
+      c_end.type = Dart_CObject_kInt64;
+      c_end.value.as_int64 =
+          (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+      Dart_CObject c_records;
+      c_records.type = Dart_CObject_kArray;
+      c_records.value.as_array.length = (intptr_t)record_count;
+      c_records.value.as_array.values = record_ptrs;
+      Dart_CObject* elements[2] = {&c_end, &c_records};
+      Dart_CObject c_msg;
+      c_msg.type = Dart_CObject_kArray;
+      c_msg.value.as_array.length = 2;
+      c_msg.value.as_array.values = elements;
+      Dart_PostCObject_DL(agg->dart_port, &c_msg);
+      free(block);
+    }
+  }
+  free(totals);
+
+  agg->pane = (agg->pane + 1) % agg->pane_count;
+  for (size_t k = 0; k < key_count; k++) {
+    zd_aggregate_pane_t* panes =
+        (zd_aggregate_pane_t*)agg->keys.entries[k]->value;
+    memset(&panes[agg->pane], 0, sizeof(zd_aggregate_pane_t));
+  }
+}
+
+/// Closer thread: closes a window every `step_us` until stopped.
+static void* _zd_aggregator_closer(void* arg) {
+  zd_aggregator_t* agg = (zd_aggregator_t*)arg;
+  pthread_mutex_lock(&agg->mutex);
+  struct timespec deadline = _zd_monotonic_after_us(agg->step_us);
+  while (!agg->stopping) {
+    pthread_cond_timedwait(&agg->cond, &agg->mutex, &deadline);
+    if (agg->stopping || !_zd_deadline_passed(&deadline)) continue;
+    _zd_aggregator_close_window_locked(agg);
+    // Advance from the previous deadline so closes do not drift.
+    deadline.tv_sec += (time_t)(agg->step_us / 1000000u);
+    deadline.tv_nsec += (long)(agg->step_us % 1000000u) * 1000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec += 1;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
+  pthread_mutex_unlock(&agg->mutex);
+  return NULL;
+}
+
+/// Drop callback: stops the closer thread and frees the aggregator.
+/// Samples in the open window are discarded.
+static void _zd_aggregator_drop(void* context) {
+  zd_aggregator_t* agg = (zd_aggregator_t*)context;
+  pthread_mutex_lock(&agg->mutex);
+  agg->stopping = true;
+  pthread_cond_signal(&agg->cond);
+  pthread_mutex_unlock(&agg->mutex);
+  pthread_join(agg->closer, NULL);
+
+  _zd_keymap_clear(&agg->keys, free);
+  pthread_cond_destroy(&agg->cond);
+  pthread_mutex_destroy(&agg->mutex);
+  if (agg->stats != NULL) _zd_stats_release(agg->stats);
+  free(agg);
+}
+
+FFI_PLUGIN_EXPORT void zd_aggregator_options_default(
+    zd_aggregator_options_t* options) {
+  options->value_type = ZD_AGGREGATE_FLOAT64;
+  options->serialized = false;
+  options->window_us = 1000000;
+  options->step_us = 1000000;
+  options->stats = NULL;
+}
+
+FFI_PLUGIN_EXPORT int zd_declare_aggregating_subscriber(
+    const z_loaned_session_t* session,
+    z_owned_subscriber_t* subscriber,
+    const z_loaned_keyexpr_t* keyexpr,
+    int64_t dart_port,
+    const zd_aggregator_options_t* options) {
+  zd_aggregator_options_t defaults;
+  if (options == NULL) {
+    zd_aggregator_options_default(&defaults);
+    options = &defaults;
+  }
+  if (options->step_us == 0 || options->window_us < options->step_us ||
+      options->window_us % options->step_us != 0) {
+    return -1;
+  }
+
+  zd_aggregator_t* agg = (zd_aggregator_t*)calloc(1, sizeof(*agg));
+  if (!agg) return -1;
+  agg->dart_port = (Dart_Port_DL)dart_port;
+  agg->value_type = options->value_type;
+  agg->serialized = options->serialized;
+  agg->step_us = options->step_us;
+  agg->pane_count = options->window_us / options->step_us;
+  agg->stats = options->stats;
+
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&agg->cond, &attr);
+  pthread_condattr_destroy(&attr);
+  pthread_mutex_init(&agg->mutex, NULL);
+  if (pthread_create(&agg->closer, NULL, _zd_aggregator_closer, agg) != 0) {
+    pthread_cond_destroy(&agg->cond);
+    pthread_mutex_destroy(&agg->mutex);
+    free(agg);
+    return -1;
+  }
+  if (agg->stats != NULL) _zd_stats_retain(agg->stats);
+
+  z_owned_closure_sample_t callback;
+  z_closure_sample(&callback, _zd_aggregator_callback, _zd_aggregator_drop,
+                   agg);
+
+  int rc = z_declare_subscriber(session, subscriber, keyexpr,
+                                z_closure_sample_move(&callback), NULL);
+  if (rc != 0) {
+    z_closure_sample_drop(z_closure_sample_move(&callback));
+  }
+  return rc;
+}
+
 // ---------------------------------------------------------------------------
 // Querier
 // ---------------------------------------------------------------------------
@@ -1563,10 +4747,8 @@ FFI_PLUGIN_EXPORT int8_t zd_liveliness_declare_subscriber(
   if (rc != 0) return (int8_t)rc;
 
   // Allocate context for the sample callback
-  zd_subscriber_context_t* ctx =
-      (zd_subscriber_context_t*)malloc(sizeof(zd_subscriber_context_t));
+  zd_subscriber_context_t* ctx = _zd_subscriber_context_new(port, NULL);
   if (!ctx) return -1;
-  ctx->dart_port = (Dart_Port_DL)port;
 
   // Create closure reusing the existing sample callback/drop
   z_owned_closure_sample_t callback;
@@ -2001,9 +5183,8 @@ int zd_declare_advanced_subscriber(
     bool subscriber_detection) {
 
   // Create closure context with the Dart port
-  zd_subscriber_context_t* ctx =
-      (zd_subscriber_context_t*)malloc(sizeof(zd_subscriber_context_t));
-  ctx->dart_port = (Dart_Port_DL)dart_port;
+  zd_subscriber_context_t* ctx = _zd_subscriber_context_new(dart_port, NULL);
+  if (!ctx) return -1;
 
   z_owned_closure_sample_t callback;
   z_closure_sample(&callback, _zd_sample_callback, _zd_sample_drop, ctx);
@@ -2072,9 +5253,8 @@ int zd_advanced_subscriber_declare_background_sample_miss_listener(
     const ze_loaned_advanced_subscriber_t* subscriber,
     int64_t dart_port) {
 
-  zd_subscriber_context_t* ctx =
-      (zd_subscriber_context_t*)malloc(sizeof(zd_subscriber_context_t));
-  ctx->dart_port = (Dart_Port_DL)dart_port;
+  zd_subscriber_context_t* ctx = _zd_subscriber_context_new(dart_port, NULL);
+  if (!ctx) return -1;
 
   ze_owned_closure_miss_t miss_callback;
   ze_closure_miss(&miss_callback, _zd_miss_callback, _zd_sample_drop, ctx);
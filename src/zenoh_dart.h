@@ -193,6 +193,18 @@ FFI_PLUGIN_EXPORT int zd_bytes_copy_from_str(z_owned_bytes_t* bytes,
 FFI_PLUGIN_EXPORT int zd_bytes_copy_from_buf(z_owned_bytes_t* bytes,
                                              const uint8_t* data, size_t len);
 
+/// Wraps a malloc()-allocated buffer in owned bytes without copying.
+///
+/// Ownership of `data` passes to the bytes: it is released with free()
+/// once zenoh no longer references it, or right away if this call fails.
+///
+/// @param bytes  Pointer to an uninitialized z_owned_bytes_t.
+/// @param data   Buffer allocated with malloc(), or NULL when `len` is 0.
+/// @param len    Length of the buffer in bytes.
+/// @return 0 on success, negative on failure.
+FFI_PLUGIN_EXPORT int zd_bytes_from_malloc(z_owned_bytes_t* bytes,
+                                           uint8_t* data, size_t len);
+
 /// Converts loaned bytes to an owned string.
 ///
 /// @param bytes  Const pointer to a loaned bytes reference.
@@ -243,6 +255,71 @@ FFI_PLUGIN_EXPORT void zd_bytes_drop(z_owned_bytes_t* bytes);
 /// @return 0 on success.
 FFI_PLUGIN_EXPORT int8_t zd_bytes_clone(uint8_t* dst, const uint8_t* src);
 
+// ---------------------------------------------------------------------------
+// Bytes Buffer Pool
+// ---------------------------------------------------------------------------
+
+/// A fixed set of equally sized native buffers that can be filled in place
+/// and published without copying.
+///
+/// A buffer wrapped with zd_bytes_from_pool_buffer() returns to the pool
+/// when zenoh drops its last reference to the bytes, typically once the
+/// transport has written it out.
+typedef struct zd_buffer_pool_t zd_buffer_pool_t;
+
+/// Creates a buffer pool.
+///
+/// @param buffer_size  Size of each buffer in bytes (> 0).
+/// @param count        Number of buffers (> 0).
+/// @return The pool, or NULL on invalid arguments or allocation failure.
+FFI_PLUGIN_EXPORT zd_buffer_pool_t* zd_buffer_pool_new(size_t buffer_size,
+                                                       int32_t count);
+
+/// Takes a free buffer from the pool.
+///
+/// @param pool  The buffer pool.
+/// @return A buffer of the pool's buffer size, or NULL if none is free or
+///         the pool has been freed.
+FFI_PLUGIN_EXPORT uint8_t* zd_buffer_pool_acquire(zd_buffer_pool_t* pool);
+
+/// Returns a buffer taken with zd_buffer_pool_acquire() that was not
+/// wrapped in bytes.
+///
+/// @param pool  The buffer pool.
+/// @param data  The buffer.
+FFI_PLUGIN_EXPORT void zd_buffer_pool_release(zd_buffer_pool_t* pool,
+                                              uint8_t* data);
+
+/// Returns the number of free buffers in the pool.
+///
+/// @param pool  The buffer pool.
+/// @return Number of buffers zd_buffer_pool_acquire() can take right now.
+FFI_PLUGIN_EXPORT int32_t zd_buffer_pool_available(zd_buffer_pool_t* pool);
+
+/// Wraps the first `len` bytes of a pool buffer in owned bytes without
+/// copying.
+///
+/// Ownership of `data` passes to the bytes: the buffer returns to the pool
+/// when the bytes and every clone of them are dropped, or right away if this
+/// call fails. The caller must not write to it afterwards.
+///
+/// @param bytes  Pointer to an uninitialized z_owned_bytes_t.
+/// @param pool   The buffer pool `data` was acquired from.
+/// @param data   A buffer taken with zd_buffer_pool_acquire().
+/// @param len    Number of bytes to wrap (<= the pool's buffer size).
+/// @return 0 on success, negative on failure.
+FFI_PLUGIN_EXPORT int zd_bytes_from_pool_buffer(z_owned_bytes_t* bytes,
+                                                zd_buffer_pool_t* pool,
+                                                uint8_t* data, size_t len);
+
+/// Frees the pool.
+///
+/// Buffers still referenced by bytes keep the pool's memory alive until
+/// zenoh drops them; after this call zd_buffer_pool_acquire() returns NULL.
+///
+/// @param pool  The buffer pool.
+FFI_PLUGIN_EXPORT void zd_buffer_pool_free(zd_buffer_pool_t* pool);
+
 // ---------------------------------------------------------------------------
 // Owned String
 // ---------------------------------------------------------------------------
@@ -309,6 +386,30 @@ FFI_PLUGIN_EXPORT const char* zd_view_string_data(const z_view_string_t* str);
 /// @return Length of the string data in bytes.
 FFI_PLUGIN_EXPORT size_t zd_view_string_len(const z_view_string_t* str);
 
+// ---------------------------------------------------------------------------
+// Encoding
+// ---------------------------------------------------------------------------
+
+/// Returns the size of z_owned_encoding_t in bytes.
+///
+/// Used by Dart to allocate the correct amount of native memory
+/// for opaque zenoh types.
+FFI_PLUGIN_EXPORT size_t zd_encoding_sizeof(void);
+
+/// Parses a MIME type string into an owned encoding.
+///
+/// A parsed encoding passed to the put and reply functions is cloned,
+/// which is cheaper than parsing the string again on every call.
+///
+/// @param encoding   Pointer to an uninitialized z_owned_encoding_t.
+/// @param mime_type  Null-terminated MIME type string.
+/// @return 0 on success, negative on failure.
+FFI_PLUGIN_EXPORT int zd_encoding_from_str(z_owned_encoding_t* encoding,
+                                           const char* mime_type);
+
+/// Drops (frees) an owned encoding.
+FFI_PLUGIN_EXPORT void zd_encoding_drop(z_owned_encoding_t* encoding);
+
 // ---------------------------------------------------------------------------
 // Put / Delete
 // ---------------------------------------------------------------------------
@@ -346,23 +447,311 @@ FFI_PLUGIN_EXPORT int zd_delete(
 /// for opaque zenoh types.
 FFI_PLUGIN_EXPORT size_t zd_subscriber_sizeof(void);
 
+/// Header of a sample in the flat wire format.
+///
+/// A flat sample is one Uint8List laid out as this header (native byte
+/// order), a zd_sample_metadata_t when ZD_SAMPLE_WIRE_METADATA is set,
+/// the key expression and encoding strings (UTF-8, not null-terminated),
+/// the attachment bytes, zero padding up to `payload_offset` (a multiple
+/// of 8) and the payload bytes.
+typedef struct {
+  /// Sample kind (0 = put, 1 = delete).
+  uint8_t kind;
+  /// Bit set of ZD_SAMPLE_WIRE_* flags.
+  uint8_t flags;
+  /// Cached encoding id when ZD_SAMPLE_WIRE_ENCODING_ID is set.
+  uint16_t encoding_id;
+  uint32_t key_len;
+  uint32_t encoding_len;
+  uint32_t attachment_len;
+  /// Offset of the payload from the start of the buffer.
+  uint32_t payload_offset;
+  uint32_t payload_len;
+} zd_sample_wire_header_t;
+
+/// Flat sample flag: the sample carries an attachment (possibly empty).
+#define ZD_SAMPLE_WIRE_HAS_ATTACHMENT 0x01
+
+/// Flat sample flag: the key expression is interned. `key_len` holds the
+/// key id and no key bytes follow the header.
+#define ZD_SAMPLE_WIRE_KEY_ID 0x02
+
+/// Flat sample flag: the encoding is cached. `encoding_id` holds its id and
+/// no encoding bytes follow the key expression.
+#define ZD_SAMPLE_WIRE_ENCODING_ID 0x04
+
+/// Largest encoding cache size, the most ids `encoding_id` can hold.
+#define ZD_ENCODING_CACHE_MAX 65535
+
+/// Flat sample flag: the payload was not requested. `payload_len` holds
+/// its size but no payload bytes follow the header fields.
+#define ZD_SAMPLE_WIRE_NO_PAYLOAD 0x08
+
+/// Flat sample flag: a zd_sample_metadata_t follows the header.
+#define ZD_SAMPLE_WIRE_METADATA 0x10
+
+/// Timestamp, source and QoS of a sample, packed in native byte order.
+///
+/// Posted as a Uint8List by subscribers that request
+/// ZD_SAMPLE_FIELD_METADATA, and filled by zd_sample_metadata() for lazily
+/// delivered samples.
+typedef struct {
+  /// NTP64 time, valid when ZD_SAMPLE_META_HAS_TIMESTAMP is set.
+  uint64_t timestamp;
+  /// Zenoh id of the runtime that created the timestamp.
+  uint8_t timestamp_id[16];
+  /// Zenoh id of the publishing session, valid when
+  /// ZD_SAMPLE_META_HAS_SOURCE is set.
+  uint8_t source_zid[16];
+  /// Entity id of the publisher within its session.
+  uint32_t source_eid;
+  /// Sequence number of the sample within its publisher.
+  uint32_t source_sn;
+  /// z_priority_t value (1-7).
+  uint8_t priority;
+  /// z_congestion_control_t value (0 = block, 1 = drop).
+  uint8_t congestion_control;
+  /// Bit set of ZD_SAMPLE_META_* flags.
+  uint8_t flags;
+  uint8_t reserved[5];
+} zd_sample_metadata_t;
+
+/// Metadata flags for zd_sample_metadata_t.flags.
+#define ZD_SAMPLE_META_HAS_TIMESTAMP 0x01
+#define ZD_SAMPLE_META_HAS_SOURCE 0x02
+#define ZD_SAMPLE_META_EXPRESS 0x04
+
+/// Sample field bits for zd_subscriber_options_t.fields. The key
+/// expression and kind are always delivered. ZD_SAMPLE_FIELDS_ALL covers
+/// the data fields; metadata (a zd_sample_metadata_t) is opt-in.
+#define ZD_SAMPLE_FIELD_PAYLOAD 0x01
+#define ZD_SAMPLE_FIELD_ATTACHMENT 0x02
+#define ZD_SAMPLE_FIELD_ENCODING 0x04
+#define ZD_SAMPLE_FIELD_METADATA 0x08
+#define ZD_SAMPLE_FIELDS_ALL 0x07
+
+/// Rate limit modes for zd_subscriber_options_t.rate_limit_mode.
+///
+/// DROP_NEWEST delivers the first sample of each interval and drops the
+/// rest. KEEP_LATEST holds back the most recent sample of the interval and
+/// delivers it once the interval ends, dropping the samples it replaces.
+#define ZD_RATE_LIMIT_DROP_NEWEST 0
+#define ZD_RATE_LIMIT_KEEP_LATEST 1
+
+/// Overflow policies for zd_flow_control_new(), applied when a sample
+/// arrives while the in-flight limit is reached.
+///
+/// DROP_NEWEST drops the arriving sample. DROP_OLDEST converts it and holds
+/// it in a native queue of the same size as the limit, dropping the oldest
+/// queued sample when the queue is full; queued samples are posted as Dart
+/// acknowledges earlier ones. BLOCK stalls the zenoh callback until Dart
+/// acknowledges a sample.
+#define ZD_OVERFLOW_DROP_NEWEST 0
+#define ZD_OVERFLOW_DROP_OLDEST 1
+#define ZD_OVERFLOW_BLOCK 2
+
+/// Bounds the number of samples a subscriber has handed to Dart that Dart
+/// has not acknowledged with zd_flow_control_ack().
+///
+/// Created with zd_flow_control_new() and passed through
+/// zd_subscriber_options_t, and may be used by one subscriber only. The
+/// subscriber holds a reference until its drop callback has run, so the
+/// caller may free its own reference as soon as the subscriber is dropped.
+typedef struct zd_flow_control_t zd_flow_control_t;
+
+/// Counters a subscriber updates as it processes samples.
+///
+/// Created with zd_subscriber_stats_new() and passed through
+/// zd_subscriber_options_t. Every subscriber counting into it holds a
+/// reference until its drop callback has run, so the caller may free its
+/// own reference as soon as the subscriber is dropped. Fields are updated
+/// atomically from zenoh threads.
+typedef struct {
+  /// Samples dropped by the native filters.
+  uint64_t filtered;
+  /// Samples dropped or replaced by the per-key rate limit.
+  uint64_t rate_limited;
+  /// Samples an aggregating subscriber could not decode as a number.
+  uint64_t undecodable;
+} zd_subscriber_stats_t;
+
+/// Options controlling how a subscriber delivers samples to Dart.
+///
+/// Initialize with zd_subscriber_options_default() before setting fields.
+typedef struct {
+  /// Deliver payload and attachment without copying them.
+  ///
+  /// The bytes are cloned (a reference count bump) and posted as external
+  /// typed data whose finalizer drops the clone, so contiguous payloads
+  /// reach Dart with no memcpy. Fragmented payloads are read once into a
+  /// buffer adopted by Dart.
+  bool zero_copy;
+  /// Post each sample as a single buffer in the flat wire format (see
+  /// zd_sample_wire_header_t) instead of an array of separate objects.
+  /// Takes precedence over `zero_copy`.
+  bool flat;
+  /// Post only a cloned sample handle with its key expression and kind as
+  /// a [sample_ptr(int64), keyexpr(string), kind(int64)] message; the other
+  /// fields are read on demand with the zd_sample_* accessors and the
+  /// handle is released with zd_sample_drop(). Takes precedence over `flat`
+  /// and `zero_copy`, and disables the encoding cache.
+  bool lazy;
+  /// Bit set of ZD_SAMPLE_FIELD_* values to extract and post.
+  ///
+  /// Fields left out are never converted: a missing payload is posted as
+  /// its length (int64) in place of the bytes, and a missing attachment or
+  /// encoding as null. Requested metadata is appended to the sample array
+  /// as a sixth element (Uint8List). Ignored by lazy subscribers.
+  uint32_t fields;
+  /// Intern up to this many distinct key expressions (0 = disabled).
+  ///
+  /// The first sample on a key is preceded by a [0, id(int64),
+  /// keyexpr(string)] definition message; the sample and every later one
+  /// carry the id (int64) in place of the key string. Keys seen after the
+  /// table is full are sent as strings.
+  uint32_t intern_max_keys;
+  /// Cache up to this many distinct encodings (0 = disabled).
+  ///
+  /// Encodings are compared with z_encoding_equals instead of being
+  /// formatted for every sample. A new encoding is announced with a [1,
+  /// id(int64), encoding(string)] definition message and samples carry
+  /// its id (int64) in the encoding slot. Encodings seen after the cache is
+  /// full are sent as strings. Values above ZD_ENCODING_CACHE_MAX are
+  /// clamped.
+  uint32_t encoding_cache_size;
+  /// Maximum samples per batched post (0 or 1 = post each sample).
+  ///
+  /// When greater than 1, samples are buffered natively and posted as one
+  /// `Dart_CObject` array of sample arrays when this count, the byte limit
+  /// or the deadline is reached.
+  uint32_t batch_max_samples;
+  /// Flush once buffered key, payload and attachment bytes reach this
+  /// size (0 = no byte limit).
+  size_t batch_max_bytes;
+  /// Flush a partial batch this many microseconds after its first sample
+  /// was buffered.
+  uint32_t batch_max_delay_us;
+  /// Drop samples whose payload is shorter than this many bytes.
+  size_t filter_min_payload_len;
+  /// Drop samples whose payload is longer than this many bytes
+  /// (SIZE_MAX = no limit).
+  size_t filter_max_payload_len;
+  /// Deliver only samples of this kind (-1 = any, 0 = put, 1 = delete).
+  int8_t filter_kind;
+  /// Deliver only samples whose payload starts with these bytes (NULL =
+  /// no constraint). Copied at declaration.
+  const uint8_t* filter_payload_prefix;
+  size_t filter_payload_prefix_len;
+  /// Deliver only samples with an attachment starting with these bytes
+  /// (NULL = no constraint). Copied at declaration.
+  const uint8_t* filter_attachment_prefix;
+  size_t filter_attachment_prefix_len;
+  /// Drop samples whose key expression intersects any of these key
+  /// expressions. Parsed at declaration; an invalid one fails it.
+  const char* const* filter_exclude_keyexprs;
+  size_t filter_exclude_keyexprs_len;
+  /// Deliver at most one sample per key expression every this many
+  /// microseconds (0 = no rate limit).
+  ///
+  /// Limiter state is kept per distinct key expression seen, so the limit
+  /// applies to each key of a wildcard subscription independently.
+  uint32_t rate_limit_interval_us;
+  /// ZD_RATE_LIMIT_* policy for samples arriving within the interval.
+  uint8_t rate_limit_mode;
+  /// Maximum number of key expressions with limiter state (0 =
+  /// unbounded). A new key beyond it evicts idle state, preferring keys
+  /// whose interval has elapsed; if every key holds a sample, the new key
+  /// is delivered unlimited.
+  uint32_t rate_limit_max_keys;
+  /// Counters from zd_subscriber_stats_new() (NULL = not counted).
+  /// Samples rejected by the filters above are dropped in the zenoh
+  /// callback and counted in `filtered`; samples dropped by the rate limit
+  /// in `rate_limited`.
+  zd_subscriber_stats_t* stats;
+  /// In-flight limit and overflow policy (NULL = unbounded). Every sample
+  /// posted or batched counts as in flight until acknowledged.
+  zd_flow_control_t* flow_control;
+} zd_subscriber_options_t;
+
+/// Initializes subscriber options to their defaults (copying delivery,
+/// all fields, no filters, no rate limit with state for up to 4096 keys,
+/// no batching, 1 ms batch deadline, no encoding cache).
+///
+/// @param options  Pointer to the options struct to initialize.
+FFI_PLUGIN_EXPORT void zd_subscriber_options_default(
+    zd_subscriber_options_t* options);
+
+/// Creates zeroed subscriber counters.
+///
+/// @return The counters, or NULL on allocation failure. Release them with
+///         zd_subscriber_stats_free().
+FFI_PLUGIN_EXPORT zd_subscriber_stats_t* zd_subscriber_stats_new(void);
+
+/// Releases the caller's reference to subscriber counters. Subscribers
+/// still counting into them keep them alive until they are dropped.
+///
+/// @param stats  Counters from zd_subscriber_stats_new().
+FFI_PLUGIN_EXPORT void zd_subscriber_stats_free(zd_subscriber_stats_t* stats);
+
+/// Creates a flow control for a subscriber.
+///
+/// @param max_in_flight  Maximum unacknowledged samples (at least 1).
+/// @param policy         A ZD_OVERFLOW_* policy.
+/// @return The flow control, or NULL on allocation failure. Release it with
+///         zd_flow_control_free().
+FFI_PLUGIN_EXPORT zd_flow_control_t* zd_flow_control_new(
+    uint32_t max_in_flight, uint8_t policy);
+
+/// Acknowledges samples Dart has consumed, posting queued samples and
+/// waking blocked callbacks as room becomes available.
+///
+/// @param flow   The flow control passed to the subscriber.
+/// @param count  Number of samples consumed since the last acknowledgement.
+FFI_PLUGIN_EXPORT void zd_flow_control_ack(zd_flow_control_t* flow,
+                                           uint32_t count);
+
+/// Returns the number of samples dropped by the overflow policy.
+///
+/// @param flow  The flow control passed to the subscriber.
+/// @return The dropped sample count.
+FFI_PLUGIN_EXPORT uint64_t zd_flow_control_dropped(zd_flow_control_t* flow);
+
+/// Stops delivery: releases queued samples, wakes blocked callbacks and
+/// drops every later sample. Call before dropping the subscriber so a
+/// blocked callback cannot stall the undeclaration.
+///
+/// @param flow  The flow control passed to the subscriber.
+FFI_PLUGIN_EXPORT void zd_flow_control_close(zd_flow_control_t* flow);
+
+/// Closes a flow control and releases the caller's reference. A subscriber
+/// still using it keeps it alive until the subscriber is dropped.
+///
+/// @param flow  The flow control to release.
+FFI_PLUGIN_EXPORT void zd_flow_control_free(zd_flow_control_t* flow);
+
 /// Declares a subscriber on the given key expression.
 ///
 /// Samples are posted to the Dart isolate via `Dart_PostCObject_DL` on
 /// the given native port. Each sample is sent as a `Dart_CObject` array
-/// of 4 elements: [keyexpr(string), payload(Uint8List), kind(int64),
-/// attachment(null or Uint8List)].
+/// of 5 elements: [keyexpr(string), payload(Uint8List), kind(int64),
+/// attachment(null or Uint8List), encoding(string)], or as one flat
+/// Uint8List when `options->flat` is set. Batching subscribers post an
+/// array of such messages instead. Once the subscriber is dropped and its
+/// last callback has returned, a null sentinel is posted as the final
+/// message.
 ///
 /// @param session     Const pointer to a loaned session.
 /// @param subscriber  Pointer to an uninitialized z_owned_subscriber_t.
 /// @param keyexpr     Const pointer to a loaned key expression.
 /// @param dart_port   The Dart native port to post samples to.
+/// @param options     Delivery options (NULL = defaults).
 /// @return 0 on success, negative on failure.
 FFI_PLUGIN_EXPORT int zd_declare_subscriber(
     const z_loaned_session_t* session,
     z_owned_subscriber_t* subscriber,
     const z_loaned_keyexpr_t* keyexpr,
-    int64_t dart_port);
+    int64_t dart_port,
+    const zd_subscriber_options_t* options);
 
 /// Drops (undeclares and frees) a subscriber.
 ///
@@ -383,11 +772,107 @@ FFI_PLUGIN_EXPORT void zd_subscriber_drop(z_owned_subscriber_t* subscriber);
 /// @param session   Const pointer to a loaned session.
 /// @param key_expr  The key expression string.
 /// @param dart_port The Dart native port to post samples to.
+/// @param options   Delivery options (NULL = defaults).
 /// @return 0 on success, negative on failure.
 FFI_PLUGIN_EXPORT int8_t zd_declare_background_subscriber(
     const z_loaned_session_t* session,
     const char* key_expr,
-    int64_t dart_port);
+    int64_t dart_port,
+    const zd_subscriber_options_t* options);
+
+/// Shard selection modes for zd_declare_sharded_subscriber().
+///
+/// BY_KEY routes every sample on a key expression to the same port, which
+/// keeps per-key ordering. ROUND_ROBIN spreads samples evenly but gives no
+/// ordering across ports.
+#define ZD_SHARD_BY_KEY 0
+#define ZD_SHARD_ROUND_ROBIN 1
+
+/// Declares a subscriber that spreads samples across several Dart ports,
+/// typically one per worker isolate.
+///
+/// Each port gets its own delivery state built from `options` (interned
+/// keys, encoding cache, batching, rate limits), so every port receives
+/// messages exactly as from zd_declare_subscriber(), including the
+/// definitions for the ids it sees. When the subscriber is dropped a null
+/// sentinel is posted to every port.
+///
+/// @param session      Const pointer to a loaned session.
+/// @param subscriber   Pointer to an uninitialized z_owned_subscriber_t.
+/// @param keyexpr      Const pointer to a loaned key expression.
+/// @param dart_ports   Array of `shard_count` Dart native ports.
+/// @param shard_count  Number of ports (at least 1).
+/// @param mode         A ZD_SHARD_* mode.
+/// @param options      Delivery options for every shard (NULL = defaults).
+///                     `flow_control` must be NULL; `stats` is shared.
+///                     A rate limit requires ZD_SHARD_BY_KEY.
+/// @return 0 on success, negative on failure.
+FFI_PLUGIN_EXPORT int zd_declare_sharded_subscriber(
+    const z_loaned_session_t* session,
+    z_owned_subscriber_t* subscriber,
+    const z_loaned_keyexpr_t* keyexpr,
+    const int64_t* dart_ports,
+    size_t shard_count,
+    uint8_t mode,
+    const zd_subscriber_options_t* options);
+
+// ---------------------------------------------------------------------------
+// Lazy sample accessors
+// ---------------------------------------------------------------------------
+
+/// Copies the payload of a lazily delivered sample into a caller buffer.
+///
+/// Pass a NULL `payload_out` to query the length only.
+///
+/// @param sample       Pointer to a heap-allocated z_owned_sample_t posted
+///                     by a lazy subscriber (as uint8_t*).
+/// @param payload_out  Buffer to receive the payload, or NULL.
+/// @param max_len      Maximum number of bytes to copy.
+/// @return The full payload length in bytes.
+FFI_PLUGIN_EXPORT int64_t zd_sample_payload(const uint8_t* sample,
+                                            uint8_t* payload_out,
+                                            size_t max_len);
+
+/// Copies the attachment of a lazily delivered sample into a caller buffer.
+///
+/// Pass a NULL `attachment_out` to query the length only.
+///
+/// @param sample          Pointer to a lazily delivered sample (as uint8_t*).
+/// @param attachment_out  Buffer to receive the attachment, or NULL.
+/// @param max_len         Maximum number of bytes to copy.
+/// @return The full attachment length in bytes, or -1 if there is none.
+FFI_PLUGIN_EXPORT int64_t zd_sample_attachment(const uint8_t* sample,
+                                               uint8_t* attachment_out,
+                                               size_t max_len);
+
+/// Returns the encoding of a lazily delivered sample as a string.
+///
+/// @param sample  Pointer to a lazily delivered sample (as uint8_t*).
+/// @return Malloc'd null-terminated string the caller must free, or NULL
+///         on allocation failure.
+FFI_PLUGIN_EXPORT char* zd_sample_encoding(const uint8_t* sample);
+
+/// Reads the timestamp of a lazily delivered sample.
+///
+/// @param sample     Pointer to a lazily delivered sample (as uint8_t*).
+/// @param ntp64_out  Receives the NTP64 time when the sample has one.
+/// @return true if the sample carries a timestamp.
+FFI_PLUGIN_EXPORT bool zd_sample_timestamp(const uint8_t* sample,
+                                           uint64_t* ntp64_out);
+
+/// Reads the timestamp, source and QoS of a lazily delivered sample.
+///
+/// @param sample        Pointer to a lazily delivered sample (as uint8_t*).
+/// @param metadata_out  Receives the metadata.
+FFI_PLUGIN_EXPORT void zd_sample_metadata(const uint8_t* sample,
+                                          zd_sample_metadata_t* metadata_out);
+
+/// Drops a lazily delivered sample and frees its heap allocation.
+///
+/// Matches the NativeFinalizer signature so Dart can attach it directly.
+///
+/// @param sample  Pointer to a lazily delivered sample (as uint8_t*).
+FFI_PLUGIN_EXPORT void zd_sample_drop(uint8_t* sample);
 
 // ---------------------------------------------------------------------------
 // Publisher
@@ -427,14 +912,70 @@ FFI_PLUGIN_EXPORT void zd_publisher_drop(z_owned_publisher_t* publisher);
 /// @param publisher   Const pointer to a loaned publisher.
 /// @param payload     Pointer to owned bytes (consumed via z_bytes_move).
 /// @param encoding    MIME type string for per-put encoding override (NULL = publisher default).
+/// @param compiled_encoding  Parsed encoding override, cloned (NULL = use `encoding`).
 /// @param attachment  Pointer to owned bytes for attachment (consumed if non-NULL, NULL = no attachment).
 /// @return 0 on success, negative on failure.
 FFI_PLUGIN_EXPORT int zd_publisher_put(
     const z_loaned_publisher_t* publisher,
     z_owned_bytes_t* payload,
     const char* encoding,
+    const z_owned_encoding_t* compiled_encoding,
     z_owned_bytes_t* attachment);
 
+/// Publishes `count` payloads through the publisher in one call.
+///
+/// Each payload (and attachment, if any) is copied into fresh zenoh bytes
+/// and published in order with z_publisher_put. The encoding override is
+/// parsed once for the whole batch. Publishing stops at the first failure.
+///
+/// @param publisher        Const pointer to a loaned publisher.
+/// @param payloads         Array of `count` payload pointers.
+/// @param payload_lens     Array of `count` payload lengths.
+/// @param attachments      Array of `count` attachment pointers, NULL
+///                         entries for no attachment (NULL = none at all).
+/// @param attachment_lens  Array of `count` attachment lengths (ignored when
+///                         `attachments` is NULL).
+/// @param count            Number of messages.
+/// @param encoding         MIME type string for a per-batch encoding override (NULL = publisher default).
+/// @param compiled_encoding  Parsed encoding override (NULL = use `encoding`).
+/// @param published_out    Out: number of messages published.
+/// @return 0 on success, negative on failure (of message `*published_out`).
+FFI_PLUGIN_EXPORT int zd_publisher_put_batch(
+    const z_loaned_publisher_t* publisher,
+    const uint8_t* const* payloads,
+    const size_t* payload_lens,
+    const uint8_t* const* attachments,
+    const size_t* attachment_lens,
+    int32_t count,
+    const char* encoding,
+    const z_owned_encoding_t* compiled_encoding,
+    int32_t* published_out);
+
+/// Runs a publish loop on a native thread to measure throughput without
+/// Dart or FFI overhead.
+///
+/// A payload of `payload_size` bytes is built once; each iteration
+/// publishes a shallow clone of it with z_publisher_put, as z_pub_thr
+/// does. The loop stops after `count` messages or `duration_us`
+/// microseconds, whichever comes first, or at the first failed put. It
+/// then posts [messages, bytes, elapsed_ns, rc] (all Int64) to `dart_port`.
+///
+/// The publisher must stay declared until the result is posted.
+///
+/// @param publisher     Const pointer to a loaned publisher.
+/// @param payload_size  Size of each payload in bytes.
+/// @param count         Number of messages to publish (0 = no limit).
+/// @param duration_us   Time limit in microseconds (0 = no limit).
+/// @param dart_port     The Dart native port to post the result to.
+/// @return 0 if the loop was started, negative on invalid arguments
+///         (no limit at all) or if the thread could not be created.
+FFI_PLUGIN_EXPORT int zd_publisher_benchmark(
+    const z_loaned_publisher_t* publisher,
+    size_t payload_size,
+    uint64_t count,
+    uint64_t duration_us,
+    int64_t dart_port);
+
 /// Sends a DELETE through the publisher.
 FFI_PLUGIN_EXPORT int zd_publisher_delete(
     const z_loaned_publisher_t* publisher);
@@ -598,12 +1139,15 @@ FFI_PLUGIN_EXPORT int8_t zd_get(
 /// @param key_expr     Null-terminated key expression string.
 /// @param payload      Pointer to z_owned_bytes_t (consumed via z_bytes_move).
 /// @param encoding     MIME type string (NULL = default).
+/// @param compiled_encoding  Parsed z_owned_encoding_t, cloned (as uint8_t*;
+///                     NULL = use `encoding`).
 /// @return 0 on success, negative on failure.
 FFI_PLUGIN_EXPORT int8_t zd_query_reply(
     const uint8_t* query,
     const char* key_expr,
     uint8_t* payload,
-    const char* encoding);
+    const char* encoding,
+    const uint8_t* compiled_encoding);
 
 /// Drops (frees) an owned query.
 ///
@@ -718,50 +1262,394 @@ FFI_PLUGIN_EXPORT int8_t zd_bytes_is_shm(const uint8_t* bytes);
 #endif // Z_FEATURE_SHARED_MEMORY && Z_FEATURE_UNSTABLE_API
 
 // ---------------------------------------------------------------------------
-// Pull Subscriber (ring channel)
+// Pull Subscriber (ring or FIFO channel)
 // ---------------------------------------------------------------------------
 
+/// Pull subscriber channel: a ring drops the oldest sample when full.
+#define ZD_PULL_CHANNEL_RING 0
+/// Pull subscriber channel: a FIFO blocks the zenoh callback when full
+/// until a sample is received, applying backpressure instead of dropping.
+#define ZD_PULL_CHANNEL_FIFO 1
+
 /// Returns the size of z_owned_ring_handler_sample_t in bytes.
 FFI_PLUGIN_EXPORT int32_t zd_ring_handler_sample_sizeof(void);
 
-/// Declares a pull subscriber using a ring channel buffer.
+/// Returns the size of z_owned_fifo_handler_sample_t in bytes.
+FFI_PLUGIN_EXPORT int32_t zd_fifo_handler_sample_sizeof(void);
+
+/// Tracks sample arrivals into a pull subscriber's channel so that receivers
+/// can block or be woken instead of polling.
+///
+/// Created by zd_declare_pull_subscriber() and released with
+/// zd_pull_waiter_free(); it stays valid after the subscriber is dropped.
+typedef struct zd_pull_waiter_t zd_pull_waiter_t;
+
+/// Declares a pull subscriber using a ring or FIFO channel buffer.
 ///
 /// @param subscriber_out  Pointer to an uninitialized z_owned_subscriber_t (as uint8_t*).
-/// @param handler_out     Pointer to an uninitialized z_owned_ring_handler_sample_t (as uint8_t*).
+/// @param handler_out     Pointer to an uninitialized z_owned_ring_handler_sample_t
+///                        or z_owned_fifo_handler_sample_t, per `channel` (as uint8_t*).
 /// @param session         Const pointer to a loaned session (as uint8_t*).
 /// @param key_expr        Null-terminated key expression string.
-/// @param capacity        Ring buffer capacity.
+/// @param capacity        Channel buffer capacity.
+/// @param channel         A ZD_PULL_CHANNEL_* kind.
+/// @param waiter_out      Out: arrival waiter for the channel, set on success.
 /// @return 0 on success, negative on failure.
 FFI_PLUGIN_EXPORT int8_t zd_declare_pull_subscriber(
     uint8_t* subscriber_out, uint8_t* handler_out,
     const uint8_t* session, const char* key_expr,
-    int32_t capacity);
+    int32_t capacity, int8_t channel, zd_pull_waiter_t** waiter_out);
+
+/// Returns the number of samples pushed into the channel so far.
+///
+/// Read it before trying to receive, then pass it as `seen` to
+/// zd_pull_waiter_wait() or zd_pull_waiter_arm() so that an arrival in
+/// between is never missed.
+///
+/// @param waiter  The pull subscriber's waiter.
+/// @return The arrival count.
+FFI_PLUGIN_EXPORT uint64_t zd_pull_waiter_arrivals(zd_pull_waiter_t* waiter);
+
+/// Blocks until a sample arrives after `seen`, the subscriber is dropped
+/// or the timeout expires.
+///
+/// @param waiter      The pull subscriber's waiter.
+/// @param seen        Arrival count read before the last receive attempt.
+/// @param timeout_us  Timeout in microseconds, or negative to wait forever.
+/// @return 0 if a sample arrived, 1 on timeout, -1 if the subscriber was
+///         dropped (buffered samples can still be received).
+FFI_PLUGIN_EXPORT int8_t zd_pull_waiter_wait(zd_pull_waiter_t* waiter,
+                                             uint64_t seen,
+                                             int64_t timeout_us);
+
+/// Arms a one-shot doorbell: a null message is posted to `dart_port` when
+/// the next sample arrives or the subscriber is dropped.
+///
+/// @param waiter     The pull subscriber's waiter.
+/// @param dart_port  Native port to post the doorbell to.
+/// @param seen       Arrival count read before the last receive attempt.
+/// @return 0 if armed, 1 if a sample already arrived after `seen` (not
+///         armed), -1 if the subscriber was dropped (not armed).
+FFI_PLUGIN_EXPORT int8_t zd_pull_waiter_arm(zd_pull_waiter_t* waiter,
+                                            int64_t dart_port,
+                                            uint64_t seen);
 
-/// Tries to receive a sample from the ring handler.
+/// Releases the caller's reference to a pull waiter.
+///
+/// @param waiter  The pull subscriber's waiter.
+FFI_PLUGIN_EXPORT void zd_pull_waiter_free(zd_pull_waiter_t* waiter);
+
+/// Tries to receive a sample from the channel handler.
 ///
 /// Return codes: 0=sample available, 1=channel disconnected, 2=buffer empty.
 /// When 0, all out_ parameters are populated (malloc'd; caller must free).
+/// The payload and attachment are read directly into buffers sized by
+/// z_bytes_len(), so each is copied exactly once; the caller may adopt
+/// them instead of copying again.
 ///
-/// @param handler           Const pointer to an owned ring handler (as uint8_t*).
+/// @param handler           Const pointer to an owned ring or FIFO handler (as uint8_t*).
+/// @param channel           The ZD_PULL_CHANNEL_* kind of `handler`.
 /// @param out_keyexpr       Out: malloc'd null-terminated key expression string.
-/// @param out_payload       Out: malloc'd payload bytes.
+/// @param out_payload       Out: malloc'd payload bytes (or NULL if empty).
 /// @param out_payload_len   Out: payload length.
 /// @param out_kind          Out: sample kind (0=put, 1=delete).
 /// @param out_encoding      Out: malloc'd null-terminated encoding string (or NULL).
-/// @param out_attachment     Out: malloc'd attachment bytes (or NULL).
+/// @param out_attachment     Out: malloc'd attachment bytes (or NULL if absent or empty).
 /// @param out_attachment_len Out: attachment length.
 /// @return 0=sample, 1=disconnected, 2=empty.
 FFI_PLUGIN_EXPORT int8_t zd_pull_subscriber_try_recv(
-    const uint8_t* handler,
+    const uint8_t* handler, int8_t channel,
     char** out_keyexpr, uint8_t** out_payload, int32_t* out_payload_len,
     int8_t* out_kind, char** out_encoding,
     uint8_t** out_attachment, int32_t* out_attachment_len);
 
+/// Size of the inline payload area of a zd_pull_recv_t.
+#define ZD_PULL_RECV_INLINE_SIZE 256
+
+/// A reusable receive descriptor filled in place by
+/// zd_pull_subscriber_try_recv_into().
+///
+/// Allocate it zeroed and keep it across calls: the key expression,
+/// encoding and attachment are written to scratch buffers owned by the
+/// descriptor, which only grow when a sample needs more room, and a payload
+/// of up to ZD_PULL_RECV_INLINE_SIZE bytes is written to `inline_payload`.
+/// Steady-state polling of small samples therefore does no heap
+/// allocation. Release the scratch buffers with zd_pull_recv_release().
+typedef struct {
+  /// Key expression of the last sample (UTF-8, not null-terminated).
+  char* keyexpr;
+  size_t keyexpr_len;
+  size_t keyexpr_cap;
+  /// Encoding of the last sample (UTF-8, not null-terminated).
+  char* encoding;
+  size_t encoding_len;
+  size_t encoding_cap;
+  /// Attachment of the last sample, valid when `has_attachment` is set.
+  uint8_t* attachment;
+  size_t attachment_len;
+  size_t attachment_cap;
+  /// Payload of the last sample: `inline_payload`, or a malloc'd buffer
+  /// the caller takes ownership of when `payload_owned` is set.
+  uint8_t* payload;
+  size_t payload_len;
+  /// Private: the last encoding, compared to skip reformatting it.
+  void* last_encoding;
+  /// Set when the key expression differs from the previous sample's.
+  bool keyexpr_changed;
+  /// Set when the encoding differs from the previous sample's.
+  bool encoding_changed;
+  bool has_attachment;
+  bool payload_owned;
+  /// Sample kind (0 = put, 1 = delete).
+  int8_t kind;
+  uint8_t inline_payload[ZD_PULL_RECV_INLINE_SIZE];
+} zd_pull_recv_t;
+
+/// Tries to receive a sample from the channel handler into a reusable
+/// descriptor.
+///
+/// Unlike zd_pull_subscriber_try_recv(), the fields are written in place
+/// into `recv` rather than into fresh malloc'd buffers, and an unchanged
+/// key expression or encoding is not copied again.
+///
+/// @param handler  Const pointer to an owned ring or FIFO handler (as uint8_t*).
+/// @param channel  The ZD_PULL_CHANNEL_* kind of `handler`.
+/// @param recv     Descriptor to fill; see zd_pull_recv_t.
+/// @return 0=sample, 1=disconnected, 2=empty, -1 if a scratch buffer could
+///         not be grown (the sample is lost).
+FFI_PLUGIN_EXPORT int8_t zd_pull_subscriber_try_recv_into(
+    const uint8_t* handler, int8_t channel, zd_pull_recv_t* recv);
+
+/// Frees the scratch buffers of a receive descriptor and zeroes it.
+///
+/// A payload whose ownership passed to the caller is not freed.
+///
+/// @param recv  The descriptor.
+FFI_PLUGIN_EXPORT void zd_pull_recv_release(zd_pull_recv_t* recv);
+
+/// Drains up to `max_samples` samples from the channel handler into `arena`
+/// in one call.
+///
+/// Samples are written back to back as frames: an 8-byte prefix whose
+/// first uint32 is the frame length, followed by the sample in the flat
+/// wire format (see zd_sample_wire_header_t) padded to 8 bytes. Draining
+/// stops at the first sample that does not fit in the rest of the arena;
+/// that sample is framed into a malloc'd buffer returned through
+/// `overflow_out` instead of being lost.
+///
+/// @param handler         Const pointer to an owned ring or FIFO handler (as uint8_t*).
+/// @param channel         The ZD_PULL_CHANNEL_* kind of `handler`.
+/// @param arena           Buffer receiving the frames.
+/// @param arena_len       Size of `arena` in bytes.
+/// @param max_samples     Maximum number of samples to drain into `arena`.
+/// @param arena_used_out  Out: number of bytes written to `arena`.
+/// @param overflow_out    Out: malloc'd frame of a sample that did not fit
+///                        (caller must free), or NULL.
+/// @return The number of frames written to `arena`, -1 if the channel is
+///         disconnected and empty, or -2 if the frame of a sample that did
+///         not fit could not be allocated. That sample is lost;
+///         `arena_used_out` still covers the frames written before it.
+FFI_PLUGIN_EXPORT int32_t zd_pull_subscriber_try_recv_batch(
+    const uint8_t* handler, int8_t channel, uint8_t* arena, size_t arena_len,
+    int32_t max_samples, size_t* arena_used_out, uint8_t** overflow_out);
+
 /// Drops (frees) the ring handler.
 ///
 /// @param handler  Pointer to a z_owned_ring_handler_sample_t (as uint8_t*).
 FFI_PLUGIN_EXPORT void zd_ring_handler_sample_drop(uint8_t* handler);
 
+/// Drops (frees) the FIFO handler.
+///
+/// @param handler  Pointer to a z_owned_fifo_handler_sample_t (as uint8_t*).
+FFI_PLUGIN_EXPORT void zd_fifo_handler_sample_drop(uint8_t* handler);
+
+// ---------------------------------------------------------------------------
+// Ring Subscriber (shared sample ring)
+// ---------------------------------------------------------------------------
+
+/// Single-producer/single-consumer sample ring shared between a ring
+/// subscriber's zenoh callback and a Dart isolate.
+///
+/// The ring data is a sequence of frames, each an 8-byte prefix whose
+/// first uint32 is the frame length, followed by one sample in the flat
+/// wire format (see zd_sample_wire_header_t) padded to 8 bytes. A zero
+/// length marks the unused end of the buffer; reading resumes at offset 0.
+typedef struct zd_sample_ring_t zd_sample_ring_t;
+
+/// Declares a subscriber that writes samples into a shared ring.
+///
+/// Dart reads frames between its tail and zd_sample_ring_acquire()
+/// directly from zd_sample_ring_data(), then returns the space with
+/// zd_sample_ring_release(). A doorbell (an int64) is posted to
+/// `dart_port` only when a sample arrives after Dart armed it by
+/// releasing an empty ring. Samples that do not fit are dropped and
+/// counted, never blocking the zenoh callback.
+///
+/// The ring is freed when the subscriber is dropped.
+///
+/// @param session     Const pointer to a loaned session.
+/// @param subscriber  Pointer to an uninitialized z_owned_subscriber_t.
+/// @param keyexpr     Const pointer to a loaned key expression.
+/// @param dart_port   The Dart native port to post doorbells to.
+/// @param capacity    Ring size in bytes, rounded up to a power of two.
+/// @param ring_out    Receives the ring on success.
+/// @return 0 on success, negative on failure.
+FFI_PLUGIN_EXPORT int zd_declare_ring_subscriber(
+    const z_loaned_session_t* session,
+    z_owned_subscriber_t* subscriber,
+    const z_loaned_keyexpr_t* keyexpr,
+    int64_t dart_port,
+    size_t capacity,
+    zd_sample_ring_t** ring_out);
+
+/// Returns the ring's data buffer of zd_sample_ring_capacity() bytes.
+///
+/// @param ring  The ring returned by zd_declare_ring_subscriber().
+/// @return Pointer to the frame data.
+FFI_PLUGIN_EXPORT uint8_t* zd_sample_ring_data(const zd_sample_ring_t* ring);
+
+/// Returns the ring's capacity in bytes (a power of two).
+///
+/// @param ring  The ring returned by zd_declare_ring_subscriber().
+/// @return The capacity in bytes.
+FFI_PLUGIN_EXPORT size_t zd_sample_ring_capacity(
+    const zd_sample_ring_t* ring);
+
+/// Returns the producer position; frames before it are ready to read.
+///
+/// @param ring  The ring returned by zd_declare_ring_subscriber().
+/// @return The head position (monotonic, mask with capacity - 1).
+FFI_PLUGIN_EXPORT uint64_t zd_sample_ring_acquire(zd_sample_ring_t* ring);
+
+/// Returns consumed space to the producer and arms the doorbell.
+///
+/// @param ring  The ring returned by zd_declare_ring_subscriber().
+/// @param tail  Position just past the last frame read.
+/// @return true if more frames arrived and the caller should keep
+///         reading; false if the ring is empty or a doorbell is pending.
+FFI_PLUGIN_EXPORT bool zd_sample_ring_release(zd_sample_ring_t* ring,
+                                              uint64_t tail);
+
+/// Returns the number of samples dropped because the ring was full.
+///
+/// @param ring  The ring returned by zd_declare_ring_subscriber().
+/// @return The dropped sample count.
+FFI_PLUGIN_EXPORT uint64_t zd_sample_ring_dropped(zd_sample_ring_t* ring);
+
+// ---------------------------------------------------------------------------
+// Conflating Subscriber (latest value per key)
+// ---------------------------------------------------------------------------
+
+/// Latest-sample-per-key map shared between a conflating subscriber's
+/// zenoh callback and a Dart isolate.
+typedef struct zd_conflation_t zd_conflation_t;
+
+/// Declares a subscriber that keeps only the newest sample per key.
+///
+/// Each sample replaces the one held for its key expression. A doorbell
+/// (an int64) is posted to `dart_port` when a key is updated while no
+/// doorbell is outstanding; Dart then collects every updated key with
+/// zd_conflation_take(), which re-arms the doorbell. Memory and Dart work
+/// are bounded by the number of distinct keys, not the sample rate.
+///
+/// The map is freed when the subscriber is dropped.
+///
+/// @param session         Const pointer to a loaned session.
+/// @param subscriber      Pointer to an uninitialized z_owned_subscriber_t.
+/// @param keyexpr         Const pointer to a loaned key expression.
+/// @param dart_port       The Dart native port to post doorbells to.
+/// @param conflation_out  Receives the map on success.
+/// @return 0 on success, negative on failure.
+FFI_PLUGIN_EXPORT int zd_declare_conflating_subscriber(
+    const z_loaned_session_t* session,
+    z_owned_subscriber_t* subscriber,
+    const z_loaned_keyexpr_t* keyexpr,
+    int64_t dart_port,
+    zd_conflation_t** conflation_out);
+
+/// Removes the newest sample of every key updated since the last call and
+/// re-arms the doorbell.
+///
+/// The samples are returned as frames laid out like zd_sample_ring_t
+/// frames: an 8-byte prefix whose first uint32 is the frame length, then
+/// the sample in the flat wire format, padded to 8 bytes. Keys appear in
+/// the order they were first updated.
+///
+/// @param conflation  The map returned by zd_declare_conflating_subscriber().
+/// @param len_out     Receives the total length of the frames in bytes.
+/// @return Malloc'd frames the caller must free, or NULL if no key was
+///         updated or on allocation failure.
+FFI_PLUGIN_EXPORT uint8_t* zd_conflation_take(zd_conflation_t* conflation,
+                                              size_t* len_out);
+
+/// Returns the number of samples replaced by a newer one before Dart
+/// took them.
+///
+/// @param conflation  The map returned by zd_declare_conflating_subscriber().
+/// @return The conflated sample count.
+FFI_PLUGIN_EXPORT uint64_t zd_conflation_conflated(
+    zd_conflation_t* conflation);
+
+// ---------------------------------------------------------------------------
+// Aggregating Subscriber (windowed numeric aggregates)
+// ---------------------------------------------------------------------------
+
+/// Payload value types for zd_aggregator_options_t.value_type.
+#define ZD_AGGREGATE_FLOAT64 0
+#define ZD_AGGREGATE_INT64 1
+
+/// Options for an aggregating subscriber.
+///
+/// Initialize with zd_aggregator_options_default() before setting fields.
+typedef struct {
+  /// ZD_AGGREGATE_* type of every payload.
+  uint8_t value_type;
+  /// Decode payloads with ze_deserializer instead of as 8 raw
+  /// little-endian bytes.
+  bool serialized;
+  /// Window length in microseconds.
+  uint64_t window_us;
+  /// Interval between window closes in microseconds; equal to
+  /// `window_us` for tumbling windows, smaller for sliding ones. Must
+  /// divide `window_us`.
+  uint64_t step_us;
+  /// Counters from zd_subscriber_stats_new() (NULL = not counted).
+  /// Payloads that fail to decode are counted in `undecodable`.
+  zd_subscriber_stats_t* stats;
+} zd_aggregator_options_t;
+
+/// Initializes aggregator options to their defaults (raw float64
+/// payloads, 1 s tumbling windows).
+///
+/// @param options  Pointer to the options struct to initialize.
+FFI_PLUGIN_EXPORT void zd_aggregator_options_default(
+    zd_aggregator_options_t* options);
+
+/// Declares a subscriber that aggregates numeric payloads per key.
+///
+/// Payloads are decoded in the zenoh callback and folded into per-key
+/// count, min, max and sum accumulators; nothing is posted per sample.
+/// Every `step_us` a native timer closes the window ending at that
+/// moment and posts one message for all keys that received samples in
+/// it: [window_end_us(int64), records(array)], where each record is
+/// [keyexpr(string), count(int64), min, max, mean(double)] and min and
+/// max are doubles or int64s according to `value_type`. Windows are
+/// measured on arrival time; window_end_us is the wall-clock time of
+/// the close in microseconds since the epoch.
+///
+/// @param session     Const pointer to a loaned session.
+/// @param subscriber  Pointer to an uninitialized z_owned_subscriber_t.
+/// @param keyexpr     Const pointer to a loaned key expression.
+/// @param dart_port   The Dart native port to post aggregates to.
+/// @param options     Aggregation options (NULL = defaults).
+/// @return 0 on success, negative on failure.
+FFI_PLUGIN_EXPORT int zd_declare_aggregating_subscriber(
+    const z_loaned_session_t* session,
+    z_owned_subscriber_t* subscriber,
+    const z_loaned_keyexpr_t* keyexpr,
+    int64_t dart_port,
+    const zd_aggregator_options_t* options);
+
 // ---------------------------------------------------------------------------
 // Querier
 // ---------------------------------------------------------------------------